@@ -85,6 +85,39 @@ namespace imp
         return provider.get();
     }
 
+    colliding_keys_provider::colliding_keys_provider(uint32_t head_len, uint32_t key_len_, uint32_t extra_len_) :
+            head{get_rand_str(head_len)}, key_len{key_len_}, extra_len{extra_len_}
+    {
+    }
+
+    const vector<string>& colliding_keys_provider::get_keys(uint32_t keys_num, keys_use use)
+    {
+        uint64_t cache_key = ((uint64_t) keys_num << 32) | get_key_len();
+        auto& cached = use == keys_use::BUILD_CONTAINER ? build_cache[cache_key] : ops_cache[cache_key];
+        if (cached.size() != keys_num)
+        {
+            cached.resize(keys_num);
+            size_t seq = 0;
+            generate(cached.begin(), cached.end(), [this, &seq] {
+                return head + get_seq_str(key_len, extra_len, seq++);
+            });
+            shuffle(cached.begin(), cached.end(), mt19937{random_device{}()});
+        }
+        assert(cached.size() == keys_num);
+        return cached;
+    }
+
+    colliding_keys_provider* get_colliding_keys_provider(uint32_t head_len, uint32_t key_len, uint32_t extra_len)
+    {
+        // providers are kept per configuration, so all inputs of the same head length share the head
+        static unordered_map<uint64_t, unique_ptr<colliding_keys_provider>> providers;
+        const uint64_t config = ((uint64_t)head_len << 40) | ((uint64_t)key_len << 20) | extra_len;
+        unique_ptr<colliding_keys_provider>& provider = providers[config];
+        if (!provider)
+            provider = make_unique<colliding_keys_provider>(head_len, key_len, extra_len);
+        return provider.get();
+    }
+
     vector<string> dataset_keys_provider::read_dataset(const string& file)
     {
         ifstream fin{file};
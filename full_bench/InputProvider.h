@@ -46,6 +46,25 @@ namespace imp
 
     rand_keys_provider* get_rand_keys_provider(uint32_t key_len, uint32_t extra_len);
 
+    // keys sharing a long random head, e.g., log paths or URLs: their prefixes always collide, and comparisons are
+    // decided by the characters following the head
+    class colliding_keys_provider : public keys_provider
+    {
+        std::unordered_map<uint64_t, std::vector<std::string>> build_cache;
+        std::unordered_map<uint64_t, std::vector<std::string>> ops_cache;
+        std::string head;
+        uint32_t key_len;
+        uint32_t extra_len;
+
+    public:
+        colliding_keys_provider(uint32_t head_len, uint32_t key_len_, uint32_t extra_len_);
+        const std::vector<std::string>& get_keys(uint32_t keys_num, keys_use use) override;
+        virtual uint32_t get_key_len() const override { return (uint32_t)head.size() + key_len + extra_len; }
+
+    };
+
+    colliding_keys_provider* get_colliding_keys_provider(uint32_t head_len, uint32_t key_len, uint32_t extra_len);
+
     class dataset_keys_provider : public keys_provider
     {
         std::unordered_map<uint64_t, std::vector<std::string>> build_cache;
@@ -77,6 +96,15 @@ std::unique_ptr<input_provider<StrT>> get_rand_input(uint32_t key_len, uint32_t
     };
 }
 
+template<class StrT>
+std::unique_ptr<input_provider<StrT>> get_colliding_input(uint32_t head_len, uint32_t key_len, uint32_t extra_len)
+{
+    static std::unordered_map<uint64_t, std::set<StrT, std::less<>>> containers_cache;
+    return std::unique_ptr<input_provider<StrT>>{
+            new input_provider<StrT>{imp::get_colliding_keys_provider(head_len, key_len, extra_len), &containers_cache}
+    };
+}
+
 template<class StrT>
 std::unique_ptr<input_provider<StrT>> get_dataset_input(std::string file_name)
 {
@@ -103,6 +131,8 @@ class input_provider
         return std::make_unique<input_provider<StrT>>(provider, cache);
     }
     friend std::unique_ptr<input_provider<StrT>> get_rand_input<StrT>(uint32_t key_len, uint32_t extra_len);
+    friend std::unique_ptr<input_provider<StrT>> get_colliding_input<StrT>(uint32_t head_len, uint32_t key_len,
+                                                                           uint32_t extra_len);
     friend std::unique_ptr<input_provider<StrT>> get_dataset_input<StrT>(std::string);
 
 public:
@@ -5,9 +5,11 @@
 
 #include <random>
 #include <unordered_map>
+#include <unordered_set>
 #include <cstdint>
 #include <sstream>
 #include <atomic>
+#include <array>
 #if (__cplusplus < 201703L) && !(defined(__clang__) && __clang_major__ > 7)
     #include <experimental/string_view>
     using std::experimental::string_view;
@@ -16,6 +18,14 @@
 #endif
 
 #include "Keydomet.h"
+#include "Kstring.h"
+#include "TrainedEncoding.h"
+#include "StringHeap.h"
+#include "BTree.h"
+#include "FlatSet.h"
+#include "EytzingerIndex.h"
+#include "LearnedIndex.h"
+#include "RadixTree.h"
 #include "InputProvider.h"
 
 #include "benchmark/benchmark.h"
@@ -31,28 +41,105 @@ bool lookup(Container<StrType, Args...>& s, const string& key)
 }
 
 // specialized for keydomet-ed containers, which take a keydomet for lookups
-template<template<class, class... KdmtArgs> class Container, class KdmtStrT, prefix_size KdmtSize, class... Args>
-bool lookup(Container<keydomet<KdmtStrT, KdmtSize>, Args...>& s, const string& key)
+template<template<class, class... KdmtArgs> class Container, class KdmtStrT, prefix_size KdmtSize, class KdmtStats,
+        class KdmtEncoding, class... Args>
+bool lookup(Container<keydomet<KdmtStrT, KdmtSize, KdmtStats, KdmtEncoding>, Args...>& s, const string& key)
 {
     auto hkey = make_find_key(s, key);
     auto iter = s.find(hkey);
     return iter != s.end();
 }
 
-enum ops { Lookups, Mix };
+// keydomet usage stats are collected per thread, keeping the counting cheap
+using bench_stats = sharded_stats<>;
+
+constexpr prefix_size BenchKdmtSize = prefix_size::SIZE_32BIT; //TODO consider benchmarking all sizes
+
+// the random keys are drawn from the 'A'..'z' range, so 5 rather than 4 characters fit into a 32 bit prefix
+using BenchAlphabet = alphabet_encoding<alphabets::letters>;
+
+// hash set keys, caching their hash next to the prefix
+using BenchHashedKdmt = keydomet<hashed<string>, BenchKdmtSize>;
+
+enum ops { Lookups, Mix, ThreeWayLookups }; // ThreeWayLookups use kdmt::find rather than std::set::find
 enum sso { Use, Exceed };
+enum probe_keys { Prebuilt, PerLookup }; // PerLookup probes are built (and hashed) by every lookup
 
 struct container_size { int64_t v; };
 struct op_keys_num { int64_t v; };
 
-template<prefix_size KdmtSize, class StrT>
+// trained encodings get a tag per input, as each input has its own character distribution
+struct rand_sso_on_input {};
+struct rand_sso_off_input {};
+struct dataset_input {};
+
+template<class Encoding, class StrT>
+void train_encoding(Encoding, input_provider<StrT>&, container_size)
+{
+    // only trained encodings need to see the keys
+}
+
+template<class Tag, class StrT>
+void train_encoding(trained_encoding<Tag>, input_provider<StrT>& input, container_size container_size)
+{
+    // train before the container is built; the sample is the keys that build it
+    if (!trained_encoding<Tag>::trained())
+    {
+        const vector<string>& keys = input.get_keys(container_size.v, keys_use::BUILD_CONTAINER);
+        trained_encoding<Tag>::train(keys.begin(), keys.end());
+    }
+}
+
+template<class Container, class KeyT>
+auto three_way_find(Container& container, const KeyT& key)
+{
+    return kdmt::find(container, key);
+}
+
+// B+-tree lookups compare each key once anyway
+template<class KdmtStr, class Slots, class KeyT>
+auto three_way_find(btree_set<KdmtStr, Slots>& container, const KeyT& key)
+{
+    return container.find(key);
+}
+
+template<class KdmtStr, class KeyT>
+auto three_way_find(flat_set<KdmtStr>& container, const KeyT& key)
+{
+    return container.find(key);
+}
+
+template<class KdmtStr, class KeyT>
+auto three_way_find(art_set<KdmtStr>& container, const KeyT& key)
+{
+    return container.find(key);
+}
+
+template<class Container>
+void emplace_op_key(Container& container, const string& op_key)
+{
+    container.emplace(in_place, op_key);
+}
+
+// keys already held are built before being rejected, and heap stored ones would grow the heap
+template<prefix_size KdmtSize, class Tag, class Encoding>
+void emplace_op_key(set<keydomet<heap_stored<Tag>, KdmtSize, bench_stats, Encoding>, less<>>& container,
+        const string& op_key)
+{
+    heap_emplace(container, in_place, op_key);
+}
+
+template<prefix_size KdmtSize, class StrT, class Encoding = raw_encoding,
+        class Container = set<keydomet<StrT, KdmtSize, bench_stats, Encoding>, less<>>>
 void keydomet_bench(benchmark::State& state, ops ops_mix, container_size container_size, op_keys_num op_key_num,
-        input_provider<keydomet<StrT, KdmtSize>>& input)
+        input_provider<keydomet<StrT, KdmtSize, bench_stats, Encoding>>& input)
 {
-    using kdmt_str = keydomet<StrT, KdmtSize>;
-    const size_t prev_used_prefix = kdmt_str::used_prefix();
-    const size_t prev_used_str = kdmt_str::used_string();
-    set<kdmt_str, less<>> container(input.get_container(container_size.v));
+    using kdmt_str = keydomet<StrT, KdmtSize, bench_stats, Encoding>;
+    train_encoding(Encoding{}, input, container_size);
+    const set<kdmt_str, less<>>& keys = input.get_container(container_size.v);
+    Container container(keys.begin(), keys.end());
+    // building the container may compare keys too
+    kdmt_str::reset_stats();
     const vector<string>& op_keys = input.get_keys(op_key_num.v, keys_use::BENCH_OPS);
     size_t ops = 0, found = 0;
     if (ops_mix == ops::Lookups)
@@ -60,10 +147,18 @@ void keydomet_bench(benchmark::State& state, ops ops_mix, container_size contain
         for (auto _ : state)
         {
             auto find_key = make_find_key(container, op_keys[ops++ % op_keys.size()]);
-            static_assert(is_same<decltype(find_key), keydomet<const StrT&, KdmtSize>>::value, "");
+            static_assert(is_same<decltype(find_key), keydomet<const string&, KdmtSize, bench_stats, Encoding>>::value, "");
             found += container.find(find_key) != container.end() ? 1 : 0;
         }
     }
+    else if (ops_mix == ops::ThreeWayLookups)
+    {
+        for (auto _ : state)
+        {
+            auto find_key = make_find_key(container, op_keys[ops++ % op_keys.size()]);
+            found += three_way_find(container, find_key) != container.end() ? 1 : 0;
+        }
+    }
     else
     {
         for (auto _ : state)
@@ -72,7 +167,7 @@ void keydomet_bench(benchmark::State& state, ops ops_mix, container_size contain
             if (ops & 0x1)
             {
                 auto find_key = make_find_key(container, op_key);
-                static_assert(is_same<decltype(find_key), keydomet<const StrT&, KdmtSize>>::value, "");
+                static_assert(is_same<decltype(find_key), keydomet<const string&, KdmtSize, bench_stats, Encoding>>::value, "");
                 found += container.find(find_key) != container.end() ? 1 : 0;
             }
             else
@@ -80,22 +175,62 @@ void keydomet_bench(benchmark::State& state, ops ops_mix, container_size contain
                 if (ops & 0x10)
                 {
                     auto del_key = make_find_key(container, op_key);
-                    static_assert(is_same<decltype(del_key), keydomet<const StrT&, KdmtSize>>::value, "");
+                    static_assert(is_same<decltype(del_key), keydomet<const string&, KdmtSize, bench_stats, Encoding>>::value, "");
                     auto iter = container.find(del_key);
                     if (iter != container.end())
                         container.erase(iter);
                 }
                 else
                 {
-                    container.insert(kdmt_str{op_key});
+                    emplace_op_key(container, op_key);
                 }
             }
         }
     }
     state.counters["1-lookups_found"] = benchmark::Counter{(double)found, benchmark::Counter::kAvgIterations};
-    double kdmt_use_rate = double(kdmt_str::used_prefix() - prev_used_prefix) /
-            ((kdmt_str::used_prefix() - prev_used_prefix) + (kdmt_str::used_string() - prev_used_str));
+    const compare_stats stats = kdmt_str::get_stats();
+    double kdmt_use_rate = double(stats.used_prefix) / (stats.used_prefix + stats.used_string);
     state.counters["2-keydomet_use_rate"] = kdmt_use_rate;
+    state.counters["3-key_bytes"] = sizeof(kdmt_str);
+}
+
+template<class Index>
+void index_counters(benchmark::State&, const Index&)
+{
+}
+
+template<class RandomIt>
+void index_counters(benchmark::State& state, const learned_index<RandomIt>& index)
+{
+    const learned_index_metrics metrics = index.metrics();
+    state.counters["4-model_bytes"] = (double)metrics.model_bytes;
+    state.counters["5-max_window"] = (double)metrics.max_window;
+    state.counters["6-mean_error"] = metrics.mean_error;
+}
+
+// lookups in a static index of the container's keys, kept in a sorted vector
+template<prefix_size KdmtSize, class StrT, class MakeIndex>
+void static_index_bench(benchmark::State& state, container_size container_size, op_keys_num op_key_num,
+        input_provider<keydomet<StrT, KdmtSize, bench_stats>>& input, MakeIndex make_index)
+{
+    using kdmt_str = keydomet<StrT, KdmtSize, bench_stats>;
+    const set<kdmt_str, less<>>& keys = input.get_container(container_size.v);
+    const vector<kdmt_str> sorted(keys.begin(), keys.end());
+    const auto index = make_index(sorted);
+    kdmt_str::reset_stats();
+    const vector<string>& op_keys = input.get_keys(op_key_num.v, keys_use::BENCH_OPS);
+    size_t ops = 0, found = 0;
+    for (auto _ : state)
+    {
+        const keydomet<const string&, KdmtSize, bench_stats> find_key{op_keys[ops++ % op_keys.size()]};
+        found += index.contains(find_key) ? 1 : 0;
+    }
+    state.counters["1-lookups_found"] = benchmark::Counter{(double)found, benchmark::Counter::kAvgIterations};
+    const compare_stats stats = kdmt_str::get_stats();
+    double kdmt_use_rate = double(stats.used_prefix) / (stats.used_prefix + stats.used_string);
+    state.counters["2-keydomet_use_rate"] = kdmt_use_rate;
+    state.counters["3-key_bytes"] = sizeof(kdmt_str);
+    index_counters(state, index);
 }
 
 template<template<typename...> class Container, typename... CArgs>
@@ -145,6 +280,60 @@ void string_bench(benchmark::State& state, ops ops_mix, container_size container
         }
     }
     state.counters["1-lookups_found"] = benchmark::Counter{(double)found, benchmark::Counter::kAvgIterations};
+    state.counters["3-key_bytes"] = sizeof(StrT);
+}
+
+// hash sets of strings vs. hash sets of hash caching keydomets. C++14 hash containers lack heterogeneous lookups,
+// so lookups are given keys of the container's type. Prebuilt probes are built before the timed loop, hence a
+// keydomet probe's hash is computed outside of it, while a string probe is hashed by every find(). PerLookup
+// probes are built from the strings within the loop, so both key types pay for a copy and for hashing.
+template<class KeyT, class Hash = std::hash<KeyT>, class Equal = std::equal_to<KeyT>>
+void hash_bench(benchmark::State& state, probe_keys probe_keys, container_size container_size,
+        op_keys_num op_key_num, input_provider<string>& input)
+{
+    const set<string, less<>>& str_container = input.get_container(container_size.v);
+    unordered_set<KeyT, Hash, Equal> container{str_container.begin(), str_container.end()};
+    const vector<string>& op_keys = input.get_keys(op_key_num.v, keys_use::BENCH_OPS);
+    const vector<KeyT> probes = probe_keys == Prebuilt ? vector<KeyT>{op_keys.begin(), op_keys.end()} :
+                                                         vector<KeyT>{};
+    size_t ops = 0, found = 0;
+    for (auto _ : state)
+    {
+        if (probe_keys == Prebuilt)
+        {
+            found += container.find(probes[ops++ % probes.size()]) != container.end() ? 1 : 0;
+        }
+        else
+        {
+            const KeyT probe{op_keys[ops++ % op_keys.size()]};
+            found += container.find(probe) != container.end() ? 1 : 0;
+        }
+    }
+    state.counters["1-lookups_found"] = benchmark::Counter{(double)found, benchmark::Counter::kAvgIterations};
+    state.counters["3-key_bytes"] = sizeof(KeyT);
+}
+
+// fixed-width keys (e.g., tickers or hashes) held in a std::string or a std::array<char, N>. The random keys are
+// N characters long, and the probes are keys of the same type, built before the timed loop.
+template<size_t N, class StrT>
+void fixed_width_bench(benchmark::State& state, container_size container_size, op_keys_num op_key_num)
+{
+    using kdmt_str = keydomet<StrT, BenchKdmtSize, bench_stats>;
+    const uint32_t key_len = calc_key_len(max(container_size.v, op_key_num.v));
+    auto input = get_rand_input<kdmt_str>(key_len, N - key_len);
+    kdmt_str::reset_stats();
+    const set<kdmt_str, less<>>& container = input->get_container(container_size.v);
+    const vector<string>& op_keys = input->get_keys(op_key_num.v, keys_use::BENCH_OPS);
+    const vector<kdmt_str> probes{op_keys.begin(), op_keys.end()};
+    size_t ops = 0, found = 0;
+    for (auto _ : state)
+    {
+        found += container.find(probes[ops++ % probes.size()]) != container.end() ? 1 : 0;
+    }
+    state.counters["1-lookups_found"] = benchmark::Counter{(double)found, benchmark::Counter::kAvgIterations};
+    const compare_stats stats = kdmt_str::get_stats();
+    state.counters["2-keydomet_use_rate"] = double(stats.used_prefix) / (stats.used_prefix + stats.used_string);
+    state.counters["3-key_bytes"] = sizeof(kdmt_str);
 }
 
 const char* datasetFile = "datasets/2.5M keys.csv";
@@ -160,6 +349,17 @@ void get_rand_bench_args(const benchmark::State& state, sso is_sso,
     provider = get_rand_input<StrT>(key_len, extra_len);
 }
 
+// keys of head_len + key_len characters, whose prefixes all collide
+template<typename StrT>
+void get_colliding_bench_args(const benchmark::State& state, uint32_t head_len,
+        container_size& container_size, op_keys_num& op_key_num, std::unique_ptr<input_provider<StrT>>& provider)
+{
+    container_size.v = state.range(0);
+    op_key_num.v = state.range(1);
+    uint32_t key_len = calc_key_len(max(container_size.v, op_key_num.v));
+    provider = get_colliding_input<StrT>(head_len, key_len, 0);
+}
+
 void BM_WarmupSsoOn(benchmark::State& state)
 {
     container_size container_size;
@@ -167,7 +367,10 @@ void BM_WarmupSsoOn(benchmark::State& state)
     std::unique_ptr<input_provider<string>> provider;
     get_rand_bench_args(state, sso::Use, container_size, op_key_num, provider);
     string_bench<string>(state, ops::Lookups, container_size, op_key_num, *provider);
-    cerr << "Types sizes: std::string = " << sizeof(string) << "B, std::string_view = " << sizeof(string_view) << "B" << endl;
+    cerr << "Types sizes: std::string = " << sizeof(string) << "B, std::string_view = " << sizeof(string_view) <<
+            "B, keydomet<std::string> = " << sizeof(keydomet<string, BenchKdmtSize>) <<
+            "B, keydomet<kstring> = " << sizeof(keydomet<kstring, BenchKdmtSize>) <<
+            "B, keydomet<heap_stored<>> = " << sizeof(keydomet<heap_stored<>, BenchKdmtSize>) << "B" << endl;
 }
 
 void BM_WarmupSsoOff(benchmark::State& state)
@@ -185,58 +388,237 @@ void BM_WarmupDataset(benchmark::State& state)
     string_bench<string>(state, ops::Lookups, container_size{state.range(0)}, op_keys_num{state.range(1)}, *provider);
 }
 
-template<prefix_size KdmtSize, class StrT>
+template<prefix_size KdmtSize, class StrT, class Encoding = raw_encoding>
 void BM_KeydometAllOpsSsoOn(benchmark::State& state)
 {
     container_size container_size;
     op_keys_num op_key_num;
-    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize>>> provider;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats, Encoding>>> provider;
     get_rand_bench_args(state, sso::Use, container_size, op_key_num, provider);
-    keydomet_bench<KdmtSize, StrT>(state, ops::Mix, container_size, op_key_num, *provider);
+    keydomet_bench<KdmtSize, StrT, Encoding>(state, ops::Mix, container_size, op_key_num, *provider);
 }
 
-template<prefix_size KdmtSize, class StrT>
+template<prefix_size KdmtSize, class StrT, class Encoding = raw_encoding>
 void BM_KeydometAllOpsSsoOff(benchmark::State& state)
 {
     container_size container_size;
     op_keys_num op_key_num;
-    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize>>> provider;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats, Encoding>>> provider;
     get_rand_bench_args(state, sso::Exceed, container_size, op_key_num, provider);
-    keydomet_bench<KdmtSize, StrT>(state, ops::Mix, container_size, op_key_num, *provider);
+    keydomet_bench<KdmtSize, StrT, Encoding>(state, ops::Mix, container_size, op_key_num, *provider);
 }
 
-template<prefix_size KdmtSize, class StrT>
+template<prefix_size KdmtSize, class StrT, class Encoding = raw_encoding>
 void BM_KeydometAllOpsDataset(benchmark::State& state)
 {
-    auto provider = get_dataset_input<keydomet<StrT, KdmtSize>>(datasetFile);
-    keydomet_bench<KdmtSize, StrT>(state, ops::Mix, container_size{state.range(0)}, op_keys_num{state.range(1)}, *provider);
+    auto provider = get_dataset_input<keydomet<StrT, KdmtSize, bench_stats, Encoding>>(datasetFile);
+    keydomet_bench<KdmtSize, StrT, Encoding>(state, ops::Mix, container_size{state.range(0)}, op_keys_num{state.range(1)}, *provider);
 }
 
-template<prefix_size KdmtSize, class StrT>
+template<prefix_size KdmtSize, class StrT, class Encoding = raw_encoding>
 void BM_KeydometLookupsDataset(benchmark::State& state)
 {
-    auto provider = get_dataset_input<keydomet<StrT, KdmtSize>>(datasetFile);
-    keydomet_bench<KdmtSize, StrT>(state, ops::Lookups, container_size{state.range(0)}, op_keys_num{state.range(1)}, *provider);
+    auto provider = get_dataset_input<keydomet<StrT, KdmtSize, bench_stats, Encoding>>(datasetFile);
+    keydomet_bench<KdmtSize, StrT, Encoding>(state, ops::Lookups, container_size{state.range(0)}, op_keys_num{state.range(1)}, *provider);
 }
 
-template<prefix_size KdmtSize, class StrT>
+template<prefix_size KdmtSize, class StrT, class Encoding = raw_encoding>
 void BM_KeydometLookupsSsoOn(benchmark::State& state)
 {
     container_size container_size;
     op_keys_num op_key_num;
-    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize>>> provider;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats, Encoding>>> provider;
     get_rand_bench_args(state, sso::Use, container_size, op_key_num, provider);
-    keydomet_bench<KdmtSize, StrT>(state, ops::Lookups, container_size, op_key_num, *provider);
+    keydomet_bench<KdmtSize, StrT, Encoding>(state, ops::Lookups, container_size, op_key_num, *provider);
 }
 
-template<prefix_size KdmtSize, class StrT>
+template<prefix_size KdmtSize, class StrT, class Encoding = raw_encoding>
 void BM_KeydometLookupsSsoOff(benchmark::State& state)
 {
     container_size container_size;
     op_keys_num op_key_num;
-    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize>>> provider;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats, Encoding>>> provider;
+    get_rand_bench_args(state, sso::Exceed, container_size, op_key_num, provider);
+    keydomet_bench<KdmtSize, StrT, Encoding>(state, ops::Lookups, container_size, op_key_num, *provider);
+}
+
+template<prefix_size KdmtSize, class StrT, uint32_t HeadLen, ops Ops = ops::Lookups>
+void BM_KeydometLookupsColliding(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats>>> provider;
+    get_colliding_bench_args(state, HeadLen, container_size, op_key_num, provider);
+    keydomet_bench<KdmtSize, StrT>(state, Ops, container_size, op_key_num, *provider);
+}
+
+template<prefix_size KdmtSize, class StrT>
+void BM_KeydometThreeWayLookupsSsoOn(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats>>> provider;
+    get_rand_bench_args(state, sso::Use, container_size, op_key_num, provider);
+    keydomet_bench<KdmtSize, StrT>(state, ops::ThreeWayLookups, container_size, op_key_num, *provider);
+}
+
+// keydomets of the random and dataset inputs, held by a B+-tree rather than a std::set
+template<prefix_size KdmtSize, class StrT>
+using bench_btree = btree_set<keydomet<StrT, KdmtSize, bench_stats>>;
+
+template<prefix_size KdmtSize, class StrT, ops Ops>
+void BM_KeydometBTreeSsoOn(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats>>> provider;
+    get_rand_bench_args(state, sso::Use, container_size, op_key_num, provider);
+    keydomet_bench<KdmtSize, StrT, raw_encoding, bench_btree<KdmtSize, StrT>>(state, Ops, container_size, op_key_num,
+                                                                              *provider);
+}
+
+template<prefix_size KdmtSize, class StrT, ops Ops>
+void BM_KeydometBTreeSsoOff(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats>>> provider;
+    get_rand_bench_args(state, sso::Exceed, container_size, op_key_num, provider);
+    keydomet_bench<KdmtSize, StrT, raw_encoding, bench_btree<KdmtSize, StrT>>(state, Ops, container_size, op_key_num,
+                                                                              *provider);
+}
+
+template<prefix_size KdmtSize, class StrT, ops Ops>
+void BM_KeydometBTreeDataset(benchmark::State& state)
+{
+    auto provider = get_dataset_input<keydomet<StrT, KdmtSize, bench_stats>>(datasetFile);
+    keydomet_bench<KdmtSize, StrT, raw_encoding, bench_btree<KdmtSize, StrT>>(state, Ops,
+            container_size{state.range(0)}, op_keys_num{state.range(1)}, *provider);
+}
+
+// keydomets of the random and dataset inputs, held by an adaptive radix tree
+template<prefix_size KdmtSize, class StrT>
+using bench_art = art_set<keydomet<StrT, KdmtSize, bench_stats>>;
+
+template<prefix_size KdmtSize, class StrT, ops Ops>
+void BM_KeydometArtSsoOn(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats>>> provider;
+    get_rand_bench_args(state, sso::Use, container_size, op_key_num, provider);
+    keydomet_bench<KdmtSize, StrT, raw_encoding, bench_art<KdmtSize, StrT>>(state, Ops, container_size, op_key_num,
+                                                                            *provider);
+}
+
+template<prefix_size KdmtSize, class StrT, ops Ops>
+void BM_KeydometArtSsoOff(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats>>> provider;
     get_rand_bench_args(state, sso::Exceed, container_size, op_key_num, provider);
-    keydomet_bench<KdmtSize, StrT>(state, ops::Lookups, container_size, op_key_num, *provider);
+    keydomet_bench<KdmtSize, StrT, raw_encoding, bench_art<KdmtSize, StrT>>(state, Ops, container_size, op_key_num,
+                                                                            *provider);
+}
+
+template<prefix_size KdmtSize, class StrT, ops Ops>
+void BM_KeydometArtDataset(benchmark::State& state)
+{
+    auto provider = get_dataset_input<keydomet<StrT, KdmtSize, bench_stats>>(datasetFile);
+    keydomet_bench<KdmtSize, StrT, raw_encoding, bench_art<KdmtSize, StrT>>(state, Ops,
+            container_size{state.range(0)}, op_keys_num{state.range(1)}, *provider);
+}
+
+// sorted vectors are meant for read-mostly indexes, hence are only used for lookups
+template<prefix_size KdmtSize, class StrT>
+void BM_KeydometFlatLookupsSsoOn(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats>>> provider;
+    get_rand_bench_args(state, sso::Use, container_size, op_key_num, provider);
+    keydomet_bench<KdmtSize, StrT, raw_encoding, flat_set<keydomet<StrT, KdmtSize, bench_stats>>>(state, ops::Lookups,
+            container_size, op_key_num, *provider);
+}
+
+template<prefix_size KdmtSize, class StrT>
+void BM_KeydometFlatLookupsSsoOff(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats>>> provider;
+    get_rand_bench_args(state, sso::Exceed, container_size, op_key_num, provider);
+    keydomet_bench<KdmtSize, StrT, raw_encoding, flat_set<keydomet<StrT, KdmtSize, bench_stats>>>(state, ops::Lookups,
+            container_size, op_key_num, *provider);
+}
+
+template<prefix_size KdmtSize, class StrT>
+void BM_KeydometFlatLookupsDataset(benchmark::State& state)
+{
+    auto provider = get_dataset_input<keydomet<StrT, KdmtSize, bench_stats>>(datasetFile);
+    keydomet_bench<KdmtSize, StrT, raw_encoding, flat_set<keydomet<StrT, KdmtSize, bench_stats>>>(state, ops::Lookups,
+            container_size{state.range(0)}, op_keys_num{state.range(1)}, *provider);
+}
+
+template<prefix_size KdmtSize, class StrT>
+void BM_KeydometEytzingerSsoOn(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats>>> provider;
+    get_rand_bench_args(state, sso::Use, container_size, op_key_num, provider);
+    static_index_bench<KdmtSize, StrT>(state, container_size, op_key_num, *provider,
+            [](const auto& sorted) { return make_eytzinger_index(sorted); });
+}
+
+template<prefix_size KdmtSize, class StrT>
+void BM_KeydometEytzingerSsoOff(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats>>> provider;
+    get_rand_bench_args(state, sso::Exceed, container_size, op_key_num, provider);
+    static_index_bench<KdmtSize, StrT>(state, container_size, op_key_num, *provider,
+            [](const auto& sorted) { return make_eytzinger_index(sorted); });
+}
+
+template<prefix_size KdmtSize, class StrT>
+void BM_KeydometEytzingerDataset(benchmark::State& state)
+{
+    auto provider = get_dataset_input<keydomet<StrT, KdmtSize, bench_stats>>(datasetFile);
+    static_index_bench<KdmtSize, StrT>(state, container_size{state.range(0)}, op_keys_num{state.range(1)}, *provider,
+            [](const auto& sorted) { return make_eytzinger_index(sorted); });
+}
+
+template<prefix_size KdmtSize, class StrT, learned_search Search>
+void BM_KeydometLearnedSsoOn(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats>>> provider;
+    get_rand_bench_args(state, sso::Use, container_size, op_key_num, provider);
+    static_index_bench<KdmtSize, StrT>(state, container_size, op_key_num, *provider,
+            [](const auto& sorted) { return make_learned_index(sorted, Search); });
+}
+
+template<prefix_size KdmtSize, class StrT, learned_search Search>
+void BM_KeydometLearnedSsoOff(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<keydomet<StrT, KdmtSize, bench_stats>>> provider;
+    get_rand_bench_args(state, sso::Exceed, container_size, op_key_num, provider);
+    static_index_bench<KdmtSize, StrT>(state, container_size, op_key_num, *provider,
+            [](const auto& sorted) { return make_learned_index(sorted, Search); });
+}
+
+template<prefix_size KdmtSize, class StrT, learned_search Search>
+void BM_KeydometLearnedDataset(benchmark::State& state)
+{
+    auto provider = get_dataset_input<keydomet<StrT, KdmtSize, bench_stats>>(datasetFile);
+    static_index_bench<KdmtSize, StrT>(state, container_size{state.range(0)}, op_keys_num{state.range(1)}, *provider,
+            [](const auto& sorted) { return make_learned_index(sorted, Search); });
 }
 
 void BM_StringAllOpsSsoOn(benchmark::State& state)
@@ -275,6 +657,16 @@ void BM_StringLookupsSsoOff(benchmark::State& state)
     string_bench<string>(state, ops::Lookups, container_size, op_key_num, *provider);
 }
 
+template<uint32_t HeadLen>
+void BM_StringLookupsColliding(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<string>> provider;
+    get_colliding_bench_args(state, HeadLen, container_size, op_key_num, provider);
+    string_bench<string>(state, ops::Lookups, container_size, op_key_num, *provider);
+}
+
 void BM_StringAllOpsDataset(benchmark::State& state)
 {
     auto provider = get_dataset_input<string>(datasetFile);
@@ -287,6 +679,34 @@ void BM_StringLookupsDataset(benchmark::State& state)
     string_bench<string>(state, ops::Lookups, container_size{state.range(0)}, op_keys_num{state.range(1)}, *provider);
 }
 
+template<probe_keys ProbeKeys, class KeyT, class... HashArgs>
+void BM_HashLookupsSsoOn(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<string>> provider;
+    get_rand_bench_args(state, sso::Use, container_size, op_key_num, provider);
+    hash_bench<KeyT, HashArgs...>(state, ProbeKeys, container_size, op_key_num, *provider);
+}
+
+template<probe_keys ProbeKeys, class KeyT, class... HashArgs>
+void BM_HashLookupsSsoOff(benchmark::State& state)
+{
+    container_size container_size;
+    op_keys_num op_key_num;
+    std::unique_ptr<input_provider<string>> provider;
+    get_rand_bench_args(state, sso::Exceed, container_size, op_key_num, provider);
+    hash_bench<KeyT, HashArgs...>(state, ProbeKeys, container_size, op_key_num, *provider);
+}
+
+template<probe_keys ProbeKeys, class KeyT, class... HashArgs>
+void BM_HashLookupsDataset(benchmark::State& state)
+{
+    auto provider = get_dataset_input<string>(datasetFile);
+    hash_bench<KeyT, HashArgs...>(state, ProbeKeys, container_size{state.range(0)}, op_keys_num{state.range(1)},
+                                  *provider);
+}
+
 void BM_StringViewLookups(benchmark::State& state)
 {
     container_size container_size;
@@ -317,6 +737,13 @@ void BM_StringViewAllOpsDataset(benchmark::State& state)
     string_bench<string_view>(state, ops::Mix, container_size{state.range(0)}, op_keys_num{state.range(1)}, *provider);
 }
 
+template<size_t N, class StrT>
+void BM_FixedWidthLookups(benchmark::State& state)
+{
+    fixed_width_bench<N, StrT>(state, container_size{state.range(0)}, op_keys_num{state.range(1)});
+}
+
+// prefix extraction from a sized string - uses a single wide load and masking
 template<prefix_size KdmtSize>
 void BM_KeydometCreation(benchmark::State& state)
 {
@@ -331,6 +758,23 @@ void BM_KeydometCreation(benchmark::State& state)
     }
 }
 
+// prefix extraction from a c-string - length is unknown, so the characters are scanned (strncpy)
+template<prefix_size KdmtSize>
+void BM_KeydometCreationScan(benchmark::State& state)
+{
+    using keydomet_type = typename prefix_storage<KdmtSize>::type;
+    size_t strLen = state.range(0);
+    string source(strLen, 'e');
+    const char* csource = source.c_str();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(csource);
+        benchmark::DoNotOptimize(
+                str_to_prefix<keydomet_type>(csource)
+        );
+    }
+}
+
 //constexpr size_t IterationsNum = 3'000;
 //constexpr size_t container_size = 2'000;
 //constexpr size_t OpsKeysNumber = 3'000;
@@ -348,13 +792,25 @@ constexpr size_t OpsKeysNumber = 300'000;
 //constexpr size_t OpsKeysNumber = 3'000'000;
 
 constexpr size_t Repeats = 5;
-constexpr prefix_size BenchKdmtSize = prefix_size::SIZE_32BIT; //TODO consider benchmarking all sizes
 
 #define BENCH_KeydometCreation  1
 #define BENCH_Warmup            1
 #define BENCH_StdString         1
 #define BENCH_StdStringView     1
 #define BENCH_Keydomet          1
+#define BENCH_KeydometKstring   1
+#define BENCH_KeydometHeap      1
+#define BENCH_KeydometAlphabet  1
+#define BENCH_KeydometTrained   1
+#define BENCH_HashSet           1
+#define BENCH_FixedWidth        1
+#define BENCH_Colliding         1
+#define BENCH_ThreeWay          1
+#define BENCH_BTree             1
+#define BENCH_Art               1
+#define BENCH_FlatSet           1
+#define BENCH_Eytzinger         1
+#define BENCH_Learned           1
 #define BENCH_LookupsOnly       1
 #define BENCH_AllOps            1
 #define BENCH_SsoOn             1
@@ -376,6 +832,10 @@ BENCHMARK_TEMPLATE(BM_KeydometCreation, prefix_size::SIZE_16BIT) KdmtCreationCon
 BENCHMARK_TEMPLATE(BM_KeydometCreation, prefix_size::SIZE_32BIT) KdmtCreationConf();
 BENCHMARK_TEMPLATE(BM_KeydometCreation, prefix_size::SIZE_64BIT) KdmtCreationConf();
 BENCHMARK_TEMPLATE(BM_KeydometCreation, prefix_size::SIZE_128BIT) KdmtCreationConf();
+BENCHMARK_TEMPLATE(BM_KeydometCreationScan, prefix_size::SIZE_16BIT) KdmtCreationConf();
+BENCHMARK_TEMPLATE(BM_KeydometCreationScan, prefix_size::SIZE_32BIT) KdmtCreationConf();
+BENCHMARK_TEMPLATE(BM_KeydometCreationScan, prefix_size::SIZE_64BIT) KdmtCreationConf();
+BENCHMARK_TEMPLATE(BM_KeydometCreationScan, prefix_size::SIZE_128BIT) KdmtCreationConf();
 #endif
 
 #if BENCH_Warmup
@@ -467,6 +927,275 @@ BENCHMARK_TEMPLATE(BM_KeydometAllOpsDataset, BenchKdmtSize, std::string) BenchCo
 #endif // BENCH_Dataset
 #endif // BENCH_Keydomet
 
+#if BENCH_KeydometKstring
+#if BENCH_RandInput
+#if BENCH_LookupsOnly
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometLookupsSsoOn, BenchKdmtSize, kstring) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometLookupsSsoOff, BenchKdmtSize, kstring) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_LookupsOnly
+#if BENCH_AllOps
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometAllOpsSsoOn, BenchKdmtSize, kstring) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometAllOpsSsoOff, BenchKdmtSize, kstring) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_AllOps
+#endif // BENCH_RandInput
+#if BENCH_Dataset
+#if BENCH_LookupsOnly
+BENCHMARK_TEMPLATE(BM_KeydometLookupsDataset, BenchKdmtSize, kstring) BenchConfig(Repeats);
+#endif // BENCH_LookupsOnly
+#if BENCH_AllOps
+BENCHMARK_TEMPLATE(BM_KeydometAllOpsDataset, BenchKdmtSize, kstring) BenchConfig(Repeats);
+#endif // BENCH_AllOps
+#endif // BENCH_Dataset
+#endif // BENCH_KeydometKstring
+
+#if BENCH_KeydometHeap
+#if BENCH_RandInput
+#if BENCH_LookupsOnly
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometLookupsSsoOn, BenchKdmtSize, heap_stored<>) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometLookupsSsoOff, BenchKdmtSize, heap_stored<>) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_LookupsOnly
+#if BENCH_AllOps
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometAllOpsSsoOn, BenchKdmtSize, heap_stored<>) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometAllOpsSsoOff, BenchKdmtSize, heap_stored<>) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_AllOps
+#endif // BENCH_RandInput
+#if BENCH_Dataset
+#if BENCH_LookupsOnly
+BENCHMARK_TEMPLATE(BM_KeydometLookupsDataset, BenchKdmtSize, heap_stored<>) BenchConfig(Repeats);
+#endif // BENCH_LookupsOnly
+#if BENCH_AllOps
+BENCHMARK_TEMPLATE(BM_KeydometAllOpsDataset, BenchKdmtSize, heap_stored<>) BenchConfig(Repeats);
+#endif // BENCH_AllOps
+#endif // BENCH_Dataset
+#endif // BENCH_KeydometHeap
+
+#if BENCH_KeydometAlphabet
+#if BENCH_RandInput
+#if BENCH_LookupsOnly
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometLookupsSsoOn, BenchKdmtSize, std::string, BenchAlphabet) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometLookupsSsoOff, BenchKdmtSize, std::string, BenchAlphabet) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_LookupsOnly
+#if BENCH_AllOps
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometAllOpsSsoOn, BenchKdmtSize, std::string, BenchAlphabet) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometAllOpsSsoOff, BenchKdmtSize, std::string, BenchAlphabet) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_AllOps
+#endif // BENCH_RandInput
+#if BENCH_Dataset
+#if BENCH_LookupsOnly
+BENCHMARK_TEMPLATE(BM_KeydometLookupsDataset, BenchKdmtSize, std::string, BenchAlphabet) BenchConfig(Repeats);
+#endif // BENCH_LookupsOnly
+#if BENCH_AllOps
+BENCHMARK_TEMPLATE(BM_KeydometAllOpsDataset, BenchKdmtSize, std::string, BenchAlphabet) BenchConfig(Repeats);
+#endif // BENCH_AllOps
+#endif // BENCH_Dataset
+#endif // BENCH_KeydometAlphabet
+
+#if BENCH_KeydometTrained
+#if BENCH_RandInput
+#if BENCH_LookupsOnly
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometLookupsSsoOn, BenchKdmtSize, std::string, trained_encoding<rand_sso_on_input>) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometLookupsSsoOff, BenchKdmtSize, std::string, trained_encoding<rand_sso_off_input>) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_LookupsOnly
+#if BENCH_AllOps
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometAllOpsSsoOn, BenchKdmtSize, std::string, trained_encoding<rand_sso_on_input>) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometAllOpsSsoOff, BenchKdmtSize, std::string, trained_encoding<rand_sso_off_input>) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_AllOps
+#endif // BENCH_RandInput
+#if BENCH_Dataset
+#if BENCH_LookupsOnly
+BENCHMARK_TEMPLATE(BM_KeydometLookupsDataset, BenchKdmtSize, std::string, trained_encoding<dataset_input>) BenchConfig(Repeats);
+#endif // BENCH_LookupsOnly
+#if BENCH_AllOps
+BENCHMARK_TEMPLATE(BM_KeydometAllOpsDataset, BenchKdmtSize, std::string, trained_encoding<dataset_input>) BenchConfig(Repeats);
+#endif // BENCH_AllOps
+#endif // BENCH_Dataset
+#endif // BENCH_KeydometTrained
+
+#if BENCH_HashSet
+#if BENCH_RandInput
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_HashLookupsSsoOn, Prebuilt, std::string) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_HashLookupsSsoOn, Prebuilt, BenchHashedKdmt, kdmt::hash, kdmt::equal_to) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_HashLookupsSsoOn, PerLookup, std::string) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_HashLookupsSsoOn, PerLookup, BenchHashedKdmt, kdmt::hash, kdmt::equal_to) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_HashLookupsSsoOff, Prebuilt, std::string) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_HashLookupsSsoOff, Prebuilt, BenchHashedKdmt, kdmt::hash, kdmt::equal_to) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_HashLookupsSsoOff, PerLookup, std::string) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_HashLookupsSsoOff, PerLookup, BenchHashedKdmt, kdmt::hash, kdmt::equal_to) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_RandInput
+#if BENCH_Dataset
+BENCHMARK_TEMPLATE(BM_HashLookupsDataset, Prebuilt, std::string) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_HashLookupsDataset, Prebuilt, BenchHashedKdmt, kdmt::hash, kdmt::equal_to) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_HashLookupsDataset, PerLookup, std::string) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_HashLookupsDataset, PerLookup, BenchHashedKdmt, kdmt::hash, kdmt::equal_to) BenchConfig(Repeats);
+#endif // BENCH_Dataset
+#endif // BENCH_HashSet
+
+#if BENCH_FixedWidth && BENCH_RandInput
+BENCHMARK_TEMPLATE(BM_FixedWidthLookups, 16, std::string) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_FixedWidthLookups, 16, std::array<char, 16>) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_FixedWidthLookups, 32, std::string) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_FixedWidthLookups, 32, std::array<char, 32>) BenchConfig(Repeats);
+#endif // BENCH_FixedWidth
+
+#if BENCH_Colliding
+BENCHMARK_TEMPLATE(BM_StringLookupsColliding, 64) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_KeydometLookupsColliding, BenchKdmtSize, std::string, 64) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_StringLookupsColliding, 192) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_KeydometLookupsColliding, BenchKdmtSize, std::string, 192) BenchConfig(Repeats);
+#endif // BENCH_Colliding
+
+#if BENCH_ThreeWay
+#if BENCH_RandInput && BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometThreeWayLookupsSsoOn, BenchKdmtSize, std::string) BenchConfig(Repeats);
+#endif // BENCH_RandInput
+#if BENCH_Colliding
+BENCHMARK_TEMPLATE(BM_KeydometLookupsColliding, BenchKdmtSize, std::string, 64, ops::ThreeWayLookups) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_KeydometLookupsColliding, BenchKdmtSize, std::string, 192, ops::ThreeWayLookups) BenchConfig(Repeats);
+#endif // BENCH_Colliding
+#endif // BENCH_ThreeWay
+
+#if BENCH_BTree
+#if BENCH_RandInput
+#if BENCH_LookupsOnly
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometBTreeSsoOn, BenchKdmtSize, std::string, ops::Lookups) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometBTreeSsoOff, BenchKdmtSize, std::string, ops::Lookups) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_LookupsOnly
+#if BENCH_AllOps
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometBTreeSsoOn, BenchKdmtSize, std::string, ops::Mix) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometBTreeSsoOff, BenchKdmtSize, std::string, ops::Mix) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_AllOps
+#endif // BENCH_RandInput
+#if BENCH_Dataset
+#if BENCH_LookupsOnly
+BENCHMARK_TEMPLATE(BM_KeydometBTreeDataset, BenchKdmtSize, std::string, ops::Lookups) BenchConfig(Repeats);
+#endif // BENCH_LookupsOnly
+#if BENCH_AllOps
+BENCHMARK_TEMPLATE(BM_KeydometBTreeDataset, BenchKdmtSize, std::string, ops::Mix) BenchConfig(Repeats);
+#endif // BENCH_AllOps
+#endif // BENCH_Dataset
+#endif // BENCH_BTree
+
+#if BENCH_Art
+#if BENCH_RandInput
+#if BENCH_LookupsOnly
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometArtSsoOn, BenchKdmtSize, std::string, ops::Lookups) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometArtSsoOff, BenchKdmtSize, std::string, ops::Lookups) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_LookupsOnly
+#if BENCH_AllOps
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometArtSsoOn, BenchKdmtSize, std::string, ops::Mix) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometArtSsoOff, BenchKdmtSize, std::string, ops::Mix) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_AllOps
+#endif // BENCH_RandInput
+#if BENCH_Dataset
+#if BENCH_LookupsOnly
+BENCHMARK_TEMPLATE(BM_KeydometArtDataset, BenchKdmtSize, std::string, ops::Lookups) BenchConfig(Repeats);
+#endif // BENCH_LookupsOnly
+#if BENCH_AllOps
+BENCHMARK_TEMPLATE(BM_KeydometArtDataset, BenchKdmtSize, std::string, ops::Mix) BenchConfig(Repeats);
+#endif // BENCH_AllOps
+#endif // BENCH_Dataset
+#endif // BENCH_Art
+
+#if BENCH_FlatSet && BENCH_LookupsOnly
+#if BENCH_RandInput
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometFlatLookupsSsoOn, BenchKdmtSize, std::string) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometFlatLookupsSsoOff, BenchKdmtSize, std::string) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_RandInput
+#if BENCH_Dataset
+BENCHMARK_TEMPLATE(BM_KeydometFlatLookupsDataset, BenchKdmtSize, std::string) BenchConfig(Repeats);
+#endif // BENCH_Dataset
+#endif // BENCH_FlatSet
+
+#if BENCH_Eytzinger && BENCH_LookupsOnly
+#if BENCH_RandInput
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometEytzingerSsoOn, BenchKdmtSize, std::string) BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometEytzingerSsoOff, BenchKdmtSize, std::string) BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_RandInput
+#if BENCH_Dataset
+BENCHMARK_TEMPLATE(BM_KeydometEytzingerDataset, BenchKdmtSize, std::string) BenchConfig(Repeats);
+#endif // BENCH_Dataset
+#endif // BENCH_Eytzinger
+
+#if BENCH_Learned && BENCH_LookupsOnly
+#if BENCH_RandInput
+#if BENCH_SsoOn
+BENCHMARK_TEMPLATE(BM_KeydometLearnedSsoOn, BenchKdmtSize, std::string, learned_search::model) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_KeydometLearnedSsoOn, BenchKdmtSize, std::string, learned_search::interpolation)
+        BenchConfig(Repeats);
+#endif // BENCH_SsoOn
+#if BENCH_SsoOff
+BENCHMARK_TEMPLATE(BM_KeydometLearnedSsoOff, BenchKdmtSize, std::string, learned_search::model) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_KeydometLearnedSsoOff, BenchKdmtSize, std::string, learned_search::interpolation)
+        BenchConfig(Repeats);
+#endif // BENCH_SsoOff
+#endif // BENCH_RandInput
+#if BENCH_Dataset
+BENCHMARK_TEMPLATE(BM_KeydometLearnedDataset, BenchKdmtSize, std::string, learned_search::model) BenchConfig(Repeats);
+BENCHMARK_TEMPLATE(BM_KeydometLearnedDataset, BenchKdmtSize, std::string, learned_search::interpolation)
+        BenchConfig(Repeats);
+#endif // BENCH_Dataset
+#endif // BENCH_Learned
+
 class ConsoleReporter2 : public ::benchmark::ConsoleReporter {
 
 private:
@@ -0,0 +1,957 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef KEYDOMET_BTREE_H
+#define KEYDOMET_BTREE_H
+
+#include "Keydomet.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+#include <initializer_list>
+
+namespace kdmt
+{
+
+    // the number of keys held by each node of a btree_set or btree_map, e.g., btree_set<kdmt_str, btree_slots<64>>
+    template<size_t N>
+    using btree_slots = std::integral_constant<size_t, N>;
+
+    namespace imp
+    {
+        template<class KeydometT>
+        struct btree_set_policy
+        {
+            using key_type = KeydometT;
+            using value_type = KeydometT;
+            using init_type = KeydometT;
+            using slot_type = KeydometT;
+
+            static const key_type& key(const slot_type& s)
+            {
+                return s;
+            }
+
+            static const value_type& value(const slot_type& s)
+            {
+                return s;
+            }
+
+            template<class... Args>
+            static void construct(slot_type* s, Args&&... args)
+            {
+                new (s) slot_type(std::forward<Args>(args)...);
+            }
+
+            static void transfer(slot_type* dst, slot_type* src)
+            {
+                new (dst) slot_type(std::move(*src));
+                src->~slot_type();
+            }
+
+            static void destroy(slot_type* s)
+            {
+                s->~slot_type();
+            }
+        };
+
+        template<class KeydometT, class T>
+        struct btree_map_policy
+        {
+            using key_type = KeydometT;
+            using mapped_type = T;
+            using value_type = std::pair<const KeydometT, T>;
+            using init_type = std::pair<KeydometT, T>;
+
+            //
+            // The pairs are exposed with const keys, yet moved along with their keys as the slots move within and
+            // between the nodes, as done by other maps storing their pairs in arrays.
+            //
+            union slot_type
+            {
+                slot_type() {}
+                ~slot_type() {}
+
+                value_type value;
+                init_type mutable_value;
+            };
+
+            static const key_type& key(const slot_type& s)
+            {
+                return s.value.first;
+            }
+
+            static const key_type& key(const value_type& v)
+            {
+                return v.first;
+            }
+
+            static const key_type& key(const init_type& v)
+            {
+                return v.first;
+            }
+
+            static value_type& value(slot_type& s)
+            {
+                return s.value;
+            }
+
+            static const value_type& value(const slot_type& s)
+            {
+                return s.value;
+            }
+
+            template<class... Args>
+            static void construct(slot_type* s, Args&&... args)
+            {
+                new (&s->mutable_value) init_type(std::forward<Args>(args)...);
+            }
+
+            static void transfer(slot_type* dst, slot_type* src)
+            {
+                new (&dst->mutable_value) init_type(std::move(src->mutable_value));
+                src->mutable_value.~init_type();
+            }
+
+            static void destroy(slot_type* s)
+            {
+                s->mutable_value.~init_type();
+            }
+        };
+
+        //
+        // A B+-tree of keydomets, the common part of btree_set and btree_map. Every node keeps the prefixes of its
+        // keys in an array of their own, ahead of the keys: a node is searched by counting the prefixes smaller than
+        // the searched one, and the keys themselves (and their strings) are only read when the prefixes are equal.
+        // The keys and values are kept by the leaves, which are linked for iteration, while the inner nodes keep
+        // copies of the keys separating their children.
+        // Nodes are only removed once emptied, rather than merged with their siblings when under-full. The tree may
+        // thus become sparse after erasing most of its keys; inserting them again fills the nodes back.
+        //
+        template<class Policy, size_t Slots>
+        class btree
+        {
+
+            static_assert(Slots >= 4, "B+-tree nodes hold at least 4 keys");
+
+            using slot_type = typename Policy::slot_type;
+            using init_type = typename Policy::init_type;
+            using kdmt_type = typename Policy::key_type;
+            using prefix_type = typename prefix_rep<kdmt_type::size>::prefix_type;
+            using stats = typename kdmt_type::stats;
+
+            struct inner_node;
+
+            struct node
+            {
+                explicit node(bool is_leaf) : leaf{is_leaf} {}
+
+                inner_node* parent = nullptr;
+                uint32_t count = 0; // the keys held by a leaf, or the separators held by an inner node
+                const bool leaf;
+                prefix_type prefixes[Slots];
+            };
+
+            struct leaf_node : node
+            {
+                leaf_node() : node{true} {}
+
+                leaf_node* prev = nullptr;
+                leaf_node* next = nullptr;
+                typename std::aligned_storage<sizeof(slot_type), alignof(slot_type)>::type slots[Slots];
+
+                slot_type* slot(size_t i)
+                {
+                    return reinterpret_cast<slot_type*>(&slots[i]);
+                }
+
+                const slot_type* slot(size_t i) const
+                {
+                    return reinterpret_cast<const slot_type*>(&slots[i]);
+                }
+
+                const kdmt_type& key(size_t i) const
+                {
+                    return Policy::key(*slot(i));
+                }
+            };
+
+            struct inner_node : node
+            {
+                inner_node() : node{false} {}
+
+                // children[i] holds the keys from separator i - 1 (inclusive) to separator i (exclusive)
+                typename std::aligned_storage<sizeof(kdmt_type), alignof(kdmt_type)>::type separators[Slots];
+                node* children[Slots + 1];
+
+                kdmt_type* sep(size_t i)
+                {
+                    return reinterpret_cast<kdmt_type*>(&separators[i]);
+                }
+
+                const kdmt_type* sep(size_t i) const
+                {
+                    return reinterpret_cast<const kdmt_type*>(&separators[i]);
+                }
+            };
+
+            template<bool Const>
+            class iterator_base
+            {
+
+                friend class btree;
+                template<bool> friend class iterator_base;
+
+            public:
+
+                using iterator_category = std::bidirectional_iterator_tag;
+                using value_type = typename Policy::value_type;
+                using difference_type = std::ptrdiff_t;
+                using reference = std::conditional_t<Const, const value_type&,
+                                  decltype(Policy::value(std::declval<slot_type&>()))>;
+                using pointer = std::add_pointer_t<reference>;
+
+                iterator_base() = default;
+
+                template<bool OtherConst, class = std::enable_if_t<Const && !OtherConst>>
+                iterator_base(const iterator_base<OtherConst>& other) :
+                    leaf{other.leaf}, pos{other.pos}, tree{other.tree}
+                {
+                }
+
+                reference operator*() const
+                {
+                    return Policy::value(*leaf->slot(pos));
+                }
+
+                pointer operator->() const
+                {
+                    return &**this;
+                }
+
+                iterator_base& operator++()
+                {
+                    if (++pos == leaf->count)
+                    {
+                        leaf = leaf->next;
+                        pos = 0;
+                    }
+                    return *this;
+                }
+
+                iterator_base operator++(int)
+                {
+                    iterator_base prev{*this};
+                    ++*this;
+                    return prev;
+                }
+
+                iterator_base& operator--()
+                {
+                    if (leaf == nullptr)
+                    {
+                        leaf = tree->last;
+                        pos = leaf->count;
+                    }
+                    else if (pos == 0)
+                    {
+                        leaf = leaf->prev;
+                        pos = leaf->count;
+                    }
+                    --pos;
+                    return *this;
+                }
+
+                iterator_base operator--(int)
+                {
+                    iterator_base prev{*this};
+                    --*this;
+                    return prev;
+                }
+
+                template<bool OtherConst>
+                bool operator==(const iterator_base<OtherConst>& other) const
+                {
+                    return leaf == other.leaf && pos == other.pos;
+                }
+
+                template<bool OtherConst>
+                bool operator!=(const iterator_base<OtherConst>& other) const
+                {
+                    return !(*this == other);
+                }
+
+            private:
+
+                iterator_base(leaf_node* l, size_t p, const btree* t) : leaf{l}, pos{p}, tree{t} {}
+
+                leaf_node* leaf = nullptr; // null at the end
+                size_t pos = 0;
+                const btree* tree = nullptr;
+
+            };
+
+        public:
+
+            using key_type = kdmt_type;
+            using value_type = typename Policy::value_type;
+            using size_type = size_t;
+            using difference_type = std::ptrdiff_t;
+            using key_compare = std::less<>;
+            using reference = value_type&;
+            using const_reference = const value_type&;
+            using iterator = iterator_base<false>;
+            using const_iterator = iterator_base<true>;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+            btree() = default;
+
+            template<class InputIt>
+            btree(InputIt first, InputIt last)
+            {
+                insert(first, last);
+            }
+
+            btree(std::initializer_list<value_type> values) : btree(values.begin(), values.end())
+            {
+            }
+
+            btree(const btree& other) : btree(other.begin(), other.end())
+            {
+            }
+
+            btree(btree&& other) noexcept
+            {
+                swap(other);
+            }
+
+            btree& operator=(const btree& other)
+            {
+                if (this != &other)
+                {
+                    btree copy{other};
+                    swap(copy);
+                }
+                return *this;
+            }
+
+            btree& operator=(btree&& other) noexcept
+            {
+                btree moved{std::move(other)};
+                swap(moved);
+                return *this;
+            }
+
+            ~btree()
+            {
+                clear();
+            }
+
+            iterator begin() { return {first, 0, this}; }
+            const_iterator begin() const { return {first, 0, this}; }
+            const_iterator cbegin() const { return begin(); }
+            iterator end() { return {nullptr, 0, this}; }
+            const_iterator end() const { return {nullptr, 0, this}; }
+            const_iterator cend() const { return end(); }
+            reverse_iterator rbegin() { return reverse_iterator{end()}; }
+            const_reverse_iterator rbegin() const { return const_reverse_iterator{end()}; }
+            const_reverse_iterator crbegin() const { return rbegin(); }
+            reverse_iterator rend() { return reverse_iterator{begin()}; }
+            const_reverse_iterator rend() const { return const_reverse_iterator{begin()}; }
+            const_reverse_iterator crend() const { return rend(); }
+
+            bool empty() const
+            {
+                return keys_num == 0;
+            }
+
+            size_type size() const
+            {
+                return keys_num;
+            }
+
+            key_compare key_comp() const
+            {
+                return {};
+            }
+
+            void clear()
+            {
+                if (root != nullptr)
+                    free_subtree(root);
+                root = nullptr;
+                first = last = nullptr;
+                keys_num = 0;
+            }
+
+            void swap(btree& other) noexcept
+            {
+                std::swap(root, other.root);
+                std::swap(first, other.first);
+                std::swap(last, other.last);
+                std::swap(keys_num, other.keys_num);
+            }
+
+            std::pair<iterator, bool> insert(const value_type& value)
+            {
+                return insert_unique(Policy::key(value), value);
+            }
+
+            std::pair<iterator, bool> insert(value_type&& value)
+            {
+                return insert_unique(Policy::key(value), std::move(value));
+            }
+
+            iterator insert(const_iterator hint, const value_type& value)
+            {
+                return emplace_hint(hint, value);
+            }
+
+            template<class InputIt>
+            void insert(InputIt first_value, InputIt last_value)
+            {
+                for (; first_value != last_value; ++first_value)
+                    emplace_hint(cend(), *first_value);
+            }
+
+            void insert(std::initializer_list<value_type> values)
+            {
+                insert(values.begin(), values.end());
+            }
+
+            template<class... Args>
+            std::pair<iterator, bool> emplace(Args&&... args)
+            {
+                init_type value(std::forward<Args>(args)...);
+                return insert_unique(Policy::key(value), std::move(value));
+            }
+
+            // a hint at the end appends keys greater than the last one without searching, e.g., when copying
+            template<class... Args>
+            iterator emplace_hint(const_iterator hint, Args&&... args)
+            {
+                init_type value(std::forward<Args>(args)...);
+                const kdmt_type& key = Policy::key(value);
+                if (hint == cend() && keys_num > 0 && last->key(last->count - 1).compare(key) < 0)
+                    return insert_at(last, last->count, key, std::move(value));
+                return insert_unique(key, std::move(value)).first;
+            }
+
+            iterator erase(const_iterator pos)
+            {
+                return erase_at(pos.leaf, pos.pos);
+            }
+
+            iterator erase(iterator pos)
+            {
+                return erase_at(pos.leaf, pos.pos);
+            }
+
+            iterator erase(const_iterator first_value, const_iterator last_value)
+            {
+                // erasing may free the leaf last_value points to, so the keys are counted beforehand
+                size_t num = static_cast<size_t>(std::distance(first_value, last_value));
+                iterator iter{first_value.leaf, first_value.pos, this};
+                for (; num > 0; --num)
+                    iter = erase(iter);
+                return iter;
+            }
+
+            size_type erase(const key_type& key)
+            {
+                const iterator iter = find(key);
+                if (iter == end())
+                    return 0;
+                erase(iter);
+                return 1;
+            }
+
+            template<class KeyT>
+            iterator find(const KeyT& key)
+            {
+                const position p = search(key);
+                return p.equal ? iterator{p.leaf, p.pos, this} : end();
+            }
+
+            template<class KeyT>
+            const_iterator find(const KeyT& key) const
+            {
+                return const_cast<btree*>(this)->find(key);
+            }
+
+            template<class KeyT>
+            size_type count(const KeyT& key) const
+            {
+                return search(key).equal ? 1 : 0;
+            }
+
+            template<class KeyT>
+            bool contains(const KeyT& key) const
+            {
+                return search(key).equal;
+            }
+
+            template<class KeyT>
+            iterator lower_bound(const KeyT& key)
+            {
+                const position p = search(key);
+                return iterator_at(p.leaf, p.pos);
+            }
+
+            template<class KeyT>
+            const_iterator lower_bound(const KeyT& key) const
+            {
+                return const_cast<btree*>(this)->lower_bound(key);
+            }
+
+            template<class KeyT>
+            iterator upper_bound(const KeyT& key)
+            {
+                const position p = search(key);
+                return iterator_at(p.leaf, p.equal ? p.pos + 1 : p.pos);
+            }
+
+            template<class KeyT>
+            const_iterator upper_bound(const KeyT& key) const
+            {
+                return const_cast<btree*>(this)->upper_bound(key);
+            }
+
+            template<class KeyT>
+            std::pair<iterator, iterator> equal_range(const KeyT& key)
+            {
+                const position p = search(key);
+                return {iterator_at(p.leaf, p.pos), iterator_at(p.leaf, p.equal ? p.pos + 1 : p.pos)};
+            }
+
+            template<class KeyT>
+            std::pair<const_iterator, const_iterator> equal_range(const KeyT& key) const
+            {
+                return const_cast<btree*>(this)->equal_range(key);
+            }
+
+            friend bool operator==(const btree& b1, const btree& b2)
+            {
+                return b1.size() == b2.size() && std::equal(b1.begin(), b1.end(), b2.begin());
+            }
+
+            friend bool operator!=(const btree& b1, const btree& b2)
+            {
+                return !(b1 == b2);
+            }
+
+        protected:
+
+            // the leaf and position a key is found at, or should be inserted at
+            struct position
+            {
+                leaf_node* leaf;
+                size_t pos;
+                bool equal;
+            };
+
+            template<class KeyT>
+            position search(const KeyT& key) const
+            {
+                static_assert(KeyT::size == kdmt_type::size &&
+                              std::is_same<typename KeyT::encoding, typename kdmt_type::encoding>::value,
+                              "B+-trees are searched using keys of their own prefix size and encoding");
+                if (root == nullptr)
+                    return {nullptr, 0, false};
+                const prefix_type prefix = key.getPrefix().get_val();
+                const node* n = root;
+                while (!n->leaf)
+                {
+                    const inner_node* inner = static_cast<const inner_node*>(n);
+                    n = inner->children[child_of(inner, key, prefix)];
+                }
+                leaf_node* leaf = const_cast<leaf_node*>(static_cast<const leaf_node*>(n));
+                size_t pos = count_smaller(leaf->prefixes, leaf->count, prefix);
+                int cmp = 1;
+                if (pos == leaf->count || !(leaf->prefixes[pos] == prefix))
+                    stats::count_prefix();
+                for (; pos < leaf->count && leaf->prefixes[pos] == prefix; ++pos)
+                {
+                    cmp = leaf->key(pos).compare(key);
+                    if (cmp >= 0)
+                        break;
+                }
+                return {leaf, pos, cmp == 0};
+            }
+
+            iterator iterator_at(leaf_node* leaf, size_t pos)
+            {
+                if (leaf != nullptr && pos == leaf->count)
+                    return {leaf->next, 0, this};
+                return {leaf, pos, this};
+            }
+
+            template<class... Args>
+            std::pair<iterator, bool> insert_unique(const kdmt_type& key, Args&&... args)
+            {
+                if (root == nullptr)
+                    root = first = last = new leaf_node;
+                const position p = search(key);
+                if (p.equal)
+                    return {{p.leaf, p.pos, this}, false};
+                return {insert_at(p.leaf, p.pos, key, std::forward<Args>(args)...), true};
+            }
+
+            // inserts the value of the given key, which isn't held, at the given position
+            template<class... Args>
+            iterator insert_at(leaf_node* leaf, size_t pos, const kdmt_type& key, Args&&... args)
+            {
+                if (leaf->count < Slots)
+                {
+                    insert_into_leaf(leaf, pos, std::forward<Args>(args)...);
+                    return {leaf, pos, this};
+                }
+                // keys appended in order fill the leaves, other keys split them evenly
+                const size_t keep = (leaf == last && pos == Slots) ? Slots : Slots / 2;
+                // the first key of the right leaf is copied into the parent; the copy, which may throw, is made
+                // before any key moves
+                kdmt_type sep{pos == keep ? key : leaf->key(keep)};
+                leaf_node* right = new leaf_node;
+                for (size_t i = keep; i < Slots; ++i)
+                    move_slot(right, i - keep, leaf, i);
+                right->count = static_cast<uint32_t>(Slots - keep);
+                leaf->count = static_cast<uint32_t>(keep);
+                right->prev = leaf;
+                right->next = leaf->next;
+                (leaf->next != nullptr ? leaf->next->prev : last) = right;
+                leaf->next = right;
+                leaf_node* target = leaf;
+                if (pos >= keep)
+                {
+                    target = right;
+                    pos -= keep;
+                }
+                insert_into_leaf(target, pos, std::forward<Args>(args)...);
+                insert_into_parent(leaf, std::move(sep), right);
+                return {target, pos, this};
+            }
+
+        private:
+
+            node* root = nullptr;
+            leaf_node* first = nullptr;
+            leaf_node* last = nullptr;
+            size_t keys_num = 0;
+
+            static prefix_type prefix_of(const kdmt_type& key)
+            {
+                return key.getPrefix().get_val();
+            }
+
+            // branchless, so the compiler can vectorize the scan
+            static size_t count_smaller(const prefix_type* prefixes, size_t count, const prefix_type& prefix)
+            {
+                size_t smaller = 0;
+                for (size_t i = 0; i < count; ++i)
+                    smaller += prefixes[i] < prefix ? 1 : 0;
+                return smaller;
+            }
+
+            // the child holding the keys not smaller than the given key
+            template<class KeyT>
+            static size_t child_of(const inner_node* inner, const KeyT& key, const prefix_type& prefix)
+            {
+                size_t child = count_smaller(inner->prefixes, inner->count, prefix);
+                if (child == inner->count || !(inner->prefixes[child] == prefix))
+                    stats::count_prefix();
+                while (child < inner->count && inner->prefixes[child] == prefix && inner->sep(child)->compare(key) <= 0)
+                    ++child;
+                return child;
+            }
+
+            static size_t child_index(const inner_node* parent, const node* child)
+            {
+                return static_cast<size_t>(std::find(parent->children, parent->children + parent->count + 1, child) -
+                                           parent->children);
+            }
+
+            static void move_slot(leaf_node* dst, size_t dst_pos, leaf_node* src, size_t src_pos)
+            {
+                Policy::transfer(dst->slot(dst_pos), src->slot(src_pos));
+                dst->prefixes[dst_pos] = src->prefixes[src_pos];
+            }
+
+            static void move_separator(inner_node* dst, size_t dst_pos, inner_node* src, size_t src_pos)
+            {
+                new (dst->sep(dst_pos)) kdmt_type(std::move(*src->sep(src_pos)));
+                src->sep(src_pos)->~kdmt_type();
+                dst->prefixes[dst_pos] = src->prefixes[src_pos];
+            }
+
+            template<class... Args>
+            void insert_into_leaf(leaf_node* leaf, size_t pos, Args&&... args)
+            {
+                for (size_t i = leaf->count; i > pos; --i)
+                    move_slot(leaf, i, leaf, i - 1);
+                Policy::construct(leaf->slot(pos), std::forward<Args>(args)...);
+                leaf->prefixes[pos] = prefix_of(leaf->key(pos));
+                ++leaf->count;
+                ++keys_num;
+            }
+
+            // places right next to left, separated by the given key
+            void insert_into_parent(node* left, kdmt_type&& sep, node* right)
+            {
+                inner_node* parent = left->parent;
+                if (parent == nullptr)
+                {
+                    inner_node* new_root = new inner_node;
+                    new_root->children[0] = left;
+                    left->parent = new_root;
+                    insert_separator(new_root, 0, std::move(sep), right);
+                    root = new_root;
+                    return;
+                }
+                const size_t pos = child_index(parent, left);
+                if (parent->count < Slots)
+                {
+                    insert_separator(parent, pos, std::move(sep), right);
+                    return;
+                }
+                // the middle separator moves up, and the ones following it move to a new sibling
+                constexpr size_t mid = Slots / 2;
+                inner_node* sibling = new inner_node;
+                for (size_t i = mid + 1; i < Slots; ++i)
+                    move_separator(sibling, i - mid - 1, parent, i);
+                for (size_t i = mid + 1; i <= Slots; ++i)
+                {
+                    sibling->children[i - mid - 1] = parent->children[i];
+                    parent->children[i]->parent = sibling;
+                }
+                sibling->count = static_cast<uint32_t>(Slots - mid - 1);
+                kdmt_type up{std::move(*parent->sep(mid))};
+                parent->sep(mid)->~kdmt_type();
+                parent->count = static_cast<uint32_t>(mid);
+                if (pos <= mid)
+                    insert_separator(parent, pos, std::move(sep), right);
+                else
+                    insert_separator(sibling, pos - mid - 1, std::move(sep), right);
+                insert_into_parent(parent, std::move(up), sibling);
+            }
+
+            // places the child following children[pos], separated from it by the given key, which is moved rather
+            // than copied, so the separators shifted for it are never left with a gap
+            static void insert_separator(inner_node* inner, size_t pos, kdmt_type&& sep, node* child)
+            {
+                for (size_t i = inner->count; i > pos; --i)
+                {
+                    move_separator(inner, i, inner, i - 1);
+                    inner->children[i + 1] = inner->children[i];
+                }
+                inner->prefixes[pos] = prefix_of(sep);
+                new (inner->sep(pos)) kdmt_type(std::move(sep));
+                inner->children[pos + 1] = child;
+                child->parent = inner;
+                ++inner->count;
+            }
+
+            iterator erase_at(leaf_node* leaf, size_t pos)
+            {
+                Policy::destroy(leaf->slot(pos));
+                for (size_t i = pos + 1; i < leaf->count; ++i)
+                    move_slot(leaf, i - 1, leaf, i);
+                --leaf->count;
+                if (--keys_num == 0)
+                {
+                    clear();
+                    return end();
+                }
+                if (pos < leaf->count)
+                    return {leaf, pos, this};
+                leaf_node* next = leaf->next;
+                if (leaf->count == 0)
+                {
+                    (leaf->prev != nullptr ? leaf->prev->next : first) = leaf->next;
+                    (leaf->next != nullptr ? leaf->next->prev : last) = leaf->prev;
+                    remove_node(leaf);
+                }
+                return {next, 0, this};
+            }
+
+            // removes an emptied node, along with the ancestors left without children
+            void remove_node(node* n)
+            {
+                inner_node* parent = n->parent;
+                const size_t pos = child_index(parent, n);
+                if (n->leaf)
+                    delete static_cast<leaf_node*>(n);
+                else
+                    delete static_cast<inner_node*>(n);
+                if (parent->count == 0)
+                {
+                    remove_node(parent);
+                    return;
+                }
+                // the separator bounding the removed child goes with it
+                const size_t sep = pos > 0 ? pos - 1 : 0;
+                parent->sep(sep)->~kdmt_type();
+                for (size_t i = sep + 1; i < parent->count; ++i)
+                    move_separator(parent, i - 1, parent, i);
+                for (size_t i = pos + 1; i <= parent->count; ++i)
+                    parent->children[i - 1] = parent->children[i];
+                --parent->count;
+                // a root left with a single child is replaced by it
+                if (parent == root && parent->count == 0)
+                {
+                    root = parent->children[0];
+                    root->parent = nullptr;
+                    delete parent;
+                }
+            }
+
+            static void free_subtree(node* n)
+            {
+                if (n->leaf)
+                {
+                    leaf_node* leaf = static_cast<leaf_node*>(n);
+                    for (size_t i = 0; i < leaf->count; ++i)
+                        Policy::destroy(leaf->slot(i));
+                    delete leaf;
+                    return;
+                }
+                inner_node* inner = static_cast<inner_node*>(n);
+                for (size_t i = 0; i < inner->count; ++i)
+                {
+                    inner->sep(i)->~kdmt_type();
+                    free_subtree(inner->children[i]);
+                }
+                free_subtree(inner->children[inner->count]);
+                delete inner;
+            }
+
+        };
+    }
+
+    //
+    // An ordered set of keydomets, e.g., btree_set<keydomet<std::string, prefix_size::SIZE_32BIT>>, with the API of
+    // a std::set using a transparent comparator. Its nodes hold up to Slots::value keys each, and keep their
+    // prefixes in arrays of their own, so a lookup reads a few cache lines of prefixes per level, rather than a
+    // node and a string per key compared. The strings are only read when the prefixes are equal.
+    // Lookups take any keydomet of the same prefix size and encoding, e.g., one made by make_find_key(). As with
+    // other arrays, inserting and erasing keys invalidates iterators to keys of the same node.
+    //
+    template<class KeydometT, class Slots = btree_slots<32>>
+    class btree_set : public imp::btree<imp::btree_set_policy<KeydometT>, Slots::value>
+    {
+
+        using base = imp::btree<imp::btree_set_policy<KeydometT>, Slots::value>;
+
+    public:
+
+        using base::base;
+
+        btree_set() = default;
+
+        btree_set(std::initializer_list<KeydometT> values) : base(values)
+        {
+        }
+
+    };
+
+    //
+    // An ordered map from keydomets, e.g., btree_map<keydomet<std::string, prefix_size::SIZE_32BIT>, int>, with the
+    // API of a std::map using a transparent comparator. See btree_set.
+    //
+    template<class KeydometT, class T, class Slots = btree_slots<32>>
+    class btree_map : public imp::btree<imp::btree_map_policy<KeydometT, T>, Slots::value>
+    {
+
+        using base = imp::btree<imp::btree_map_policy<KeydometT, T>, Slots::value>;
+
+    public:
+
+        using mapped_type = T;
+        using typename base::key_type;
+        using typename base::value_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+
+        using base::base;
+        using base::insert;
+
+        btree_map() = default;
+
+        btree_map(std::initializer_list<value_type> values) : base(values)
+        {
+        }
+
+        template<class P, class = std::enable_if_t<std::is_constructible<value_type, P&&>::value>>
+        std::pair<iterator, bool> insert(P&& value)
+        {
+            return this->emplace(std::forward<P>(value));
+        }
+
+        template<class... Args>
+        std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args)
+        {
+            return emplace_key(key, std::forward<Args>(args)...);
+        }
+
+        template<class... Args>
+        std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args)
+        {
+            return emplace_key(std::move(key), std::forward<Args>(args)...);
+        }
+
+        T& operator[](const key_type& key)
+        {
+            return try_emplace(key).first->second;
+        }
+
+        T& operator[](key_type&& key)
+        {
+            return try_emplace(std::move(key)).first->second;
+        }
+
+        template<class KeyT>
+        T& at(const KeyT& key)
+        {
+            const iterator iter = this->find(key);
+            if (iter == this->end())
+                throw std::out_of_range("btree_map::at");
+            return iter->second;
+        }
+
+        template<class KeyT>
+        const T& at(const KeyT& key) const
+        {
+            return const_cast<btree_map*>(this)->at(key);
+        }
+
+    private:
+
+        template<class K, class... Args>
+        std::pair<iterator, bool> emplace_key(K&& key, Args&&... args)
+        {
+            if (this->empty())
+                return this->emplace(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                                     std::forward_as_tuple(std::forward<Args>(args)...));
+            const typename base::position p = this->search(key);
+            if (p.equal)
+                return {this->iterator_at(p.leaf, p.pos), false};
+            return {this->insert_at(p.leaf, p.pos, key, std::piecewise_construct,
+                                    std::forward_as_tuple(std::forward<K>(key)),
+                                    std::forward_as_tuple(std::forward<Args>(args)...)), true};
+        }
+
+    };
+
+}
+
+#endif //KEYDOMET_BTREE_H
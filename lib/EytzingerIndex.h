@@ -0,0 +1,207 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef KEYDOMET_EYTZINGERINDEX_H
+#define KEYDOMET_EYTZINGERINDEX_H
+
+#include "Keydomet.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+namespace kdmt
+{
+
+    //
+    // A static index of a sorted range of keydomets, e.g., a std::vector<keydomet<std::string, ...>> snapshot, whose
+    // prefixes are laid out in BFS (Eytzinger) order: the root first, followed by its two children, their four
+    // children and so on. A lookup descends the layout without branching on the comparisons, and as each node's
+    // 16 descendants 4 levels down are adjacent, filling a cache line with 4 byte prefixes, they're prefetched
+    // while the 4 levels are searched. Prefix ties are resolved using the keys of the original range.
+    // The index refers to the range, which must outlive it and not change, and yields positions within it. The
+    // range may hold up to 4G keys.
+    //
+    template<class RandomIt>
+    class eytzinger_index
+    {
+
+        using keydomet_type = std::decay_t<decltype(*std::declval<RandomIt>())>;
+        using prefix_type = typename prefix_rep<keydomet_type::size>::prefix_type;
+        using stats = typename keydomet_type::stats;
+
+        static constexpr size_t cache_line = 64;
+        // the descendants 4 levels down of node k are nodes 16k to 16k + 15
+        static constexpr size_t prefetch_levels = 4;
+        static constexpr size_t prefetch_len = sizeof(prefix_type) << prefetch_levels;
+
+    public:
+
+        eytzinger_index(RandomIt first, RandomIt last) :
+            keys{first}, keys_num{static_cast<size_t>(std::distance(first, last))}
+        {
+            if (keys_num > UINT32_MAX)
+                throw std::length_error("Eytzinger indexes hold up to 4G keys");
+            // node k is at layout()[k], so the nodes prefetched together start at a cache line
+            storage.resize(keys_num + 1 + cache_line / sizeof(prefix_type));
+            const size_t misalignment = reinterpret_cast<uintptr_t>(storage.data()) % cache_line;
+            layout_offset = misalignment == 0 ? 0 : (cache_line - misalignment) / sizeof(prefix_type);
+            ranks.resize(keys_num + 1);
+            size_t rank = 0;
+            build(1, rank);
+        }
+
+        // copies are built again, aligning their own layout
+        eytzinger_index(const eytzinger_index& other) : eytzinger_index(other.keys, other.keys + other.keys_num)
+        {
+        }
+
+        eytzinger_index(eytzinger_index&&) = default;
+
+        eytzinger_index& operator=(const eytzinger_index& other)
+        {
+            return *this = eytzinger_index{other};
+        }
+
+        eytzinger_index& operator=(eytzinger_index&&) = default;
+
+        size_t size() const
+        {
+            return keys_num;
+        }
+
+        // the position of the first key not smaller than the given one, or size() if there's none. The key may be
+        // any keydomet of the same prefix size and encoding, e.g., a keydomet<const std::string&, ...>
+        template<class KeyT>
+        size_t lower_bound(const KeyT& key) const
+        {
+            return search(key).pos;
+        }
+
+        // the position of a key equal to the given one, or size() if there's none
+        template<class KeyT>
+        size_t find(const KeyT& key) const
+        {
+            const position p = search(key);
+            return p.equal ? p.pos : keys_num;
+        }
+
+        template<class KeyT>
+        bool contains(const KeyT& key) const
+        {
+            return search(key).equal;
+        }
+
+    private:
+
+        RandomIt keys;
+        size_t keys_num;
+        std::vector<prefix_type> storage;
+        size_t layout_offset;
+        std::vector<uint32_t> ranks; // the position of each node's key within the range
+
+        struct position
+        {
+            size_t pos;
+            bool equal;
+        };
+
+        prefix_type* layout()
+        {
+            return storage.data() + layout_offset;
+        }
+
+        const prefix_type* layout() const
+        {
+            return storage.data() + layout_offset;
+        }
+
+        // an in-order traversal of the layout visits the keys in their sorted order
+        void build(size_t node, size_t& rank)
+        {
+            if (node > keys_num)
+                return;
+            build(2 * node, rank);
+            layout()[node] = keys[rank].getPrefix().get_val();
+            ranks[node] = static_cast<uint32_t>(rank++);
+            build(2 * node + 1, rank);
+        }
+
+        template<class KeyT>
+        position search(const KeyT& key) const
+        {
+            static_assert(KeyT::size == keydomet_type::size &&
+                          std::is_same<typename KeyT::encoding, typename keydomet_type::encoding>::value,
+                          "Eytzinger indexes are searched using keys of their own prefix size and encoding");
+            const prefix_type prefix = key.getPrefix().get_val();
+            const prefix_type* nodes = layout();
+            size_t node = 1;
+            while (node <= keys_num)
+            {
+                prefetch(nodes + (node << prefetch_levels));
+                node = 2 * node + (nodes[node] < prefix ? 1 : 0);
+            }
+            // the path went right below the lower bound, and left ever since, leaving trailing ones
+            node >>= trailing_ones(node) + 1;
+            if (node == 0)
+            {
+                stats::count_prefix();
+                return {keys_num, false};
+            }
+            const size_t pos = ranks[node];
+            if (!(nodes[node] == prefix))
+            {
+                stats::count_prefix();
+                return {pos, false};
+            }
+            // the prefixes are tied, the keys following the lower bound are searched in the range
+            const imp::tie_bound tie = imp::lower_tied(keys + pos, keys + keys_num, key);
+            return {pos + tie.pos, tie.equal};
+        }
+
+        static void prefetch(const prefix_type* first_node)
+        {
+#if defined(__GNUC__)
+            const char* line = reinterpret_cast<const char*>(first_node);
+            for (size_t offset = 0; offset < prefetch_len; offset += cache_line)
+                __builtin_prefetch(line + offset);
+#else
+            (void)first_node;
+#endif
+        }
+
+        static size_t trailing_ones(size_t n)
+        {
+#if defined(__GNUC__)
+            return static_cast<size_t>(__builtin_ctzll(~static_cast<unsigned long long>(n)));
+#else
+            size_t ones = 0;
+            for (; n & 1; n >>= 1)
+                ++ones;
+            return ones;
+#endif
+        }
+
+    };
+
+    template<class RandomIt>
+    eytzinger_index<RandomIt> make_eytzinger_index(RandomIt first, RandomIt last)
+    {
+        return {first, last};
+    }
+
+    // indexes a sorted container, e.g., a std::vector of keydomets, yielding positions within it
+    template<class Container>
+    auto make_eytzinger_index(const Container& keys)
+    {
+        return make_eytzinger_index(std::begin(keys), std::end(keys));
+    }
+
+}
+
+#endif //KEYDOMET_EYTZINGERINDEX_H
@@ -0,0 +1,882 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef KEYDOMET_FLATSET_H
+#define KEYDOMET_FLATSET_H
+
+#include "Keydomet.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+#include <initializer_list>
+
+namespace kdmt
+{
+
+    // tells flat_set and flat_map constructors the given keys are sorted and unique, so they aren't sorted again
+    struct sorted_unique_t
+    {
+        explicit sorted_unique_t() = default;
+    };
+
+    constexpr sorted_unique_t sorted_unique{};
+
+    namespace imp
+    {
+        template<class Elem, class KeyOf>
+        void sort_unique(std::vector<Elem>& elems, KeyOf key_of)
+        {
+            // stable, so the first of equal keys is kept, as done by inserting the keys one by one
+            std::stable_sort(elems.begin(), elems.end(), [&key_of](const Elem& e1, const Elem& e2) {
+                return key_of(e1).compare(key_of(e2)) < 0;
+            });
+            elems.erase(std::unique(elems.begin(), elems.end(), [&key_of](const Elem& e1, const Elem& e2) {
+                return key_of(e1).compare(key_of(e2)) == 0;
+            }), elems.end());
+        }
+
+        //
+        // The sorted keys of a flat_set or flat_map, along with an array of their prefixes. Lookups search the
+        // prefixes only, using a branchless binary search whose last steps are a linear scan, and read the keys
+        // (and their strings) only when the prefixes are equal.
+        //
+        template<class KeydometT>
+        class sorted_keys
+        {
+
+        protected:
+
+            using prefix_type = typename prefix_rep<KeydometT::size>::prefix_type;
+            using stats = typename KeydometT::stats;
+
+            // the prefixes left by the binary search are scanned, as a few adjacent prefixes are read at once
+            static constexpr size_t scan_len = 64 / sizeof(prefix_type);
+
+            std::vector<prefix_type> prefixes;
+            std::vector<KeydometT> keys;
+
+            struct position
+            {
+                size_t pos;
+                bool equal;
+            };
+
+            template<class KeyT>
+            position search(const KeyT& key) const
+            {
+                static_assert(KeyT::size == KeydometT::size &&
+                              std::is_same<typename KeyT::encoding, typename KeydometT::encoding>::value,
+                              "Flat sets are searched using keys of their own prefix size and encoding");
+                const prefix_type prefix = key.getPrefix().get_val();
+                const size_t pos = lower_prefix(prefix);
+                if (pos == prefixes.size() || !(prefixes[pos] == prefix))
+                {
+                    stats::count_prefix();
+                    return {pos, false};
+                }
+                const imp::tie_bound tie = imp::lower_tied(keys.begin() + pos, keys.end(), key);
+                return {pos + tie.pos, tie.equal};
+            }
+
+            // the first prefix not smaller than the given one
+            size_t lower_prefix(const prefix_type& prefix) const
+            {
+                const prefix_type* base = prefixes.data();
+                size_t len = prefixes.size();
+                // the position looked for is within [base, base + len]
+                while (len > scan_len)
+                {
+                    const size_t half = len / 2;
+#if defined(__GNUC__)
+                    __builtin_prefetch(base + half / 2);
+                    __builtin_prefetch(base + half + half / 2);
+#endif
+                    base = base[half] < prefix ? base + half : base;
+                    len -= half;
+                }
+                size_t smaller = 0;
+                for (size_t i = 0; i < len; ++i)
+                    smaller += base[i] < prefix ? 1 : 0;
+                return static_cast<size_t>(base - prefixes.data()) + smaller;
+            }
+
+            // the arrays are kept in step when an insertion throws, by undoing the ones done before it
+            void insert_key(size_t pos, KeydometT&& key)
+            {
+                prefixes.insert(prefixes.begin() + pos, key.getPrefix().get_val());
+                try
+                {
+                    keys.insert(keys.begin() + pos, std::move(key));
+                }
+                catch (...)
+                {
+                    prefixes.erase(prefixes.begin() + pos);
+                    throw;
+                }
+            }
+
+            void erase_keys(size_t first, size_t last)
+            {
+                prefixes.erase(prefixes.begin() + first, prefixes.begin() + last);
+                keys.erase(keys.begin() + first, keys.begin() + last);
+            }
+
+            void build_prefixes()
+            {
+                std::vector<prefix_type> built = prefixes_of(keys);
+                prefixes.swap(built);
+            }
+
+            // takes the given sorted keys, whose prefixes are built before any of the arrays is changed
+            void replace_keys(std::vector<KeydometT>& sorted)
+            {
+                std::vector<prefix_type> built = prefixes_of(sorted);
+                keys.swap(sorted);
+                prefixes.swap(built);
+            }
+
+            static std::vector<prefix_type> prefixes_of(const std::vector<KeydometT>& sorted)
+            {
+                std::vector<prefix_type> built;
+                built.reserve(sorted.size());
+                for (const KeydometT& key : sorted)
+                    built.push_back(key.getPrefix().get_val());
+                return built;
+            }
+
+        };
+    }
+
+    //
+    // A sorted vector of keydomets, e.g., flat_set<keydomet<std::string, prefix_size::SIZE_32BIT>>, with the API of
+    // a std::set using a transparent comparator. The prefixes are kept in an array of their own, so a lookup reads
+    // a cache line of prefixes per step of the binary search, rather than a key and possibly a string.
+    // Lookups take any keydomet of the same prefix size and encoding, e.g., one made by make_find_key().
+    // Inserting or erasing a single key moves the keys following it; batches of keys should be inserted using the
+    // range insert(), which sorts them and merges them with the keys already held. Inserting and erasing
+    // invalidates the iterators.
+    //
+    template<class KeydometT>
+    class flat_set : private imp::sorted_keys<KeydometT>
+    {
+
+        using base = imp::sorted_keys<KeydometT>;
+        using base::keys;
+        using base::prefixes;
+
+    public:
+
+        using key_type = KeydometT;
+        using value_type = KeydometT;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using key_compare = std::less<>;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using iterator = typename std::vector<KeydometT>::const_iterator;
+        using const_iterator = iterator;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = reverse_iterator;
+
+        flat_set() = default;
+
+        // the keys need not be sorted
+        template<class InputIt>
+        flat_set(InputIt first, InputIt last)
+        {
+            keys.assign(first, last);
+            imp::sort_unique(keys, [](const KeydometT& key) -> const KeydometT& { return key; });
+            this->build_prefixes();
+        }
+
+        template<class InputIt>
+        flat_set(sorted_unique_t, InputIt first, InputIt last)
+        {
+            keys.assign(first, last);
+            this->build_prefixes();
+        }
+
+        flat_set(std::initializer_list<value_type> values) : flat_set(values.begin(), values.end())
+        {
+        }
+
+        iterator begin() const { return keys.begin(); }
+        iterator cbegin() const { return keys.begin(); }
+        iterator end() const { return keys.end(); }
+        iterator cend() const { return keys.end(); }
+        reverse_iterator rbegin() const { return keys.rbegin(); }
+        reverse_iterator crbegin() const { return keys.rbegin(); }
+        reverse_iterator rend() const { return keys.rend(); }
+        reverse_iterator crend() const { return keys.rend(); }
+
+        bool empty() const
+        {
+            return keys.empty();
+        }
+
+        size_type size() const
+        {
+            return keys.size();
+        }
+
+        key_compare key_comp() const
+        {
+            return {};
+        }
+
+        void reserve(size_type num)
+        {
+            prefixes.reserve(num);
+            keys.reserve(num);
+        }
+
+        void clear()
+        {
+            prefixes.clear();
+            keys.clear();
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value)
+        {
+            return emplace(value);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value)
+        {
+            return emplace(std::move(value));
+        }
+
+        iterator insert(const_iterator, const value_type& value)
+        {
+            return emplace(value).first;
+        }
+
+        // sorts the given keys, and merges them with the ones held
+        template<class InputIt>
+        void insert(InputIt first, InputIt last)
+        {
+            std::vector<KeydometT> added(first, last);
+            imp::sort_unique(added, [](const KeydometT& key) -> const KeydometT& { return key; });
+            std::vector<KeydometT> merged;
+            merged.reserve(keys.size() + added.size());
+            auto held = keys.begin();
+            auto add = added.begin();
+            while (held != keys.end() && add != added.end())
+            {
+                const int cmp = held->compare(*add);
+                if (cmp <= 0)
+                {
+                    merged.push_back(std::move(*held++));
+                    // keys already held are kept
+                    if (cmp == 0)
+                        ++add;
+                }
+                else
+                {
+                    merged.push_back(std::move(*add++));
+                }
+            }
+            std::move(held, keys.end(), std::back_inserter(merged));
+            std::move(add, added.end(), std::back_inserter(merged));
+            this->replace_keys(merged);
+        }
+
+        void insert(std::initializer_list<value_type> values)
+        {
+            insert(values.begin(), values.end());
+        }
+
+        template<class... Args>
+        std::pair<iterator, bool> emplace(Args&&... args)
+        {
+            KeydometT key(std::forward<Args>(args)...);
+            const typename base::position p = this->search(key);
+            if (!p.equal)
+                this->insert_key(p.pos, std::move(key));
+            return {keys.begin() + p.pos, !p.equal};
+        }
+
+        template<class... Args>
+        iterator emplace_hint(const_iterator, Args&&... args)
+        {
+            return emplace(std::forward<Args>(args)...).first;
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            return erase(pos, pos + 1);
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            const size_t first_pos = static_cast<size_t>(first - keys.begin());
+            this->erase_keys(first_pos, static_cast<size_t>(last - keys.begin()));
+            return keys.begin() + first_pos;
+        }
+
+        size_type erase(const key_type& key)
+        {
+            const typename base::position p = this->search(key);
+            if (!p.equal)
+                return 0;
+            this->erase_keys(p.pos, p.pos + 1);
+            return 1;
+        }
+
+        template<class KeyT>
+        iterator find(const KeyT& key) const
+        {
+            const typename base::position p = this->search(key);
+            return p.equal ? keys.begin() + p.pos : keys.end();
+        }
+
+        template<class KeyT>
+        size_type count(const KeyT& key) const
+        {
+            return this->search(key).equal ? 1 : 0;
+        }
+
+        template<class KeyT>
+        bool contains(const KeyT& key) const
+        {
+            return this->search(key).equal;
+        }
+
+        template<class KeyT>
+        iterator lower_bound(const KeyT& key) const
+        {
+            return keys.begin() + this->search(key).pos;
+        }
+
+        template<class KeyT>
+        iterator upper_bound(const KeyT& key) const
+        {
+            const typename base::position p = this->search(key);
+            return keys.begin() + p.pos + (p.equal ? 1 : 0);
+        }
+
+        template<class KeyT>
+        std::pair<iterator, iterator> equal_range(const KeyT& key) const
+        {
+            const typename base::position p = this->search(key);
+            return {keys.begin() + p.pos, keys.begin() + p.pos + (p.equal ? 1 : 0)};
+        }
+
+        friend bool operator==(const flat_set& s1, const flat_set& s2)
+        {
+            return s1.keys == s2.keys;
+        }
+
+        friend bool operator!=(const flat_set& s1, const flat_set& s2)
+        {
+            return !(s1 == s2);
+        }
+
+    };
+
+    namespace imp
+    {
+        // std::vector<bool> packs its values into bits, which can't be referenced, so flat_map holds bools boxed
+        template<class T>
+        struct boxed
+        {
+            boxed() : val{} {}
+            boxed(T v) : val{v} {}
+
+            friend bool operator==(const boxed& b1, const boxed& b2) { return b1.val == b2.val; }
+            friend bool operator!=(const boxed& b1, const boxed& b2) { return b1.val != b2.val; }
+
+            T val;
+        };
+
+        template<class T>
+        using flat_stored_t = std::conditional_t<std::is_same<T, bool>::value, boxed<T>, T>;
+
+        template<class T>
+        T& unbox(T& val)
+        {
+            return val;
+        }
+
+        template<class T>
+        const T& unbox(const T& val)
+        {
+            return val;
+        }
+
+        template<class T>
+        T& unbox(boxed<T>& box)
+        {
+            return box.val;
+        }
+
+        template<class T>
+        const T& unbox(const boxed<T>& box)
+        {
+            return box.val;
+        }
+
+        // flat_map iterators reference a key and its value, held by different arrays
+        template<class KeydometT, class T, bool Const>
+        class flat_map_iterator
+        {
+
+            using value_ptr = std::conditional_t<Const, const flat_stored_t<T>*, flat_stored_t<T>*>;
+
+            template<class, class, bool> friend class flat_map_iterator;
+
+        public:
+
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = std::pair<KeydometT, T>;
+            using difference_type = std::ptrdiff_t;
+            using reference = std::pair<const KeydometT&, std::conditional_t<Const, const T&, T&>>;
+
+            struct pointer
+            {
+                reference ref;
+
+                const reference* operator->() const
+                {
+                    return &ref;
+                }
+            };
+
+            flat_map_iterator() = default;
+
+            flat_map_iterator(const KeydometT* k, value_ptr v) : key{k}, value{v}
+            {
+            }
+
+            template<bool OtherConst, class = std::enable_if_t<Const && !OtherConst>>
+            flat_map_iterator(const flat_map_iterator<KeydometT, T, OtherConst>& other) :
+                key{other.key}, value{other.value}
+            {
+            }
+
+            reference operator*() const { return {*key, unbox(*value)}; }
+            pointer operator->() const { return {**this}; }
+            reference operator[](difference_type n) const { return *(*this + n); }
+
+            flat_map_iterator& operator++() { ++key; ++value; return *this; }
+            flat_map_iterator& operator--() { --key; --value; return *this; }
+            flat_map_iterator operator++(int) { flat_map_iterator prev{*this}; ++*this; return prev; }
+            flat_map_iterator operator--(int) { flat_map_iterator prev{*this}; --*this; return prev; }
+            flat_map_iterator& operator+=(difference_type n) { key += n; value += n; return *this; }
+            flat_map_iterator& operator-=(difference_type n) { key -= n; value -= n; return *this; }
+            flat_map_iterator operator+(difference_type n) const { return {key + n, value + n}; }
+            flat_map_iterator operator-(difference_type n) const { return {key - n, value - n}; }
+            friend flat_map_iterator operator+(difference_type n, const flat_map_iterator& i) { return i + n; }
+
+            template<bool OtherConst>
+            difference_type operator-(const flat_map_iterator<KeydometT, T, OtherConst>& other) const
+            {
+                return key - other.key;
+            }
+
+            template<bool OtherConst>
+            bool operator==(const flat_map_iterator<KeydometT, T, OtherConst>& other) const
+            {
+                return key == other.key;
+            }
+
+            template<bool OtherConst>
+            bool operator!=(const flat_map_iterator<KeydometT, T, OtherConst>& other) const
+            {
+                return key != other.key;
+            }
+
+            template<bool OtherConst>
+            bool operator<(const flat_map_iterator<KeydometT, T, OtherConst>& other) const
+            {
+                return key < other.key;
+            }
+
+            template<bool OtherConst>
+            bool operator>(const flat_map_iterator<KeydometT, T, OtherConst>& other) const
+            {
+                return key > other.key;
+            }
+
+            template<bool OtherConst>
+            bool operator<=(const flat_map_iterator<KeydometT, T, OtherConst>& other) const
+            {
+                return key <= other.key;
+            }
+
+            template<bool OtherConst>
+            bool operator>=(const flat_map_iterator<KeydometT, T, OtherConst>& other) const
+            {
+                return key >= other.key;
+            }
+
+        private:
+
+            const KeydometT* key = nullptr;
+            value_ptr value = nullptr;
+
+        };
+    }
+
+    //
+    // A sorted map from keydomets, e.g., flat_map<keydomet<std::string, prefix_size::SIZE_32BIT>, int>, with the API
+    // of a std::map using a transparent comparator. The prefixes, keys and values are kept in three arrays, so
+    // lookups don't read the values, and dereferencing an iterator yields a pair of references to a key and its
+    // value. See flat_set.
+    //
+    template<class KeydometT, class T>
+    class flat_map : private imp::sorted_keys<KeydometT>
+    {
+
+        using base = imp::sorted_keys<KeydometT>;
+        using base::keys;
+        using base::prefixes;
+
+    public:
+
+        using key_type = KeydometT;
+        using mapped_type = T;
+        using value_type = std::pair<KeydometT, T>;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using key_compare = std::less<>;
+        using iterator = imp::flat_map_iterator<KeydometT, T, false>;
+        using const_iterator = imp::flat_map_iterator<KeydometT, T, true>;
+        using reference = typename iterator::reference;
+        using const_reference = typename const_iterator::reference;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        flat_map() = default;
+
+        // the pairs need not be sorted
+        template<class InputIt>
+        flat_map(InputIt first, InputIt last)
+        {
+            std::vector<value_type> pairs(first, last);
+            imp::sort_unique(pairs, [](const value_type& p) -> const KeydometT& { return p.first; });
+            assign_sorted(pairs);
+        }
+
+        template<class InputIt>
+        flat_map(sorted_unique_t, InputIt first, InputIt last)
+        {
+            std::vector<value_type> pairs(first, last);
+            assign_sorted(pairs);
+        }
+
+        flat_map(std::initializer_list<value_type> values) : flat_map(values.begin(), values.end())
+        {
+        }
+
+        iterator begin() { return at_pos(0); }
+        const_iterator begin() const { return at_pos(0); }
+        const_iterator cbegin() const { return begin(); }
+        iterator end() { return at_pos(keys.size()); }
+        const_iterator end() const { return at_pos(keys.size()); }
+        const_iterator cend() const { return end(); }
+        reverse_iterator rbegin() { return reverse_iterator{end()}; }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator{end()}; }
+        const_reverse_iterator crbegin() const { return rbegin(); }
+        reverse_iterator rend() { return reverse_iterator{begin()}; }
+        const_reverse_iterator rend() const { return const_reverse_iterator{begin()}; }
+        const_reverse_iterator crend() const { return rend(); }
+
+        // the sorted keys, and their values (bools are boxed, see imp::boxed)
+        const std::vector<KeydometT>& get_keys() const { return keys; }
+        const std::vector<imp::flat_stored_t<T>>& get_values() const { return values; }
+
+        bool empty() const
+        {
+            return keys.empty();
+        }
+
+        size_type size() const
+        {
+            return keys.size();
+        }
+
+        key_compare key_comp() const
+        {
+            return {};
+        }
+
+        void reserve(size_type num)
+        {
+            prefixes.reserve(num);
+            keys.reserve(num);
+            values.reserve(num);
+        }
+
+        void clear()
+        {
+            prefixes.clear();
+            keys.clear();
+            values.clear();
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value)
+        {
+            return try_emplace(value.first, value.second);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value)
+        {
+            return try_emplace(std::move(value.first), std::move(value.second));
+        }
+
+        // sorts the given pairs, and merges them with the ones held
+        template<class InputIt>
+        void insert(InputIt first, InputIt last)
+        {
+            std::vector<value_type> added(first, last);
+            imp::sort_unique(added, [](const value_type& p) -> const KeydometT& { return p.first; });
+            std::vector<KeydometT> merged_keys;
+            std::vector<imp::flat_stored_t<T>> merged_values;
+            merged_keys.reserve(keys.size() + added.size());
+            merged_values.reserve(keys.size() + added.size());
+            size_t held = 0;
+            auto add = added.begin();
+            while (held < keys.size() && add != added.end())
+            {
+                const int cmp = keys[held].compare(add->first);
+                if (cmp <= 0)
+                {
+                    merged_keys.push_back(std::move(keys[held]));
+                    merged_values.push_back(std::move(values[held++]));
+                    // pairs already held are kept
+                    if (cmp == 0)
+                        ++add;
+                }
+                else
+                {
+                    merged_keys.push_back(std::move(add->first));
+                    merged_values.push_back(std::move(add->second));
+                    ++add;
+                }
+            }
+            for (; held < keys.size(); ++held)
+            {
+                merged_keys.push_back(std::move(keys[held]));
+                merged_values.push_back(std::move(values[held]));
+            }
+            for (; add != added.end(); ++add)
+            {
+                merged_keys.push_back(std::move(add->first));
+                merged_values.push_back(std::move(add->second));
+            }
+            this->replace_keys(merged_keys);
+            values.swap(merged_values);
+        }
+
+        void insert(std::initializer_list<value_type> values_list)
+        {
+            insert(values_list.begin(), values_list.end());
+        }
+
+        template<class... Args>
+        std::pair<iterator, bool> emplace(Args&&... args)
+        {
+            value_type value(std::forward<Args>(args)...);
+            return try_emplace(std::move(value.first), std::move(value.second));
+        }
+
+        template<class... Args>
+        std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args)
+        {
+            return emplace_key(KeydometT{key}, std::forward<Args>(args)...);
+        }
+
+        template<class... Args>
+        std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args)
+        {
+            return emplace_key(std::move(key), std::forward<Args>(args)...);
+        }
+
+        T& operator[](const key_type& key)
+        {
+            return (*try_emplace(key).first).second;
+        }
+
+        T& operator[](key_type&& key)
+        {
+            return (*try_emplace(std::move(key)).first).second;
+        }
+
+        template<class KeyT>
+        T& at(const KeyT& key)
+        {
+            const typename base::position p = this->search(key);
+            if (!p.equal)
+                throw std::out_of_range("flat_map::at");
+            return imp::unbox(values[p.pos]);
+        }
+
+        template<class KeyT>
+        const T& at(const KeyT& key) const
+        {
+            return const_cast<flat_map*>(this)->at(key);
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            return erase(pos, pos + 1);
+        }
+
+        iterator erase(iterator pos)
+        {
+            return erase(const_iterator{pos});
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            const size_t first_pos = static_cast<size_t>(first - cbegin());
+            const size_t last_pos = static_cast<size_t>(last - cbegin());
+            this->erase_keys(first_pos, last_pos);
+            values.erase(values.begin() + first_pos, values.begin() + last_pos);
+            return at_pos(first_pos);
+        }
+
+        size_type erase(const key_type& key)
+        {
+            const typename base::position p = this->search(key);
+            if (!p.equal)
+                return 0;
+            erase(at_pos(p.pos));
+            return 1;
+        }
+
+        template<class KeyT>
+        iterator find(const KeyT& key)
+        {
+            const typename base::position p = this->search(key);
+            return at_pos(p.equal ? p.pos : keys.size());
+        }
+
+        template<class KeyT>
+        const_iterator find(const KeyT& key) const
+        {
+            return const_cast<flat_map*>(this)->find(key);
+        }
+
+        template<class KeyT>
+        size_type count(const KeyT& key) const
+        {
+            return this->search(key).equal ? 1 : 0;
+        }
+
+        template<class KeyT>
+        bool contains(const KeyT& key) const
+        {
+            return this->search(key).equal;
+        }
+
+        template<class KeyT>
+        iterator lower_bound(const KeyT& key)
+        {
+            return at_pos(this->search(key).pos);
+        }
+
+        template<class KeyT>
+        const_iterator lower_bound(const KeyT& key) const
+        {
+            return const_cast<flat_map*>(this)->lower_bound(key);
+        }
+
+        template<class KeyT>
+        iterator upper_bound(const KeyT& key)
+        {
+            const typename base::position p = this->search(key);
+            return at_pos(p.pos + (p.equal ? 1 : 0));
+        }
+
+        template<class KeyT>
+        const_iterator upper_bound(const KeyT& key) const
+        {
+            return const_cast<flat_map*>(this)->upper_bound(key);
+        }
+
+        template<class KeyT>
+        std::pair<iterator, iterator> equal_range(const KeyT& key)
+        {
+            const typename base::position p = this->search(key);
+            return {at_pos(p.pos), at_pos(p.pos + (p.equal ? 1 : 0))};
+        }
+
+        template<class KeyT>
+        std::pair<const_iterator, const_iterator> equal_range(const KeyT& key) const
+        {
+            return const_cast<flat_map*>(this)->equal_range(key);
+        }
+
+        friend bool operator==(const flat_map& m1, const flat_map& m2)
+        {
+            return m1.keys == m2.keys && m1.values == m2.values;
+        }
+
+        friend bool operator!=(const flat_map& m1, const flat_map& m2)
+        {
+            return !(m1 == m2);
+        }
+
+    private:
+
+        std::vector<imp::flat_stored_t<T>> values;
+
+        iterator at_pos(size_t pos)
+        {
+            return {keys.data() + pos, values.data() + pos};
+        }
+
+        const_iterator at_pos(size_t pos) const
+        {
+            return {keys.data() + pos, values.data() + pos};
+        }
+
+        void assign_sorted(std::vector<value_type>& pairs)
+        {
+            keys.clear();
+            values.clear();
+            reserve(pairs.size());
+            for (value_type& p : pairs)
+            {
+                keys.push_back(std::move(p.first));
+                values.push_back(std::move(p.second));
+            }
+            this->build_prefixes();
+        }
+
+        template<class... Args>
+        std::pair<iterator, bool> emplace_key(KeydometT&& key, Args&&... args)
+        {
+            const typename base::position p = this->search(key);
+            if (p.equal)
+                return {at_pos(p.pos), false};
+            values.emplace(values.begin() + p.pos, std::forward<Args>(args)...);
+            try
+            {
+                this->insert_key(p.pos, std::move(key));
+            }
+            catch (...)
+            {
+                values.erase(values.begin() + p.pos);
+                throw;
+            }
+            return {at_pos(p.pos), true};
+        }
+
+    };
+
+}
+
+#endif //KEYDOMET_FLATSET_H
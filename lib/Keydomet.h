@@ -9,19 +9,37 @@
 #include <iostream>
 #include <string>
 #include <cstring>
+#include <cstdint>
 #include <utility>
 #include <type_traits>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <memory>
 #include <map>
 #include <set>
+#include <array>
+#include <stdexcept>
+
+#if defined(__cpp_impl_three_way_comparison) && __cpp_impl_three_way_comparison >= 201907L
+#define KDMT_THREE_WAY 1
+#include <compare>
+#else
+#define KDMT_THREE_WAY 0
+#endif // __cpp_impl_three_way_comparison
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define KDMT_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define KDMT_X86_SIMD 0
+#endif // __x86_64__
 
 //TODO optimize keydomet generation for SSO
 //TODO consider implications of storage type when char type is signed vs. unsigned
-//TODO make keydomet usage stats optional
 //TODO measure memory footprint in term of cache lines on various benchmarks.
 //     mostly, eval the effect of going from a 32B string object to 40B with keydomet, ruining cache line packing.
-//TODO consider placing the keydomet in the SSO buffer when the string is long (and not using keydomet otherwise).
-//     since keydomet isn't much better than SSO, the memory overhead reduction could outweigh not using keydomet on
-//     short strings. should probably be a compile time optimization choice.
 
 namespace kdmt
 {
@@ -34,8 +52,26 @@ namespace kdmt
         SIZE_128BIT = 16
     };
 
-    template<prefix_size>
-    struct prefix_storage; // Unexpected prefix_size value!
+    //
+    // Any width from 1 to 16 bytes can be used as well, e.g., keydomet<std::string, prefix_bytes(12)>. Widths other
+    // than the ones named above are stored packed (byte aligned) and are held in the next wider type once loaded,
+    // which lets a prefix exactly fill the padding next to the string.
+    //
+    constexpr prefix_size prefix_bytes(size_t bytes)
+    {
+        return static_cast<prefix_size>(bytes);
+    }
+
+    struct kdmt128_t;
+
+    template<prefix_size Size>
+    struct prefix_storage
+    {
+        static_assert(static_cast<size_t>(Size) >= 1 && static_cast<size_t>(Size) <= 16, "Prefixes take 1 to 16 bytes");
+        using type = std::conditional_t<(static_cast<size_t>(Size) <= 2), uint16_t,
+                     std::conditional_t<(static_cast<size_t>(Size) <= 4), uint32_t,
+                     std::conditional_t<(static_cast<size_t>(Size) <= 8), uint64_t, kdmt128_t>>>;
+    };
 
     template<> struct prefix_storage<prefix_size::SIZE_16BIT>  { using type = uint16_t; };
     template<> struct prefix_storage<prefix_size::SIZE_32BIT>  { using type = uint32_t; };
@@ -69,14 +105,36 @@ namespace kdmt
     };
     template<> struct prefix_storage<prefix_size::SIZE_128BIT> { using type = kdmt128_t; };
 
+    namespace imp
+    {
+        template<typename...>
+        using void_t = void;
+    }
+
     //
     // Helper functions to provide access to the raw c-string array.
-    // New string types should add an overload, which uses that type's API.
+    // New string types should add an overload, which uses that type's API. Types whose const data() returns the
+    // characters, e.g., std::string, std::array<char, N> or std::vector<char>, are supported as is.
     //
     inline const char* get_raw_str(const char* str) { return str; }
     template<typename StrT>
-    inline std::enable_if_t<std::is_same<decltype(std::declval<StrT>().data()), const char*>::value, const char*>
+    inline std::enable_if_t<std::is_same<decltype(std::declval<const StrT&>().data()), const char*>::value, const char*>
     get_raw_str(const StrT& str) { return str.data(); }
+    // byte strings, e.g., std::vector<uint8_t> - bytes compare as unsigned chars, just like the characters of strings
+    template<typename StrT>
+    inline std::enable_if_t<std::is_same<decltype(std::declval<const StrT&>().data()), const unsigned char*>::value,
+            const char*>
+    get_raw_str(const StrT& str) { return reinterpret_cast<const char*>(str.data()); }
+
+    //
+    // Detects string types that expose their length via size(). For such types the prefix can
+    // be extracted without scanning the characters array for the terminating NUL.
+    //
+    template<typename StrT, typename = void>
+    struct has_size : std::false_type {};
+
+    template<typename StrT>
+    struct has_size<StrT, imp::void_t<decltype(std::declval<const StrT&>().size())>> : std::true_type {};
 
     //
     // Helper function for swapping bytes, turning the big endian order in the string into
@@ -90,13 +148,82 @@ namespace kdmt
         val.msbs = __builtin_bswap64(val.msbs);
     }
 
+    //
+    // Helper functions that zero all bytes past the first len bytes of a value loaded (unflipped)
+    // from memory. The mask is computed without branches; the double shift avoids shifting by the
+    // full width of the type when len covers the whole value.
+    //
+    template<typename T>
+    inline T mask_tail(T val, size_t len)
+    {
+        static_assert(std::is_unsigned<T>::value && sizeof(T) <= sizeof(uint64_t), "Unexpected prefix type!");
+        const size_t keep = len < sizeof(T) ? len : sizeof(T);
+        const uint64_t mask = ~((~uint64_t{0} << (4 * keep)) << (4 * keep));
+        return static_cast<T>(val & mask);
+    }
+
+    inline kdmt128_t mask_tail(kdmt128_t val, size_t len)
+    {
+        // the msbs half holds the first 8 bytes in memory order, the lsbs half holds the rest
+        const size_t keep = len < sizeof(kdmt128_t) ? len : sizeof(kdmt128_t);
+        const size_t msbs_keep = keep < sizeof(val.msbs) ? keep : sizeof(val.msbs);
+        return {mask_tail(val.msbs, msbs_keep), mask_tail(val.lsbs, keep - msbs_keep)};
+    }
+
+    namespace imp
+    {
+        // Reading a full prefix from a string shorter than the prefix is safe as long as the read
+        // doesn't cross into the next page. 4KB is the smallest page size on supported platforms.
+        constexpr uintptr_t min_page_size = 4096;
+
+        inline bool crosses_page(const char* ptr, size_t bytes)
+        {
+            return ((uintptr_t)ptr & (min_page_size - 1)) > min_page_size - bytes;
+        }
+    }
+
+    //
+    // Helper function that turns the first len characters of a string into a number.
+    // When the string is at least as long as the prefix, or reading a full prefix cannot fault,
+    // a single wide load is used and the bytes past the end of the string are masked out.
+    // Otherwise (a short string near the end of a page), only the string's bytes are copied.
+    // Over-reading is disabled when building with AddressSanitizer, which rightfully flags it.
+    //
+    template<typename KeydometT>
+    inline KeydometT chars_to_prefix(const char* cstr, size_t len)
+    {
+        KeydometT trg;
+#if defined(__SANITIZE_ADDRESS__)
+        constexpr bool allow_overread = false;
+#else
+        constexpr bool allow_overread = true;
+#endif // __SANITIZE_ADDRESS__
+        if (len >= sizeof(trg) || (allow_overread && !imp::crosses_page(cstr, sizeof(trg))))
+        {
+            memcpy(&trg, cstr, sizeof(trg));
+            trg = mask_tail(trg, len);
+        }
+        else
+        {
+            trg = KeydometT{};
+            memcpy(&trg, cstr, len);
+        }
+        flip_bytes(trg);
+        return trg;
+    }
+
     //
     // Helper function that turns the string's keydomet into a number.
-    // TODO - Can be optimized, e.g., by using a cast when the string's buffer is known to be large enough
-    // (namely, SSO is used; zero padding still required based on actual string size).
+    // String types exposing size() use the length-aware extraction above, others are scanned.
     //
     template<typename KeydometT, typename StrImp>
-    inline KeydometT str_to_prefix(const StrImp& str)
+    inline std::enable_if_t<has_size<StrImp>::value, KeydometT> str_to_prefix(const StrImp& str)
+    {
+        return chars_to_prefix<KeydometT>(get_raw_str(str), str.size());
+    }
+
+    template<typename KeydometT, typename StrImp>
+    inline std::enable_if_t<!has_size<StrImp>::value, KeydometT> str_to_prefix(const StrImp& str)
     {
         const char* cstr = get_raw_str(str);
         KeydometT trg;
@@ -112,228 +239,2217 @@ namespace kdmt
         return trg;
     }
 
-    template<prefix_size SIZE>
-    class prefix_rep
+    //
+    // Helper function that turns a prefix back into the characters it encodes (the inverse of str_to_prefix).
+    // All sizeof(PrefixT) characters are written, including the zero padding of short strings.
+    //
+    template<typename PrefixT>
+    inline void prefix_to_chars(PrefixT val, char* trg)
     {
+        flip_bytes(val);
+        memcpy(trg, &val, sizeof(val));
+    }
 
-    public:
-
-        using prefix_type = typename prefix_storage<SIZE>::type;
-
-        explicit prefix_rep(std::nullptr_t) noexcept {} // only exists to allow actual initialization *after* string construction
+    namespace imp
+    {
+        //
+        // Compile time counterpart of chars_to_prefix, for constant keys: the number is built a character at a time,
+        // most significant first, rather than loaded from memory and byte swapped. Only the first len characters are
+        // used; the rest of the prefix is zero padded.
+        //
+        template<typename PrefixT>
+        constexpr std::enable_if_t<std::is_unsigned<PrefixT>::value, PrefixT> const_chars_to_prefix(const char* str,
+                                                                                                     size_t len)
+        {
+            PrefixT val = 0;
+            for (size_t i = 0; i < sizeof(PrefixT); ++i)
+                val = static_cast<PrefixT>((val << 8) | (i < len ? (unsigned char)str[i] : 0));
+            return val;
+        }
 
-        template<typename StrImp>
-        explicit prefix_rep(const StrImp& str) : val{str_to_prefix<prefix_type>(str)}
+        template<typename PrefixT>
+        constexpr std::enable_if_t<std::is_same<PrefixT, kdmt128_t>::value, PrefixT> const_chars_to_prefix(
+                const char* str, size_t len)
         {
+            using half_type = kdmt128_t::half_type;
+            return {const_chars_to_prefix<half_type>(str, len),
+                    len > sizeof(half_type) ? const_chars_to_prefix<half_type>(str + sizeof(half_type),
+                                                                               len - sizeof(half_type)) : 0};
         }
+    }
 
-        prefix_rep(const prefix_rep& other) : val(other.val)
-        {}
+    //
+    // A non-owning view of a character range, e.g., for searching a container using a (pointer, length) pair
+    // without constructing a string. Any other view type, e.g., C++17's std::string_view, works just as well.
+    //
+    struct chars_view
+    {
+        const char* chars;
+        size_t len;
 
-        prefix_rep(prefix_rep&&) noexcept = default;
+        constexpr const char* data() const { return chars; }
+        constexpr size_t size() const { return len; }
+    };
 
-        prefix_rep& operator=(prefix_rep&&) noexcept = default;
-        prefix_rep& operator=(const prefix_rep&) noexcept = default;
+    inline std::ostream& operator<<(std::ostream& os, const chars_view& str)
+    {
+        os.write(str.chars, str.len);
+        return os;
+    }
+
+    namespace imp
+    {
+        //
+        // The characters of a string that follow its first offset characters (the ones encoded in its prefix).
+        // When the string type exposes its length, so does the suffix; otherwise the suffix is NUL terminated.
+        //
+        using sized_suffix = chars_view;
 
-        prefix_type get_val() const
+        struct unsized_suffix
         {
-            return val;
+            const char* chars;
+        };
+
+        template<typename StrT>
+        inline std::enable_if_t<has_size<StrT>::value, sized_suffix> suffix_of(const StrT& str, size_t offset)
+        {
+            return {get_raw_str(str) + offset, str.size() - offset};
         }
 
-        bool operator<(const prefix_rep<SIZE>& other) const
+        template<typename StrT>
+        inline std::enable_if_t<!has_size<StrT>::value, unsized_suffix> suffix_of(const StrT& str, size_t offset)
         {
-            return this->val < other.val;
+            // pointer arithmetic done on integers: when short literals are inlined, GCC flags the (never taken)
+            // collision path with -Warray-bounds, and the pragma can't silence it at the inlined call site
+            return {(const char*)((uintptr_t)get_raw_str(str) + offset)};
         }
 
-        bool operator==(const prefix_rep<SIZE>& other) const
+        //
+        // Helper functions returning the index of the first mismatching byte of two equally long ranges (or len
+        // when there's none). Ranges shorter than 16 bytes are compared using (possibly overlapping) 8 byte words.
+        // On x86-64, longer ranges are compared in 16 byte blocks using SSE2, which every x86-64 CPU has, and ranges
+        // of 64 bytes or more in 32 byte blocks using AVX2, when the CPU supports it (checked once, at runtime).
+        // The last block overlaps the one before it rather than falling back to a byte loop. Other platforms use
+        // 8 byte words throughout.
+        //
+        inline size_t word_mismatch(const char* s1, const char* s2)
         {
-            return this->val == other.val;
+            uint64_t w1, w2;
+            memcpy(&w1, s1, sizeof(w1));
+            memcpy(&w2, s2, sizeof(w2));
+            // the lowest byte is the first one in memory
+            return w1 != w2 ? __builtin_ctzll(w1 ^ w2) / 8 : sizeof(uint64_t);
         }
 
-        bool operator!=(const prefix_rep<SIZE>& other) const
+        inline size_t first_mismatch_words(const char* s1, const char* s2, size_t len)
         {
-            return this->val != other.val;
+            if (len < sizeof(uint64_t))
+            {
+                size_t i = 0;
+                while (i < len && s1[i] == s2[i])
+                    ++i;
+                return i;
+            }
+            size_t i = 0;
+            for (; i + sizeof(uint64_t) < len; i += sizeof(uint64_t))
+            {
+                const size_t mismatch = word_mismatch(s1 + i, s2 + i);
+                if (mismatch < sizeof(uint64_t))
+                    return i + mismatch;
+            }
+            i = len - sizeof(uint64_t);
+            const size_t mismatch = word_mismatch(s1 + i, s2 + i);
+            return mismatch < sizeof(uint64_t) ? i + mismatch : len;
         }
 
-        bool string_shorter_than_prefix() const
+#if KDMT_X86_SIMD
+        inline size_t block_mismatch_sse2(const char* s1, const char* s2)
         {
-            // if the last byte/char of the keydomet is all zeros, the string must
-            // have been shorter than the keydomet's capacity.
-            // note: this won't always be correct when working with Unicode strings!
-            constexpr prefix_type LastByteMask{0xFFUL};
-            return (val & LastByteMask) == prefix_type{0UL};
+            const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1));
+            const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s2));
+            const unsigned ne = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(b1, b2))) & 0xFFFF;
+            return ne != 0 ? __builtin_ctz(ne) : sizeof(__m128i);
         }
 
-    private:
+        inline size_t first_mismatch_sse2(const char* s1, const char* s2, size_t len)
+        {
+            size_t i = 0;
+            for (; i + sizeof(__m128i) < len; i += sizeof(__m128i))
+            {
+                const size_t mismatch = block_mismatch_sse2(s1 + i, s2 + i);
+                if (mismatch < sizeof(__m128i))
+                    return i + mismatch;
+            }
+            i = len - sizeof(__m128i);
+            const size_t mismatch = block_mismatch_sse2(s1 + i, s2 + i);
+            return mismatch < sizeof(__m128i) ? i + mismatch : len;
+        }
 
-        prefix_type val; // non-const to allow move assignment (useful in vector resizing and algorithms)
+        __attribute__((target("avx2")))
+        inline unsigned block_mismatch_avx2(const char* s1, const char* s2)
+        {
+            const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1));
+            const __m256i b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s2));
+            return ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(b1, b2)));
+        }
 
-    };
+        // 4 blocks are compared per iteration, and only a mismatching iteration looks for the mismatching block
+        __attribute__((target("avx2")))
+        inline size_t first_mismatch_avx2(const char* s1, const char* s2, size_t len)
+        {
+            constexpr size_t block = sizeof(__m256i);
+            size_t i = 0;
+            for (; i + 4 * block <= len; i += 4 * block)
+            {
+                __m256i eq = _mm256_set1_epi8(-1);
+                for (size_t b = 0; b < 4; ++b)
+                {
+                    const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + i + b * block));
+                    const __m256i b2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s2 + i + b * block));
+                    eq = _mm256_and_si256(eq, _mm256_cmpeq_epi8(b1, b2));
+                }
+                if (static_cast<unsigned>(_mm256_movemask_epi8(eq)) != 0xFFFFFFFF)
+                    break;
+            }
+            for (; i + block < len; i += block)
+            {
+                const unsigned ne = block_mismatch_avx2(s1 + i, s2 + i);
+                if (ne != 0)
+                    return i + __builtin_ctz(ne);
+            }
+            if (i >= len)
+                return len;
+            // the last block, overlapping the one before it
+            i = len - block;
+            const unsigned ne = block_mismatch_avx2(s1 + i, s2 + i);
+            return ne != 0 ? i + __builtin_ctz(ne) : len;
+        }
 
-    template<class StrImp, prefix_size PrefixSize>
-    class keydomet
-    {
+        inline bool has_avx2()
+        {
+            static const bool supported = __builtin_cpu_supports("avx2");
+            return supported;
+        }
+#endif // KDMT_X86_SIMD
 
-    public:
+        inline size_t first_mismatch(const char* s1, const char* s2, size_t len)
+        {
+#if KDMT_X86_SIMD
+            if (len >= 4 * sizeof(__m128i) && has_avx2())
+                return first_mismatch_avx2(s1, s2, len);
+            if (len >= sizeof(__m128i))
+                return first_mismatch_sse2(s1, s2, len);
+#endif // KDMT_X86_SIMD
+            return first_mismatch_words(s1, s2, len);
+        }
 
-        using str_imp = StrImp;
-        static constexpr prefix_size size = PrefixSize;
+        //
+        // Full string comparison used when the prefixes collide. The characters encoded in the prefix are known
+        // to be equal, so only the suffixes following them are compared. When both lengths are known, the
+        // comparison is tiered: the next 8 bytes are compared as big endian numbers, which decides most
+        // collisions of keys that differ shortly after the prefix, and only then are longer keys (e.g., paths or
+        // URLs sharing a long head) searched for their first mismatch a block at a time.
+        //
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+// once inlined for short SSO strings, GCC flags the word loads of the (never taken) long keys path
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif // __GNUC__
+        inline int compare_suffix(sized_suffix s1, sized_suffix s2)
+        {
+            const size_t common = s1.len < s2.len ? s1.len : s2.len;
+            size_t offset = 0;
+            if (common >= sizeof(uint64_t))
+            {
+                uint64_t w1, w2;
+                memcpy(&w1, s1.chars, sizeof(w1));
+                memcpy(&w2, s2.chars, sizeof(w2));
+                if (w1 != w2)
+                {
+                    flip_bytes(w1);
+                    flip_bytes(w2);
+                    return ((int)!(w1 < w2) << 1) - 1;
+                }
+                offset = sizeof(uint64_t);
+            }
+            offset += first_mismatch(s1.chars + offset, s2.chars + offset, common - offset);
+            if (offset < common)
+                return (int)(unsigned char)s1.chars[offset] - (int)(unsigned char)s2.chars[offset];
+            return (int)(s1.len > s2.len) - (int)(s1.len < s2.len);
+        }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif // __GNUC__
 
-        keydomet(const str_imp& s) : prefix{s}, str{s}
+        //
+        // NUL terminated suffixes are compared 8 bytes at a time while the loads can't fault (see crosses_page),
+        // stopping at the first mismatch or NUL. Once either suffix nears the end of a page, strcmp takes over.
+        //
+        inline int compare_suffix(unsized_suffix s1, unsized_suffix s2)
         {
+#if !defined(__SANITIZE_ADDRESS__)
+            const char* c1 = s1.chars;
+            const char* c2 = s2.chars;
+            while (!crosses_page(c1, sizeof(uint64_t)) && !crosses_page(c2, sizeof(uint64_t)))
+            {
+                uint64_t w1, w2;
+                memcpy(&w1, c1, sizeof(w1));
+                memcpy(&w2, c2, sizeof(w2));
+                // flags the first NUL of w1 exactly (flags past it may be false positives, and are ignored)
+                const uint64_t nuls = (w1 - 0x0101010101010101ULL) & ~w1 & 0x8080808080808080ULL;
+                const uint64_t stops = (w1 ^ w2) | nuls;
+                if (stops != 0)
+                {
+                    const size_t i = __builtin_ctzll(stops) / 8;
+                    return (int)(unsigned char)c1[i] - (int)(unsigned char)c2[i];
+                }
+                c1 += sizeof(uint64_t);
+                c2 += sizeof(uint64_t);
+            }
+            return strcmp(c1, c2);
+#else
+            return strcmp(s1.chars, s2.chars);
+#endif // __SANITIZE_ADDRESS__
         }
 
-        keydomet(std::remove_reference_t<str_imp>&& s) : prefix{static_cast<const str_imp&>(s)}, str{s}
+        inline int compare_suffix(sized_suffix s1, unsized_suffix s2)
         {
+            return compare_suffix(s1, sized_suffix{s2.chars, strlen(s2.chars)});
         }
 
-        template<typename... Args, class StrT = str_imp>
-        keydomet(std::enable_if<std::is_reference<StrT>::value, Args...> args) : prefix{nullptr}, str(std::forward<Args>(args)...)
+        inline int compare_suffix(unsized_suffix s1, sized_suffix s2)
         {
-            prefix = prefix_rep<PrefixSize>{str}; // must be done here due to initialization order
+            return compare_suffix(sized_suffix{s1.chars, strlen(s1.chars)}, s2);
         }
 
-        template<typename OtherImp, prefix_size OtherSize>
-        friend class keydomet;
+        //
+        // The suffix of a fixed-width key (see keydomet_storage<std::array<CharT, N>, ...>), whose length is known at
+        // compile time. Compared with suffixes of other string types, it's a sized suffix.
+        //
+        template<size_t N>
+        struct fixed_suffix
+        {
+            const char* chars; // the whole key
+            size_t offset;
 
-        template<typename Imp>
-        int compare(const keydomet<Imp, PrefixSize>& other) const
+            operator sized_suffix() const { return {chars + offset, N - offset}; }
+        };
+
+        //
+        // Both keys have N characters, so they're compared a word at a time, starting from the word holding the
+        // offset. As N is a constant, the loop is unrolled into a few word compares, and the tail is a memcmp of
+        // constant length, which compilers inline as well.
+        //
+        template<size_t N>
+        inline int compare_suffix(fixed_suffix<N> s1, fixed_suffix<N> s2)
         {
-            if (this->prefix != other.prefix)
-            {
-                ++used_prefix();
-                return diff_as_one_or_minus_one(this->prefix, other.prefix);
-            }
-            else
+            size_t i = s1.offset / sizeof(uint64_t) * sizeof(uint64_t);
+            for (; i + sizeof(uint64_t) <= N; i += sizeof(uint64_t))
             {
-                if (this->prefix.string_shorter_than_prefix())
+                uint64_t w1, w2;
+                memcpy(&w1, s1.chars + i, sizeof(w1));
+                memcpy(&w2, s2.chars + i, sizeof(w2));
+                if (w1 != w2)
                 {
-                    ++used_prefix();
-                    return 0;
+                    flip_bytes(w1);
+                    flip_bytes(w2);
+                    return ((int)!(w1 < w2) << 1) - 1;
                 }
-                ++used_string();
-                return strcmp(get_raw_str(str) + sizeof(PrefixSize), get_raw_str(other.str) + sizeof(PrefixSize));
             }
+            return memcmp(s1.chars + i, s2.chars + i, N - i);
         }
+    }
 
-        template<typename Imp>
-        bool operator<(const keydomet<Imp, PrefixSize>& other) const
+    namespace imp
+    {
+        //
+        // Keeps the most significant bits of a prefix, e.g., in order to compare it with a narrower prefix.
+        //
+        template<typename NarrowT, typename WideT>
+        inline std::enable_if_t<std::is_unsigned<WideT>::value, NarrowT> narrow_prefix(WideT val)
         {
-            return compare(other) < 0;
+            static_assert(sizeof(NarrowT) <= sizeof(WideT), "Prefixes can only be narrowed");
+            return static_cast<NarrowT>(val >> (8 * (sizeof(WideT) - sizeof(NarrowT))));
         }
 
-        template<typename Imp>
-        bool operator==(const keydomet<Imp, PrefixSize>& other) const
+        template<typename NarrowT>
+        inline std::enable_if_t<std::is_unsigned<NarrowT>::value, NarrowT> narrow_prefix(const kdmt128_t& val)
         {
-            return compare(other) == 0;
+            return narrow_prefix<NarrowT>(val.msbs);
         }
 
-        const prefix_rep<PrefixSize>& getPrefix() const
+        template<typename NarrowT>
+        inline std::enable_if_t<std::is_same<NarrowT, kdmt128_t>::value, NarrowT> narrow_prefix(const kdmt128_t& val)
         {
-            return prefix;
+            return val;
         }
 
-        const StrImp& get_str() const
+        //
+        // Prefixes of widths having no type of their own (e.g., 3 or 12 bytes) are held in the next wider type,
+        // keeping only their leading bytes, and are stored packed.
+        //
+        template<prefix_size Size>
+        struct is_packed_width : std::integral_constant<bool,
+                sizeof(typename prefix_storage<Size>::type) != static_cast<size_t>(Size)> {};
+
+        template<size_t Bytes, typename T>
+        inline std::enable_if_t<std::is_unsigned<T>::value, T> truncate_prefix(T val)
         {
-            return str;
+            static_assert(Bytes >= 1 && Bytes <= sizeof(T), "Unexpected prefix width");
+            constexpr unsigned shift = 8 * (sizeof(T) - Bytes);
+            return static_cast<T>((val >> shift) << shift);
         }
 
-        static size_t& used_prefix() { static size_t counter = 0; return counter; }
-        static size_t& used_string() { static size_t counter = 0; return counter; }
+        template<size_t Bytes>
+        inline kdmt128_t truncate_prefix(const kdmt128_t& val)
+        {
+            static_assert(Bytes > sizeof(val.msbs) && Bytes <= sizeof(val), "Unexpected prefix width");
+            return {val.msbs, truncate_prefix<Bytes - sizeof(val.msbs)>(val.lsbs)};
+        }
 
-    private:
+        // the byte at the given index of the encoded prefix (index 0 being the most significant byte)
+        template<typename T>
+        constexpr std::enable_if_t<std::is_unsigned<T>::value, uint8_t> prefix_byte(T val, size_t index)
+        {
+            return static_cast<uint8_t>(val >> (8 * (sizeof(T) - 1 - index)));
+        }
 
-        // using composition instead of inheritance (from str_imp) to make sure
-        // the keydomet is at the beginning of the object rather than at the end
-        prefix_rep<PrefixSize> prefix;
-        StrImp str;
+        constexpr uint8_t prefix_byte(const kdmt128_t& val, size_t index)
+        {
+            return index < sizeof(val.msbs) ? prefix_byte(val.msbs, index) :
+                    prefix_byte(val.lsbs, index - sizeof(val.msbs));
+        }
 
-        static int diff_as_one_or_minus_one(const prefix_rep<PrefixSize>& v1, const prefix_rep<PrefixSize>& v2)
+        // packed storage keeps the leading Bytes bytes, in native order
+        template<size_t Bytes, typename T>
+        inline std::enable_if_t<std::is_unsigned<T>::value> pack_prefix(T val, unsigned char* trg)
         {
-            // return -1 if v1 < v2 and 1 otherwise
-            // this is done without conditional branches and without risking wrap-around
-            return ((int)!(v1 < v2) << 1) - 1;
+            const T lead = static_cast<T>(val >> (8 * (sizeof(T) - Bytes)));
+            memcpy(trg, &lead, Bytes);
         }
 
-    };
+        template<size_t Bytes>
+        inline void pack_prefix(const kdmt128_t& val, unsigned char* trg)
+        {
+            memcpy(trg, &val.msbs, sizeof(val.msbs));
+            pack_prefix<Bytes - sizeof(val.msbs)>(val.lsbs, trg + sizeof(val.msbs));
+        }
 
-    inline std::ostream& operator<<(std::ostream& os, const kdmt128_t& val)
-    {
-        os << val.msbs << val.lsbs;
-        return os;
+        template<size_t Bytes, typename T>
+        inline std::enable_if_t<std::is_unsigned<T>::value, T> unpack_prefix(const unsigned char* src)
+        {
+            T lead = 0;
+            memcpy(&lead, src, Bytes);
+            return static_cast<T>(lead << (8 * (sizeof(T) - Bytes)));
+        }
+
+        template<size_t Bytes, typename T>
+        inline std::enable_if_t<std::is_same<T, kdmt128_t>::value, T> unpack_prefix(const unsigned char* src)
+        {
+            kdmt128_t val;
+            memcpy(&val.msbs, src, sizeof(val.msbs));
+            val.lsbs = unpack_prefix<Bytes - sizeof(val.msbs), uint64_t>(src + sizeof(val.msbs));
+            return val;
+        }
+
+        template<prefix_size Size, bool Packed = is_packed_width<Size>::value>
+        class prefix_cell
+        {
+            using prefix_type = typename prefix_storage<Size>::type;
+            prefix_type val;
+        public:
+            prefix_cell() = default;
+            constexpr explicit prefix_cell(prefix_type v) : val{v} {}
+            constexpr prefix_type load() const { return val; }
+            void store(prefix_type v) { val = v; }
+        };
+
+        template<prefix_size Size>
+        class prefix_cell<Size, true>
+        {
+            using prefix_type = typename prefix_storage<Size>::type;
+            static constexpr size_t bytes_num = static_cast<size_t>(Size);
+            unsigned char bytes[bytes_num];
+        public:
+            prefix_cell() = default;
+            // the same layout pack_prefix() produces, computed byte by byte for constant keys
+            constexpr explicit prefix_cell(prefix_type v) : bytes{}
+            {
+                // 128 bit prefixes are packed as their most significant half, followed by the rest
+                constexpr size_t half = std::is_same<prefix_type, kdmt128_t>::value ? sizeof(uint64_t) : 0;
+                for (size_t i = 0; i < half; ++i)
+                    bytes[i] = prefix_byte(v, half - 1 - i);
+                for (size_t i = half; i < bytes_num; ++i)
+                    bytes[i] = prefix_byte(v, bytes_num - 1 - (i - half));
+            }
+            prefix_type load() const { return unpack_prefix<bytes_num, prefix_type>(bytes); }
+            void store(prefix_type v) { pack_prefix<bytes_num>(v, bytes); }
+        };
     }
 
-    template<typename StrImp, prefix_size Size>
-    inline std::ostream& operator<<(std::ostream& os, const keydomet<StrImp, Size>& hk)
+    //
+    // Prefix encodings - how the leading characters of a string are turned into the prefix number.
+    // An encoding must preserve the strings' order: different prefixes must compare like their strings do.
+    // When two prefixes are equal, on_tie() tells whether the strings are known to be equal, and otherwise
+    // how many leading characters are known to be equal, so the comparison can resume right after them.
+    // narrow() turns a prefix into the one the same string would have using a narrower prefix type, which
+    // allows comparing keydomets of different prefix sizes.
+    //
+    struct tie_info
     {
-        const StrImp& str = hk.get_str();
-        os << str;
-        return os;
-    }
+        bool equal;    // both strings ended within the prefix, hence are equal
+        size_t offset; // number of leading characters known to be equal
+    };
 
-    namespace imp
+    // The raw characters, one byte each (default).
+    struct raw_encoding
     {
-        // Searching associative containers (namely, sorted rather than hashed) could only be done using
-        // the exact key type till C++14. From C++14, any type that can be compared with the key type can
-        // be used. For instance, a std::string_view can be used in order to find a std::string key.
-        // this is very useful when a key is given as a std::string but a keydomet should be constructed
-        // in order to do the lookup: instead of creating a keydomet that will own a copy of the std::string
-        // (with all the mess involved with the creation of the copy - allocation etc.), a keydomet holding a
-        // const string reference is used, merely referencing the original std::string.
-        // To use the above feature, the comparator used by the container must be transparent, namely have
-        // a is_transparent member. The code below detects the presence of that member, and the result is
-        // used to determine whether a keydomet or KeydometView should be constructed for lookups.
-        template<typename...>
-        using void_t = void;
+        template<typename PrefixT, typename StrImp>
+        static PrefixT encode(const StrImp& str)
+        {
+            return str_to_prefix<PrefixT>(str);
+        }
 
-        struct non_transparent {};
+        template<typename PrefixT>
+        static tie_info on_tie(const PrefixT& val)
+        {
+            // if the last byte/char of the keydomet is all zeros, the string must
+            // have been shorter than the keydomet's capacity.
+            constexpr PrefixT LastByteMask{0xFFUL};
+            return {(val & LastByteMask) == PrefixT{0UL}, sizeof(PrefixT)};
+        }
 
-        auto get_comparator(...) -> non_transparent;
+        template<typename NarrowT, typename WideT>
+        static NarrowT narrow(const WideT& val)
+        {
+            return imp::narrow_prefix<NarrowT>(val);
+        }
+    };
 
-        template<template<class, class...> class Container, class KD, class... Args>
-        auto get_comparator(const Container<KD, Args...>&) -> typename Container<KD, Args...>::key_compare;
+    //
+    // The raw characters, for byte strings which may contain NULs (e.g., serialized composite keys or big endian
+    // integers). Only string types exposing their size are supported. A zero byte can't tell the end of a string,
+    // so prefix ties are resolved using the strings' lengths, which are usually kept within the string objects:
+    // when either string is shorter than the prefix, the lengths alone decide.
+    //
+    struct binary_encoding
+    {
+        static constexpr bool length_aware = true;
 
-        template<class Comparator, class = void_t<>>
-        struct has_transparent_flag_helper : std::false_type {};
+        template<typename PrefixT, typename StrImp>
+        static PrefixT encode(const StrImp& str)
+        {
+            static_assert(has_size<StrImp>::value, "Binary keys must expose their size");
+            return str_to_prefix<PrefixT>(str);
+        }
 
-        template<class Comparator>
-        struct has_transparent_flag_helper<Comparator, void_t<typename Comparator::is_transparent>> : std::true_type {};
+        template<typename PrefixT>
+        static tie_info on_tie(const PrefixT&)
+        {
+            return {false, sizeof(PrefixT)};
+        }
 
-        template<template<class, class...> class Container, class KD, class... Args>
-        auto is_transparent(const Container<KD, Args...>& c) ->
-        std::enable_if_t<has_transparent_flag_helper<decltype(get_comparator(c))>::value, std::true_type>;
+        template<typename NarrowT, typename WideT>
+        static NarrowT narrow(const WideT& val)
+        {
+            return imp::narrow_prefix<NarrowT>(val);
+        }
+    };
 
-        auto is_transparent(...) -> std::false_type;
+    namespace imp
+    {
+        // encodings whose ties must be resolved using the strings' lengths
+        template<class Encoding, class = void>
+        struct is_length_aware : std::false_type {};
 
-        template<class IsTrans>
-        void verify_container_uses_transparent_comperator()
+        template<class Encoding>
+        struct is_length_aware<Encoding, void_t<decltype(Encoding::length_aware)>> :
+                std::integral_constant<bool, Encoding::length_aware> {};
+
+        //
+        // Ties of packed width prefixes. Encodings storing a byte per character are handled exactly; others are
+        // asked about the widest narrower prefix they know, which is just as equal, but may vouch for fewer chars.
+        //
+        template<class Encoding, prefix_size Size, bool Packed = is_packed_width<Size>::value>
+        struct prefix_ties
         {
-            // Containers such as map and set should use /transparent comparators/, which allow keys of different types
-            // to be compared. This eliminates the need to create owning keydomet objects.
-            // Easiest way to do it: use the std::less<> comparator - std::set<KdmtStr, std::less<>>;
-            IsTrans::CheckOutCommentAboveMe();
-        }
+            template<typename PrefixT>
+            static tie_info on_tie(const PrefixT& val)
+            {
+                return Encoding::on_tie(val);
+            }
+        };
 
-        template<>
-        void verify_container_uses_transparent_comperator<std::true_type>() {}
-    }
+        template<prefix_size Size>
+        struct prefix_ties<raw_encoding, Size, true>
+        {
+            template<typename PrefixT>
+            static tie_info on_tie(const PrefixT& val)
+            {
+                constexpr size_t bytes_num = static_cast<size_t>(Size);
+                return {prefix_byte(val, bytes_num - 1) == 0, bytes_num};
+            }
+        };
 
-    template<class StrT, template<class, class...> class Container, prefix_size Size, class... Args>
-    inline auto make_find_key(const Container<keydomet<StrT, Size>, Args...>& s, const StrT& key)
-    {
-        // associative containers (maps, sets) can use a transparent comparator. such a comperator can
-        // compare the internal key type with other types (as long as there's an appropriate operator).
-        // this allows such containers to hold keydomet<string> but search using keydomet<const string&>, saving the allocation.
-        // *** Note: to make a container associative, define it with the less<> comparator:
-        // *** using keydomet_set = std::set<kdmt_str, std::less<>>;
-        using keydomet_str_type = std::conditional_t<decltype(imp::is_transparent(s))::value,
-                keydomet<const StrT&, Size>,
-                keydomet<StrT, Size>
+        template<prefix_size Size>
+        struct prefix_ties<binary_encoding, Size, true>
+        {
+            template<typename PrefixT>
+            static tie_info on_tie(const PrefixT&)
+            {
+                return {false, static_cast<size_t>(Size)};
+            }
+        };
+
+        template<class Encoding, prefix_size Size>
+        struct prefix_ties<Encoding, Size, true>
+        {
+            template<typename PrefixT>
+            static tie_info on_tie(const PrefixT& val)
+            {
+                constexpr size_t bytes_num = static_cast<size_t>(Size);
+                constexpr size_t narrow_bytes = bytes_num >= 8 ? 8 : bytes_num >= 4 ? 4 : bytes_num >= 2 ? 2 : 0;
+                return on_narrow_tie<narrow_bytes>(val);
+            }
+
+        private:
+
+            template<size_t NarrowBytes, typename PrefixT>
+            static std::enable_if_t<NarrowBytes != 0, tie_info> on_narrow_tie(const PrefixT& val)
+            {
+                using narrow_type = typename prefix_storage<prefix_bytes(NarrowBytes)>::type;
+                return Encoding::on_tie(Encoding::template narrow<narrow_type>(val));
+            }
+
+            template<size_t NarrowBytes, typename PrefixT>
+            static std::enable_if_t<NarrowBytes == 0, tie_info> on_narrow_tie(const PrefixT&)
+            {
+                return {false, 0};
+            }
+        };
+
+        template<class Encoding, prefix_size Size, typename PrefixT>
+        inline tie_info tie_of(const PrefixT& val)
+        {
+            return prefix_ties<Encoding, Size>::on_tie(val);
+        }
+
+        // the prefix a string would have using the given (narrower) width, computed from its wider prefix
+        template<class Encoding, prefix_size Size, typename WideT>
+        inline std::enable_if_t<!is_packed_width<Size>::value, typename prefix_storage<Size>::type>
+        narrow_to(const WideT& val)
+        {
+            return Encoding::template narrow<typename prefix_storage<Size>::type>(val);
+        }
+
+        template<class Encoding, prefix_size Size, typename WideT>
+        inline std::enable_if_t<is_packed_width<Size>::value, typename prefix_storage<Size>::type>
+        narrow_to(const WideT& val)
+        {
+            return truncate_prefix<static_cast<size_t>(Size)>(
+                    Encoding::template narrow<typename prefix_storage<Size>::type>(val));
+        }
+    }
+
+    namespace imp
+    {
+        //
+        // Maps each byte value to its code in a packed alphabet. Code 0 marks the end of the string, and the
+        // alphabet's characters are assigned increasing codes. Each run of bytes that aren't part of the alphabet
+        // shares a single, lossy code placed between the codes of its neighboring characters, which keeps the
+        // encoding order preserving. Two strings having the same lossy code may still differ at that character.
+        //
+        struct alphabet_table
+        {
+            uint8_t codes[256];
+            bool lossy[256];
+            unsigned codes_num;
+            unsigned bits;
+        };
+
+        constexpr alphabet_table make_alphabet_table(const char* chars)
+        {
+            bool member[256] = {};
+            for (const char* c = chars; *c != '\0'; ++c)
+                member[(unsigned char)*c] = true;
+            alphabet_table table{};
+            unsigned next_code = 1;
+            for (unsigned c = 0; c < 256; ++c)
+            {
+                if (member[c])
+                {
+                    table.codes[c] = (uint8_t)next_code++;
+                }
+                else
+                {
+                    const bool continues_gap = c > 0 && !member[c - 1];
+                    table.codes[c] = (uint8_t)(continues_gap ? next_code - 1 : next_code++);
+                    table.lossy[table.codes[c]] = true;
+                }
+            }
+            table.codes_num = next_code;
+            while ((1U << table.bits) < table.codes_num)
+                ++table.bits;
+            return table;
+        }
+
+        template<typename StrT>
+        inline std::enable_if_t<has_size<StrT>::value, size_t> chars_len(const StrT& str, size_t)
+        {
+            return str.size();
+        }
+
+        template<typename StrT>
+        inline std::enable_if_t<!has_size<StrT>::value, size_t> chars_len(const StrT& str, size_t max_len)
+        {
+            return strnlen(get_raw_str(str), max_len);
+        }
+    }
+
+    //
+    // Packs characters of a small alphabet using fewer bits than a byte each, so more characters fit into the prefix.
+    // For instance, a 6 bit alphabet fits 5 characters in 32 bits and 10 in 64 bits, and a 4 bit alphabet of digits
+    // is packed like BCD. The alphabet is given as a type with a static constexpr c-string member named chars.
+    // Encoding stops at the first character outside the alphabet, whose code is lossy; the comparison of colliding
+    // prefixes resumes from that character. Prefixes of up to 64 bits are supported.
+    //
+    template<class Alphabet>
+    struct alphabet_encoding
+    {
+        static constexpr imp::alphabet_table table = imp::make_alphabet_table(Alphabet::chars);
+        static constexpr unsigned bits = table.bits;
+        static_assert(bits < 8, "An alphabet of more than 127 characters can't be packed");
+
+        template<typename PrefixT>
+        static constexpr size_t chars_num()
+        {
+            return (8 * sizeof(PrefixT)) / bits;
+        }
+
+        template<typename PrefixT, typename StrImp>
+        static PrefixT encode(const StrImp& str)
+        {
+            static_assert(std::is_unsigned<PrefixT>::value, "Packed alphabets support prefixes of up to 64 bits");
+            constexpr size_t max_chars = chars_num<PrefixT>();
+            const char* chars = get_raw_str(str);
+            const size_t len = imp::chars_len(str, max_chars);
+            const size_t used = len < max_chars ? len : max_chars;
+            uint64_t val = 0;
+            for (size_t i = 0; i < used; ++i)
+            {
+                const uint8_t code = table.codes[(unsigned char)chars[i]];
+                val |= (uint64_t)code << (8 * sizeof(PrefixT) - bits * (i + 1));
+                if (table.lossy[code])
+                    break;
+            }
+            return static_cast<PrefixT>(val);
+        }
+
+        template<typename PrefixT>
+        static tie_info on_tie(const PrefixT& val)
+        {
+            constexpr size_t max_chars = chars_num<PrefixT>();
+            constexpr uint64_t code_mask = (1U << bits) - 1;
+            for (size_t i = 0; i < max_chars; ++i)
+            {
+                const unsigned code = ((uint64_t)val >> (8 * sizeof(PrefixT) - bits * (i + 1))) & code_mask;
+                if (code == 0)
+                    return {true, i};
+                if (table.lossy[code])
+                    return {false, i};
+            }
+            return {false, max_chars};
+        }
+
+        template<typename NarrowT, typename WideT>
+        static NarrowT narrow(const WideT& val)
+        {
+            // the narrower prefix has no room for the wider one's partial character, if any
+            constexpr unsigned unused_bits = 8 * sizeof(NarrowT) - bits * chars_num<NarrowT>();
+            const NarrowT narrow_val = imp::narrow_prefix<NarrowT>(val);
+            return static_cast<NarrowT>((narrow_val >> unused_bits) << unused_bits);
+        }
+    };
+
+    template<class Alphabet>
+    constexpr imp::alphabet_table alphabet_encoding<Alphabet>::table;
+
+    template<class Alphabet>
+    constexpr unsigned alphabet_encoding<Alphabet>::bits;
+
+    namespace alphabets
+    {
+        struct digits { static constexpr const char* chars = "0123456789"; };
+        struct lowercase { static constexpr const char* chars = "abcdefghijklmnopqrstuvwxyz"; };
+        struct hostname { static constexpr const char* chars = "-.0123456789abcdefghijklmnopqrstuvwxyz"; };
+        // the contiguous 'A'..'z' range: upper and lower case letters, and the few symbols between them
+        struct letters { static constexpr const char* chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz"; };
+    }
+
+    namespace imp
+    {
+        // the characters following the first offset ones, as a string of the same kind (sized or not)
+        template<typename StrT>
+        inline std::enable_if_t<has_size<StrT>::value, sized_suffix> skip_chars(const StrT& str, size_t offset)
+        {
+            return suffix_of(str, offset);
+        }
+
+        template<typename StrT>
+        inline std::enable_if_t<!has_size<StrT>::value, const char*> skip_chars(const StrT& str, size_t offset)
+        {
+            return suffix_of(str, offset).chars;
+        }
+
+        // compares the string's first chars with head; 0 means the string starts with head
+        template<typename StrT>
+        inline std::enable_if_t<has_size<StrT>::value, int> compare_head(const StrT& str, const std::string& head)
+        {
+            const size_t len = str.size();
+            if (len < head.size())
+            {
+                const int res = memcmp(get_raw_str(str), head.data(), len);
+                return res != 0 ? res : -1;
+            }
+            return memcmp(get_raw_str(str), head.data(), head.size());
+        }
+
+        template<typename StrT>
+        inline std::enable_if_t<!has_size<StrT>::value, int> compare_head(const StrT& str, const std::string& head)
+        {
+            return strncmp(get_raw_str(str), head.c_str(), head.size());
+        }
+    }
+
+    //
+    // Helper that finds the longest head shared by the given keys, e.g., for setting up a common_head_encoding.
+    //
+    template<class Iter>
+    inline std::string common_head(Iter first, Iter last)
+    {
+        if (first == last)
+            return {};
+        const char* head = get_raw_str(*first);
+        size_t len = imp::chars_len(*first, SIZE_MAX);
+        for (++first; first != last && len > 0; ++first)
+        {
+            const char* chars = get_raw_str(*first);
+            const size_t other_len = imp::chars_len(*first, len);
+            size_t i = 0;
+            while (i < len && i < other_len && chars[i] == head[i])
+                ++i;
+            len = i;
+        }
+        return {head, len};
+    }
+
+    //
+    // Skips a head shared by the keys of a container (e.g., "https://www."), and encodes the characters following
+    // it using the Inner encoding, so the prefix is spent on the characters that actually tell keys apart.
+    // Keys not starting with the head are rare; they get the lowest or highest prefix value, depending on whether
+    // they precede or follow the head, and their comparisons fall back to the complete strings. The head is shared
+    // by all keydomets using the same Tag, including find keys, hence it's set once, before such keydomets are
+    // constructed and before other threads use the encoding; setting a different head afterwards would reorder the
+    // keys of existing containers, and throws std::logic_error instead. Containers needing their own heads should
+    // use their own Tags. Prefixes of up to 64 bits are supported.
+    //
+    template<class Tag = void, class Inner = raw_encoding>
+    class common_head_encoding
+    {
+
+    public:
+
+        static void set_head(std::string new_head)
+        {
+            std::string& h = head();
+            if (!h.empty() && h != new_head)
+                throw std::logic_error("the head of a common_head_encoding is set once");
+            h = std::move(new_head);
+        }
+
+        // sets the head to the longest one shared by the given keys
+        template<class Iter>
+        static void train(Iter first, Iter last)
+        {
+            set_head(common_head(first, last));
+        }
+
+        static const std::string& get_head()
+        {
+            return head();
+        }
+
+        template<typename PrefixT, typename StrImp>
+        static PrefixT encode(const StrImp& str)
+        {
+            static_assert(std::is_unsigned<PrefixT>::value, "Common head encodings support prefixes of up to 64 bits");
+            const std::string& h = head();
+            const int res = imp::compare_head(str, h);
+            if (res != 0)
+                return res < 0 ? PrefixT{0} : static_cast<PrefixT>(~PrefixT{0});
+            return Inner::template encode<PrefixT>(imp::skip_chars(str, h.size()));
+        }
+
+        template<typename PrefixT>
+        static tie_info on_tie(const PrefixT& val)
+        {
+            // the reserved values are shared by keys starting with the head, so nothing is known about them
+            if (val == PrefixT{0} || val == static_cast<PrefixT>(~PrefixT{0}))
+                return {false, 0};
+            const tie_info tie = Inner::on_tie(val);
+            return {tie.equal, head().size() + tie.offset};
+        }
+
+        template<typename NarrowT, typename WideT>
+        static NarrowT narrow(const WideT& val)
+        {
+            // the reserved values are mapped explicitly, since inner encodings may change them when narrowing (e.g.,
+            // packed ones clear the unused bits); the encoded suffixes are narrowed like the inner ones
+            if (val == WideT{0})
+                return NarrowT{0};
+            if (val == static_cast<WideT>(~WideT{0}))
+                return static_cast<NarrowT>(~NarrowT{0});
+            return Inner::template narrow<NarrowT>(val);
+        }
+
+    private:
+
+        static std::string& head()
+        {
+            static std::string common;
+            return common;
+        }
+
+    };
+
+
+    template<prefix_size SIZE>
+    class prefix_rep
+    {
+
+    public:
+
+        using prefix_type = typename prefix_storage<SIZE>::type;
+
+        explicit prefix_rep(std::nullptr_t) noexcept {} // only exists to allow actual initialization *after* string construction
+
+        template<typename StrImp>
+        explicit prefix_rep(const StrImp& str)
+        {
+            val.store(str_to_prefix<prefix_type>(str));
+        }
+
+        constexpr prefix_rep(const prefix_rep& other) : val(other.val)
+        {}
+
+        // wraps a prefix value already extracted from a string, e.g., by a string type caching it.
+        // packed widths keep the value's leading bytes only.
+        static prefix_rep from_val(prefix_type v) noexcept
+        {
+            prefix_rep rep{nullptr};
+            rep.val.store(v);
+            return rep;
+        }
+
+        // wraps a prefix value computed at compile time, see make_const_key()
+        static constexpr prefix_rep from_const_val(prefix_type v) noexcept
+        {
+            return prefix_rep{imp::prefix_cell<SIZE>{v}};
+        }
+
+        prefix_rep(prefix_rep&&) noexcept = default;
+
+        prefix_rep& operator=(prefix_rep&&) noexcept = default;
+        prefix_rep& operator=(const prefix_rep&) noexcept = default;
+
+        constexpr prefix_type get_val() const
+        {
+            return val.load();
+        }
+
+        bool operator<(const prefix_rep<SIZE>& other) const
+        {
+            return get_val() < other.get_val();
+        }
+
+        bool operator==(const prefix_rep<SIZE>& other) const
+        {
+            return get_val() == other.get_val();
+        }
+
+        bool operator!=(const prefix_rep<SIZE>& other) const
+        {
+            return get_val() != other.get_val();
+        }
+
+        // applies to prefixes using the raw encoding, of strings not containing NULs (binary_encoding
+        // resolves ties using the strings' lengths instead)
+        // note: this won't always be correct when working with Unicode strings!
+        bool string_shorter_than_prefix() const
+        {
+            return imp::tie_of<raw_encoding, SIZE>(get_val()).equal;
+        }
+
+    private:
+
+        constexpr explicit prefix_rep(imp::prefix_cell<SIZE> cell) noexcept : val{cell} {}
+
+        imp::prefix_cell<SIZE> val; // non-const to allow move assignment (useful in vector resizing and algorithms)
+
+    };
+
+    //
+    // Keydomet usage statistics - how many comparisons were decided by the prefix alone,
+    // and how many had to fall back to comparing the strings.
+    //
+    struct compare_stats
+    {
+        size_t used_prefix;
+        size_t used_string;
+    };
+
+    //
+    // Statistics policies, selected using keydomet's Stats template argument. All keydomets sharing
+    // a policy type share its counters; use a distinct Tag type to count a container separately.
+    //
+
+    // No statistics are collected (default) - counting compiles away entirely.
+    struct no_stats
+    {
+        static void count_prefix() {}
+        static void count_string() {}
+        static compare_stats snapshot() { return {0, 0}; }
+        static void reset() {}
+    };
+
+    // Relaxed atomic counters shared by all threads. Race-free, but the counters' cache line
+    // bounces between the cores of concurrent readers.
+    template<class Tag = void>
+    class atomic_stats
+    {
+
+        struct alignas(64) counters_type
+        {
+            std::atomic<size_t> used_prefix{0};
+            std::atomic<size_t> used_string{0};
+        };
+
+        static counters_type counters;
+
+    public:
+
+        static void count_prefix() { counters.used_prefix.fetch_add(1, std::memory_order_relaxed); }
+        static void count_string() { counters.used_string.fetch_add(1, std::memory_order_relaxed); }
+
+        static compare_stats snapshot()
+        {
+            return {counters.used_prefix.load(std::memory_order_relaxed),
+                    counters.used_string.load(std::memory_order_relaxed)};
+        }
+
+        static void reset()
+        {
+            counters.used_prefix.store(0, std::memory_order_relaxed);
+            counters.used_string.store(0, std::memory_order_relaxed);
+        }
+
+    };
+
+    template<class Tag>
+    typename atomic_stats<Tag>::counters_type atomic_stats<Tag>::counters;
+
+    // Per-thread counters, each on its own cache line and written only by its owning thread.
+    // Snapshots sum the counters of all live threads and of the threads that have already exited.
+    // A reset running concurrently with comparisons may miss counts taken while it runs.
+    template<class Tag = void>
+    class sharded_stats
+    {
+
+        struct alignas(64) shard
+        {
+            std::atomic<size_t> used_prefix{0};
+            std::atomic<size_t> used_string{0};
+        };
+
+        struct registry
+        {
+            std::mutex lock;
+            std::vector<shard*> shards;
+            compare_stats retired{0, 0}; // counts of threads that have exited
+        };
+
+        static registry& get_registry()
+        {
+            static registry reg;
+            return reg;
+        }
+
+        struct thread_shard
+        {
+            shard counters;
+
+            thread_shard()
+            {
+                registry& reg = get_registry();
+                std::lock_guard<std::mutex> guard{reg.lock};
+                reg.shards.push_back(&counters);
+            }
+
+            ~thread_shard()
+            {
+                registry& reg = get_registry();
+                std::lock_guard<std::mutex> guard{reg.lock};
+                reg.retired.used_prefix += counters.used_prefix.load(std::memory_order_relaxed);
+                reg.retired.used_string += counters.used_string.load(std::memory_order_relaxed);
+                reg.shards.erase(std::find(reg.shards.begin(), reg.shards.end(), &counters));
+            }
+        };
+
+        static shard& local()
+        {
+            static thread_local thread_shard ts;
+            return ts.counters;
+        }
+
+        static void increment(std::atomic<size_t>& counter)
+        {
+            // single writer - no need for an atomic read-modify-write
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+    public:
+
+        static void count_prefix() { increment(local().used_prefix); }
+        static void count_string() { increment(local().used_string); }
+
+        static compare_stats snapshot()
+        {
+            registry& reg = get_registry();
+            std::lock_guard<std::mutex> guard{reg.lock};
+            compare_stats res = reg.retired;
+            for (const shard* s : reg.shards)
+            {
+                res.used_prefix += s->used_prefix.load(std::memory_order_relaxed);
+                res.used_string += s->used_string.load(std::memory_order_relaxed);
+            }
+            return res;
+        }
+
+        static void reset()
+        {
+            registry& reg = get_registry();
+            std::lock_guard<std::mutex> guard{reg.lock};
+            reg.retired = {0, 0};
+            for (shard* s : reg.shards)
+            {
+                s->used_prefix.store(0, std::memory_order_relaxed);
+                s->used_string.store(0, std::memory_order_relaxed);
+            }
+        }
+
+    };
+
+    //
+    // Tag selecting the constructors that build the string in place from their arguments, as in
+    // set.emplace(kdmt::in_place, chars, len). Same as C++17's std::in_place_t.
+    //
+    struct in_place_t
+    {
+        explicit in_place_t() = default;
+    };
+
+    constexpr in_place_t in_place{};
+
+    namespace imp
+    {
+        constexpr size_t unknown_length = SIZE_MAX;
+
+        //
+        // The string's length, cached in the padding between a short prefix and the string object (e.g., the 4 bytes
+        // following a 32 bit prefix, when the string is 8 byte aligned). Keys of different lengths are then known to
+        // differ without reading the string objects. Lengths that don't fit are reported as unknown.
+        //
+        template<bool Enabled>
+        class length_cache
+        {
+        protected:
+            template<class StrT>
+            constexpr void cache_length(const StrT&) {}
+        public:
+            size_t cached_length() const { return unknown_length; }
+        };
+
+        template<>
+        class length_cache<true>
+        {
+            uint32_t len = UINT32_MAX;
+        protected:
+            template<class StrT>
+            constexpr void cache_length(const StrT& str)
+            {
+                const size_t size = str.size();
+                len = size < UINT32_MAX ? static_cast<uint32_t>(size) : UINT32_MAX;
+            }
+        public:
+            size_t cached_length() const { return len < UINT32_MAX ? len : unknown_length; }
+        };
+
+        // the type whose alignment the storage follows - references are stored as pointers
+        template<class StrImp>
+        using layout_type = std::conditional_t<std::is_reference<StrImp>::value, void*, StrImp>;
+
+        constexpr size_t align_up(size_t n, size_t alignment)
+        {
+            return (n + alignment - 1) / alignment * alignment;
+        }
+
+        // whether the length fits in the padding a prefix of the given width leaves before the string
+        constexpr bool length_fits(size_t prefix_bytes, size_t str_align)
+        {
+            return align_up(prefix_bytes + sizeof(uint32_t), str_align) == align_up(prefix_bytes, str_align);
+        }
+
+        template<class StrImp, prefix_size PrefixSize>
+        struct caches_length : std::integral_constant<bool, has_size<StrImp>::value &&
+                length_fits(static_cast<size_t>(PrefixSize), alignof(layout_type<StrImp>))> {};
+
+        // the size of keydomet_storage<StrImp, prefix_bytes(bytes)>: the cached length (if any), the prefix (packed
+        // widths are byte aligned) and the string
+        template<class StrImp>
+        constexpr size_t storage_size(size_t bytes)
+        {
+            const size_t str_align = alignof(layout_type<StrImp>);
+            const bool packed = bytes != 2 && bytes != 4 && bytes != 8 && bytes != 16;
+            const size_t prefix_align = packed ? 1 : (bytes < 8 ? bytes : 8);
+            const size_t align = str_align > prefix_align ? str_align : prefix_align;
+            const bool cached = has_size<StrImp>::value && length_fits(bytes, str_align);
+            const size_t prefix_end = align_up(cached ? sizeof(uint32_t) : 0, prefix_align) + bytes;
+            return align_up(align_up(prefix_end, str_align) + sizeof(layout_type<StrImp>), align);
+        }
+
+        template<class StrImp, bool KeepLengthCache>
+        constexpr size_t fitting_prefix_bytes()
+        {
+            const size_t min_size = storage_size<StrImp>(1);
+            const bool min_cached = has_size<StrImp>::value && length_fits(1, alignof(layout_type<StrImp>));
+            size_t bytes = 1;
+            for (size_t b = 2; b <= 16; ++b)
+            {
+                const bool cached = has_size<StrImp>::value && length_fits(b, alignof(layout_type<StrImp>));
+                if (storage_size<StrImp>(b) == min_size && (!KeepLengthCache || cached == min_cached))
+                    bytes = b;
+            }
+            return bytes;
+        }
+    }
+
+    //
+    // The widest prefix a keydomet over StrImp can have while being no larger than with the narrowest prefix,
+    // i.e., the prefix filling the padding next to the string. For instance, 8 bytes for a std::string, or 4 bytes
+    // when the cached length should be kept as well. Applies to the default storage of StrImp.
+    //
+    template<class StrImp, bool KeepLengthCache = false>
+    struct fitting_prefix_size :
+            std::integral_constant<prefix_size, prefix_bytes(imp::fitting_prefix_bytes<StrImp, KeepLengthCache>())> {};
+
+    //
+    // The layout of a keydomet's state - its prefix and string. By default both are stored, the prefix first,
+    // and the string's length is cached if the padding between them has room for it.
+    // String types that can provide the prefix themselves (e.g., by caching it within the string object)
+    // specialize this class in order to avoid storing the prefix twice.
+    // Every storage provides cached_length(), returning imp::unknown_length when it can't tell the length cheaply.
+    //
+    template<class StrImp, prefix_size PrefixSize, class Encoding = raw_encoding>
+    class keydomet_storage : public imp::length_cache<imp::caches_length<StrImp, PrefixSize>::value>
+    {
+
+        using prefix_type = typename prefix_rep<PrefixSize>::prefix_type;
+
+    public:
+
+        keydomet_storage(const StrImp& s) :
+            prefix_val{prefix_rep<PrefixSize>::from_val(Encoding::template encode<prefix_type>(s))}, str{s}
+        {
+            this->cache_length(str);
+        }
+
+        // the prefix is taken before the string is moved
+        keydomet_storage(std::remove_reference_t<StrImp>&& s) :
+            prefix_val{prefix_rep<PrefixSize>::from_val(Encoding::template encode<prefix_type>(s))}, str{std::move(s)}
+        {
+            this->cache_length(str);
+        }
+
+        // the string is constructed from the given arguments, and only then its prefix is taken
+        template<class... Args, class = std::enable_if_t<std::is_constructible<StrImp, Args&&...>::value>>
+        explicit keydomet_storage(in_place_t, Args&&... args) : prefix_val{nullptr}, str(std::forward<Args>(args)...)
+        {
+            prefix_val = prefix_rep<PrefixSize>::from_val(Encoding::template encode<prefix_type>(str));
+            this->cache_length(str);
+        }
+
+        // the prefix was computed beforehand, e.g., at compile time by make_const_key()
+        constexpr keydomet_storage(const prefix_rep<PrefixSize>& prefix, const StrImp& s) : prefix_val{prefix}, str{s}
+        {
+            this->cache_length(str);
+        }
+
+        constexpr const prefix_rep<PrefixSize>& prefix() const
+        {
+            return prefix_val;
+        }
+
+        const StrImp& string() const
+        {
+            return str;
+        }
+
+        auto suffix(size_t offset) const
+        {
+            return imp::suffix_of(str, offset);
+        }
+
+    private:
+
+        // using composition instead of inheritance (from str_imp) to make sure
+        // the keydomet is at the beginning of the object rather than at the end
+        prefix_rep<PrefixSize> prefix_val;
+        StrImp str;
+
+    };
+
+    //
+    // Full deduplication - a keydomet<deduplicated<StrT>, ...> is constructed from a StrT (or any other string type
+    // exposing its size), but only stores the characters that aren't encoded in its prefix. The suffix is kept on
+    // the heap, and no heap buffer is used at all by strings not longer than the prefix. As the complete string is
+    // no longer stored, get_str() reconstructs it, returning a StrT by value. Suffixes are limited to 4GB.
+    // Lookups should use view-based find keys, e.g., keydomet<const std::string&, ...>, which make_find_key creates
+    // for containers using transparent comparators.
+    //
+    template<class StrT = std::string>
+    struct deduplicated {};
+
+    namespace imp
+    {
+        template<class StrImp>
+        struct is_deduplicated : std::false_type {};
+
+        template<class StrT>
+        struct is_deduplicated<deduplicated<StrT>> : std::true_type {};
+    }
+
+    template<class StrT, prefix_size PrefixSize, class Encoding>
+    class keydomet_storage<deduplicated<StrT>, PrefixSize, Encoding>
+    {
+
+        static constexpr size_t prefix_len = static_cast<size_t>(PrefixSize);
+
+        static_assert(std::is_same<Encoding, raw_encoding>::value,
+                      "Deduplication reconstructs strings from their prefix, hence requires the raw encoding");
+
+    public:
+
+        template<class SrcStr, class = std::enable_if_t<has_size<SrcStr>::value>>
+        keydomet_storage(const SrcStr& s) : prefix_val{s}
+        {
+            const size_t len = s.size();
+            if (len > prefix_len)
+                set_suffix(get_raw_str(s) + prefix_len, len - prefix_len);
+        }
+
+        keydomet_storage(const keydomet_storage& other) : prefix_val{other.prefix_val}
+        {
+            set_suffix(other.chars.get(), other.suffix_len);
+        }
+
+        keydomet_storage(keydomet_storage&&) noexcept = default;
+
+        keydomet_storage& operator=(const keydomet_storage& other)
+        {
+            if (this != &other)
+            {
+                keydomet_storage copy{other};
+                *this = std::move(copy);
+            }
+            return *this;
+        }
+
+        keydomet_storage& operator=(keydomet_storage&&) noexcept = default;
+
+        const prefix_rep<PrefixSize>& prefix() const
+        {
+            return prefix_val;
+        }
+
+        // reconstructs the complete string
+        StrT string() const
+        {
+            char head[sizeof(typename prefix_rep<PrefixSize>::prefix_type)];
+            prefix_to_chars(prefix_val.get_val(), head);
+            const size_t head_len = suffix_len > 0 ? prefix_len : strnlen(head, prefix_len);
+            StrT res;
+            res.reserve(head_len + suffix_len);
+            res.append(head, head_len);
+            if (suffix_len > 0)
+                res.append(chars.get(), suffix_len);
+            return res;
+        }
+
+        size_t cached_length() const
+        {
+            return suffix_len > 0 ? prefix_len + suffix_len : imp::unknown_length;
+        }
+
+        imp::sized_suffix suffix(size_t offset) const
+        {
+            (void)offset; // always equals prefix_len; only the characters following the prefix are stored
+            return {suffix_len > 0 ? chars.get() : "", suffix_len};
+        }
+
+    private:
+
+        prefix_rep<PrefixSize> prefix_val;
+        uint32_t suffix_len = 0;
+        std::unique_ptr<char[]> chars;
+
+        void set_suffix(const char* suffix, size_t len)
+        {
+            if (len > UINT32_MAX)
+                throw std::length_error("deduplicated suffixes are limited to 4GB");
+            suffix_len = static_cast<uint32_t>(len);
+            if (len > 0)
+            {
+                chars.reset(new char[len]);
+                memcpy(chars.get(), suffix, len);
+            }
+        }
+
+    };
+
+    //
+    // Hash caching - a keydomet<hashed<StrT>, ...> holds a StrT, and caches a 32 bit hash of the whole string next to
+    // its prefix (in the padding, when the prefix is 32 bits or less). Hash containers using kdmt::hash then neither
+    // rehash the strings when rehashing the table, nor read the strings of keys whose hash differs on lookups.
+    //
+    template<class StrT = std::string>
+    struct hashed {};
+
+    namespace imp
+    {
+        inline uint64_t hash_mix(uint64_t h)
+        {
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+        // hashes 8 bytes at a time, mixing the length in - keys are usually too short for fancier hashes to pay off
+        inline uint32_t hash_chars(const char* chars, size_t len)
+        {
+            uint64_t h = 0x9E3779B97F4A7C15ULL ^ len;
+            for (; len >= sizeof(uint64_t); chars += sizeof(uint64_t), len -= sizeof(uint64_t))
+            {
+                uint64_t word;
+                memcpy(&word, chars, sizeof(word));
+                h = (h ^ hash_mix(word)) * 0xC4CEB9FE1A85EC53ULL;
+            }
+            if (len > 0)
+            {
+                uint64_t word = 0;
+                memcpy(&word, chars, len);
+                h = (h ^ hash_mix(word)) * 0xC4CEB9FE1A85EC53ULL;
+            }
+            h = hash_mix(h);
+            return static_cast<uint32_t>(h ^ (h >> 32));
+        }
+
+        template<typename StrT>
+        inline std::enable_if_t<has_size<StrT>::value, uint32_t> hash_str(const StrT& str)
+        {
+            return hash_chars(get_raw_str(str), str.size());
+        }
+
+        template<typename StrT>
+        inline std::enable_if_t<!has_size<StrT>::value, uint32_t> hash_str(const StrT& str)
+        {
+            const char* chars = get_raw_str(str);
+            return hash_chars(chars, strlen(chars));
+        }
+
+        // storages caching the hash provide cached_hash()
+        template<class Storage, class = void>
+        struct caches_hash : std::false_type {};
+
+        template<class Storage>
+        struct caches_hash<Storage, void_t<decltype(std::declval<const Storage&>().cached_hash())>> : std::true_type {};
+
+        template<class Storage1, class Storage2>
+        inline std::enable_if_t<caches_hash<Storage1>::value && caches_hash<Storage2>::value, bool>
+        hashes_differ(const Storage1& s1, const Storage2& s2)
+        {
+            return s1.cached_hash() != s2.cached_hash();
+        }
+
+        template<class Storage1, class Storage2>
+        inline std::enable_if_t<!caches_hash<Storage1>::value || !caches_hash<Storage2>::value, bool>
+        hashes_differ(const Storage1&, const Storage2&)
+        {
+            return false;
+        }
+
+        template<class Storage>
+        inline std::enable_if_t<caches_hash<Storage>::value, uint32_t> hash_of(const Storage& s)
+        {
+            return s.cached_hash();
+        }
+
+        template<class Storage>
+        inline std::enable_if_t<!caches_hash<Storage>::value, uint32_t> hash_of(const Storage& s)
+        {
+            return hash_str(s.string());
+        }
+    }
+
+    template<class StrT, prefix_size PrefixSize, class Encoding>
+    class keydomet_storage<hashed<StrT>, PrefixSize, Encoding>
+    {
+
+        using prefix_type = typename prefix_rep<PrefixSize>::prefix_type;
+
+    public:
+
+        keydomet_storage(const StrT& s) :
+            prefix_val{prefix_rep<PrefixSize>::from_val(Encoding::template encode<prefix_type>(s))},
+            hash_val{imp::hash_str(s)}, str{s}
+        {
+        }
+
+        keydomet_storage(StrT&& s) :
+            prefix_val{prefix_rep<PrefixSize>::from_val(Encoding::template encode<prefix_type>(s))},
+            hash_val{imp::hash_str(s)}, str{std::move(s)}
+        {
+        }
+
+        template<class... Args, class = std::enable_if_t<std::is_constructible<StrT, Args&&...>::value>>
+        explicit keydomet_storage(in_place_t, Args&&... args) : prefix_val{nullptr}, str(std::forward<Args>(args)...)
+        {
+            prefix_val = prefix_rep<PrefixSize>::from_val(Encoding::template encode<prefix_type>(str));
+            hash_val = imp::hash_str(str);
+        }
+
+        const prefix_rep<PrefixSize>& prefix() const
+        {
+            return prefix_val;
+        }
+
+        const StrT& string() const
+        {
+            return str;
+        }
+
+        auto suffix(size_t offset) const
+        {
+            return imp::suffix_of(str, offset);
+        }
+
+        // the padding holds the hash rather than the length
+        size_t cached_length() const
+        {
+            return imp::unknown_length;
+        }
+
+        uint32_t cached_hash() const
+        {
+            return hash_val;
+        }
+
+    private:
+
+        prefix_rep<PrefixSize> prefix_val;
+        uint32_t hash_val;
+        StrT str;
+
+    };
+
+    namespace imp
+    {
+        //
+        // Turns the first characters of a fixed-width key into a number using a single load: the key is known to
+        // have N characters, so there's neither a scan for the NUL nor masking. Keys narrower than the prefix are
+        // zero padded.
+        //
+        template<typename PrefixT, size_t N>
+        inline PrefixT fixed_chars_to_prefix(const char* chars)
+        {
+            PrefixT val{};
+            memcpy(&val, chars, N < sizeof(val) ? N : sizeof(val));
+            flip_bytes(val);
+            return val;
+        }
+
+        template<prefix_size PrefixSize, class Encoding, size_t N>
+        inline std::enable_if_t<std::is_same<Encoding, raw_encoding>::value ||
+                std::is_same<Encoding, binary_encoding>::value, prefix_rep<PrefixSize>> fixed_prefix(const char* chars)
+        {
+            using prefix_type = typename prefix_rep<PrefixSize>::prefix_type;
+            return prefix_rep<PrefixSize>::from_val(fixed_chars_to_prefix<prefix_type, N>(chars));
+        }
+
+        // other encodings don't map characters to bytes, and are given the key as a view
+        template<prefix_size PrefixSize, class Encoding, size_t N>
+        inline std::enable_if_t<!std::is_same<Encoding, raw_encoding>::value &&
+                !std::is_same<Encoding, binary_encoding>::value, prefix_rep<PrefixSize>> fixed_prefix(const char* chars)
+        {
+            using prefix_type = typename prefix_rep<PrefixSize>::prefix_type;
+            return prefix_rep<PrefixSize>::from_val(Encoding::template encode<prefix_type>(chars_view{chars, N}));
+        }
+
+        // the state shared by owning fixed-width keys and the views used to search for them
+        template<class StrImp, size_t N, prefix_size PrefixSize, class Encoding>
+        class fixed_width_storage
+        {
+
+        public:
+
+            const prefix_rep<PrefixSize>& prefix() const
+            {
+                return prefix_val;
+            }
+
+            const std::remove_reference_t<StrImp>& string() const
+            {
+                return str;
+            }
+
+            fixed_suffix<N> suffix(size_t offset) const
+            {
+                // the prefix may be wider than the key
+                return {get_raw_str(str), offset < N ? offset : N};
+            }
+
+            size_t cached_length() const
+            {
+                return N;
+            }
+
+        protected:
+
+            explicit fixed_width_storage(const std::remove_reference_t<StrImp>& s) :
+                prefix_val{fixed_prefix<PrefixSize, Encoding, N>(get_raw_str(s))}, str(s)
+            {
+            }
+
+        private:
+
+            prefix_rep<PrefixSize> prefix_val;
+            StrImp str;
+
+        };
+    }
+
+    //
+    // Fixed-width keys, e.g., tickers or hashes held in a std::array<char, N> (or of unsigned chars/bytes). The
+    // length is known at compile time, so the prefix is taken using a single load, and prefix collisions are
+    // resolved by comparing the keys a word at a time. Keys are exactly N characters long, NULs included: shorter
+    // keys should be NUL padded (as the converting constructors do), and keys that may contain NULs, e.g., hashes,
+    // should use binary_encoding. Lookups use keydomet<const std::array<CharT, N>&, ...> views (see make_find_key).
+    //
+    template<class CharT, size_t N, prefix_size PrefixSize, class Encoding>
+    class keydomet_storage<std::array<CharT, N>, PrefixSize, Encoding> :
+            public imp::fixed_width_storage<std::array<CharT, N>, N, PrefixSize, Encoding>
+    {
+
+        static_assert(sizeof(CharT) == 1, "Fixed-width keys are arrays of characters or bytes");
+
+        using array_type = std::array<CharT, N>;
+        using base = imp::fixed_width_storage<array_type, N, PrefixSize, Encoding>;
+
+    public:
+
+        keydomet_storage(const array_type& s) : base(s)
+        {
+        }
+
+        // copies the characters of any other string type, truncated or NUL padded to N characters
+        template<class SrcStr, class = std::enable_if_t<!std::is_same<SrcStr, array_type>::value>,
+                class = imp::void_t<decltype(get_raw_str(std::declval<const SrcStr&>()))>>
+        explicit keydomet_storage(const SrcStr& s) : base(padded(get_raw_str(s), imp::chars_len(s, N)))
+        {
+        }
+
+        // fixed-width fields, e.g., char ticker[16], need not be NUL terminated
+        template<size_t M>
+        explicit keydomet_storage(const char (&s)[M]) : base(padded(s, strnlen(s, M < N ? M : N)))
+        {
+        }
+
+        explicit keydomet_storage(in_place_t, const char* chars, size_t len) : base(padded(chars, len))
+        {
+        }
+
+        template<class SrcStr, class = imp::void_t<decltype(get_raw_str(std::declval<const SrcStr&>()))>>
+        explicit keydomet_storage(in_place_t, const SrcStr& s) : keydomet_storage(s)
+        {
+        }
+
+    private:
+
+        static array_type padded(const char* chars, size_t len)
+        {
+            array_type arr{};
+            memcpy(arr.data(), chars, len < N ? len : N);
+            return arr;
+        }
+
+    };
+
+    template<class CharT, size_t N, prefix_size PrefixSize, class Encoding>
+    class keydomet_storage<const std::array<CharT, N>&, PrefixSize, Encoding> :
+            public imp::fixed_width_storage<const std::array<CharT, N>&, N, PrefixSize, Encoding>
+    {
+
+        using base = imp::fixed_width_storage<const std::array<CharT, N>&, N, PrefixSize, Encoding>;
+
+    public:
+
+        keydomet_storage(const std::array<CharT, N>& s) : base(s)
+        {
+        }
+
+    };
+
+    template<class StrImp, prefix_size PrefixSize, class Stats = no_stats, class Encoding = raw_encoding>
+    class keydomet
+    {
+
+    public:
+
+        using str_imp = StrImp;
+        static constexpr prefix_size size = PrefixSize;
+        using stats = Stats;
+        using encoding = Encoding;
+
+        keydomet(const str_imp& s) : data{s}
+        {
+        }
+
+        keydomet(std::remove_reference_t<str_imp>&& s) : data{std::move(s)}
+        {
+        }
+
+        // takes a prefix computed beforehand, e.g., at compile time (see make_const_key())
+        constexpr keydomet(const prefix_rep<PrefixSize>& prefix, const str_imp& s) : data{prefix, s}
+        {
+        }
+
+        // constructs the string in place, e.g., keydomet<std::string, ...>{in_place, chars, len}, or using emplace()
+        template<class... Args, class = std::enable_if_t<std::is_constructible<
+                keydomet_storage<StrImp, PrefixSize, Encoding>, in_place_t, Args&&...>::value>>
+        explicit keydomet(in_place_t, Args&&... args) : data(in_place, std::forward<Args>(args)...)
+        {
+        }
+
+        // constructs keydomets whose storage is built from other string types, e.g., deduplicated keydomets
+        template<class SrcStr, class = std::enable_if_t<!std::is_convertible<SrcStr&&, str_imp>::value &&
+                std::is_constructible<keydomet_storage<StrImp, PrefixSize, Encoding>, SrcStr&&>::value>>
+        keydomet(SrcStr&& s) : data{std::forward<SrcStr>(s)}
+        {
+        }
+
+        template<typename OtherImp, prefix_size OtherSize, class OtherStats, class OtherEncoding>
+        friend class keydomet;
+
+        template<typename Imp, class OtherStats>
+        int compare(const keydomet<Imp, PrefixSize, OtherStats, Encoding>& other) const
+        {
+            const prefix_rep<PrefixSize>& this_prefix = getPrefix();
+            const prefix_rep<PrefixSize>& other_prefix = other.getPrefix();
+            if (this_prefix != other_prefix)
+            {
+                Stats::count_prefix();
+                return diff_as_one_or_minus_one(this_prefix, other_prefix);
+            }
+            else
+            {
+                return compare_tied(other, imp::tie_of<Encoding, PrefixSize>(this_prefix.get_val()),
+                                    imp::is_length_aware<Encoding>{});
+            }
+        }
+
+        // compares with a keydomet of another prefix size, using the leading bits both prefixes have
+        template<typename Imp, prefix_size OtherSize, class OtherStats,
+                class = std::enable_if_t<OtherSize != PrefixSize>>
+        int compare(const keydomet<Imp, OtherSize, OtherStats, Encoding>& other) const
+        {
+            constexpr prefix_size CommonSize = static_cast<size_t>(PrefixSize) < static_cast<size_t>(OtherSize) ?
+                    PrefixSize : OtherSize;
+            using common_type = typename prefix_rep<CommonSize>::prefix_type;
+            static_assert(!imp::is_deduplicated<StrImp>::value && !imp::is_deduplicated<Imp>::value,
+                          "Deduplicated keydomets only store the characters following their own prefix");
+            const common_type this_val = imp::narrow_to<Encoding, CommonSize>(getPrefix().get_val());
+            const common_type other_val = imp::narrow_to<Encoding, CommonSize>(other.getPrefix().get_val());
+            if (this_val != other_val)
+            {
+                Stats::count_prefix();
+                return ((int)!(this_val < other_val) << 1) - 1;
+            }
+            return compare_tied(other, imp::tie_of<Encoding, CommonSize>(this_val), imp::is_length_aware<Encoding>{});
+        }
+
+        template<typename Imp, prefix_size OtherSize, class OtherStats>
+        bool operator<(const keydomet<Imp, OtherSize, OtherStats, Encoding>& other) const
+        {
+            return compare(other) < 0;
+        }
+
+        template<typename Imp, prefix_size OtherSize, class OtherStats>
+        bool operator==(const keydomet<Imp, OtherSize, OtherStats, Encoding>& other) const
+        {
+            // strings of different lengths or hashes differ, no matter what their prefixes are
+            const size_t len = data.cached_length(), other_len = other.data.cached_length();
+            if ((len != other_len && len != imp::unknown_length && other_len != imp::unknown_length) ||
+                    imp::hashes_differ(data, other.data))
+            {
+                Stats::count_prefix();
+                return false;
+            }
+            return compare(other) == 0;
+        }
+
+#if KDMT_THREE_WAY
+        // a single compare() yields the order, e.g., for std::ranges algorithms or defaulted comparisons of classes
+        // holding keydomets
+        template<typename Imp, prefix_size OtherSize, class OtherStats>
+        std::strong_ordering operator<=>(const keydomet<Imp, OtherSize, OtherStats, Encoding>& other) const
+        {
+            return compare(other) <=> 0;
+        }
+#endif // KDMT_THREE_WAY
+
+        // returns either a reference or a copy, depending on whether the storage keeps a prefix_rep
+        constexpr decltype(auto) getPrefix() const
+        {
+            return data.prefix();
+        }
+
+        // returns a reference to the string, or a reconstructed copy when the storage doesn't keep it in full
+        decltype(auto) get_str() const
+        {
+            return data.string();
+        }
+
+        // a 32 bit hash of the whole string - cached by keydomet<hashed<StrT>, ...>, computed otherwise
+        uint32_t hash() const
+        {
+            return imp::hash_of(data);
+        }
+
+        // statistics of comparisons made by keydomets using this one's Stats policy
+        static compare_stats get_stats() { return Stats::snapshot(); }
+        static void reset_stats() { Stats::reset(); }
+
+    private:
+
+        keydomet_storage<StrImp, PrefixSize, Encoding> data;
+
+        size_t length() const
+        {
+            const size_t len = data.cached_length();
+            return len != imp::unknown_length ? len : data.string().size();
+        }
+
+        template<typename OtherKeydomet>
+        int compare_tied(const OtherKeydomet& other, tie_info tie, std::false_type) const
+        {
+            if (tie.equal)
+            {
+                Stats::count_prefix();
+                return 0;
+            }
+            Stats::count_string();
+            // both strings are equal up to the offset the encoding vouches for
+            return imp::compare_suffix(data.suffix(tie.offset), other.data.suffix(tie.offset));
+        }
+
+        template<typename OtherKeydomet>
+        int compare_tied(const OtherKeydomet& other, tie_info tie, std::true_type) const
+        {
+            const size_t len = length(), other_len = other.length();
+            if (len < tie.offset || other_len < tie.offset)
+            {
+                // the shorter string ended within the prefix, and the rest of the prefix matched its zero padding,
+                // so it's a prefix of the other string
+                Stats::count_prefix();
+                return (int)(len > other_len) - (int)(len < other_len);
+            }
+            Stats::count_string();
+            return imp::compare_suffix(data.suffix(tie.offset), other.data.suffix(tie.offset));
+        }
+
+        static int diff_as_one_or_minus_one(const prefix_rep<PrefixSize>& v1, const prefix_rep<PrefixSize>& v2)
+        {
+            // return -1 if v1 < v2 and 1 otherwise
+            // this is done without conditional branches and without risking wrap-around
+            return ((int)!(v1 < v2) << 1) - 1;
+        }
+
+    };
+
+    inline std::ostream& operator<<(std::ostream& os, const kdmt128_t& val)
+    {
+        os << val.msbs << val.lsbs;
+        return os;
+    }
+
+    namespace imp
+    {
+        template<class StrT>
+        inline const StrT& printable(const StrT& str)
+        {
+            return str;
+        }
+
+        template<class CharT, size_t N>
+        inline chars_view printable(const std::array<CharT, N>& str)
+        {
+            return {get_raw_str(str), N};
+        }
+    }
+
+    template<typename StrImp, prefix_size Size, class Stats, class Encoding>
+    inline std::ostream& operator<<(std::ostream& os, const keydomet<StrImp, Size, Stats, Encoding>& hk)
+    {
+        os << imp::printable(hk.get_str());
+        return os;
+    }
+
+    //
+    // Hash container helpers: std::unordered_set<keydomet<hashed<std::string>, ...>, kdmt::hash, kdmt::equal_to>.
+    // The equality check compares the prefixes, lengths and hashes available within the keydomets before the strings.
+    //
+    struct hash
+    {
+        template<typename StrImp, prefix_size Size, class Stats, class Encoding>
+        size_t operator()(const keydomet<StrImp, Size, Stats, Encoding>& k) const
+        {
+            return k.hash();
+        }
+    };
+
+    struct equal_to
+    {
+        using is_transparent = void;
+
+        template<typename Keydomet1, typename Keydomet2>
+        bool operator()(const Keydomet1& k1, const Keydomet2& k2) const
+        {
+            return k1 == k2;
+        }
+    };
+
+    namespace imp
+    {
+        // Searching associative containers (namely, sorted rather than hashed) could only be done using
+        // the exact key type till C++14. From C++14, any type that can be compared with the key type can
+        // be used. For instance, a std::string_view can be used in order to find a std::string key.
+        // this is very useful when a key is given as a std::string but a keydomet should be constructed
+        // in order to do the lookup: instead of creating a keydomet that will own a copy of the std::string
+        // (with all the mess involved with the creation of the copy - allocation etc.), a keydomet holding a
+        // const string reference is used, merely referencing the original std::string.
+        // To use the above feature, the comparator used by the container must be transparent, namely have
+        // a is_transparent member. The code below detects the presence of that member, and the result is
+        // used to determine whether a keydomet or KeydometView should be constructed for lookups.
+        struct non_transparent {};
+
+        auto get_comparator(...) -> non_transparent;
+
+        template<template<class, class...> class Container, class KD, class... Args>
+        auto get_comparator(const Container<KD, Args...>&) -> typename Container<KD, Args...>::key_compare;
+
+        template<class Comparator, class = void_t<>>
+        struct has_transparent_flag_helper : std::false_type {};
+
+        template<class Comparator>
+        struct has_transparent_flag_helper<Comparator, void_t<typename Comparator::is_transparent>> : std::true_type {};
+
+        template<template<class, class...> class Container, class KD, class... Args>
+        auto is_transparent(const Container<KD, Args...>& c) ->
+        std::enable_if_t<has_transparent_flag_helper<decltype(get_comparator(c))>::value, std::true_type>;
+
+        auto is_transparent(...) -> std::false_type;
+
+        template<class IsTrans>
+        void verify_container_uses_transparent_comperator()
+        {
+            // Containers such as map and set should use /transparent comparators/, which allow keys of different types
+            // to be compared. This eliminates the need to create owning keydomet objects.
+            // Easiest way to do it: use the std::less<> comparator - std::set<KdmtStr, std::less<>>;
+            IsTrans::CheckOutCommentAboveMe();
+        }
+
+        template<>
+        inline void verify_container_uses_transparent_comperator<std::true_type>() {}
+    }
+
+    template<class KeyT, template<class, class...> class Container, class StrT, prefix_size Size, class Stats,
+            class Encoding, class... Args, class = std::enable_if_t<!std::is_array<KeyT>::value &&
+                    !std::is_pointer<KeyT>::value>>
+    inline auto make_find_key(const Container<keydomet<StrT, Size, Stats, Encoding>, Args...>& s, const KeyT& key)
+    {
+        // associative containers (maps, sets) can use a transparent comparator. such a comperator can
+        // compare the internal key type with other types (as long as there's an appropriate operator).
+        // this allows such containers to hold keydomet<string> but search using keydomet<const string&>, saving the allocation.
+        // the key need not be of the container's string type, e.g., a std::string can be used to search
+        // a container of keydomet<kstring>.
+        // *** Note: to make a container associative, define it with the less<> comparator:
+        // *** using keydomet_set = std::set<kdmt_str, std::less<>>;
+        using keydomet_str_type = std::conditional_t<decltype(imp::is_transparent(s))::value,
+                keydomet<const KeyT&, Size, Stats, Encoding>,
+                keydomet<StrT, Size, Stats, Encoding>
         >;
         imp::verify_container_uses_transparent_comperator<decltype(imp::is_transparent(s))>();
         return keydomet_str_type{key};
     }
 
+    //
+    // Find keys viewing the given characters, for containers using transparent comparators. Neither a string nor
+    // a copy of the characters is made, so the characters must outlive the find key.
+    //
+    template<template<class, class...> class Container, class StrT, prefix_size Size, class Stats, class Encoding,
+            class... Args>
+    inline auto make_find_key(const Container<keydomet<StrT, Size, Stats, Encoding>, Args...>& s, const char* key)
+    {
+        imp::verify_container_uses_transparent_comperator<decltype(imp::is_transparent(s))>();
+        return keydomet<const char*, Size, Stats, Encoding>{key};
+    }
+
+    template<template<class, class...> class Container, class StrT, prefix_size Size, class Stats, class Encoding,
+            class... Args>
+    inline auto make_find_key(const Container<keydomet<StrT, Size, Stats, Encoding>, Args...>& s,
+                              const char* key, size_t len)
+    {
+        imp::verify_container_uses_transparent_comperator<decltype(imp::is_transparent(s))>();
+        return keydomet<chars_view, Size, Stats, Encoding>{chars_view{key, len}};
+    }
+
+    namespace imp
+    {
+        template<prefix_size Size, class Stats, class Encoding>
+        constexpr keydomet<chars_view, Size, Stats, Encoding> make_const_key(const char* str, size_t len)
+        {
+            static_assert(std::is_same<Encoding, raw_encoding>::value || std::is_same<Encoding, binary_encoding>::value,
+                          "Constant keys are supported by the raw and binary encodings");
+            using prefix_type = typename prefix_storage<Size>::type;
+            constexpr size_t prefix_len = static_cast<size_t>(Size);
+            const prefix_type val = const_chars_to_prefix<prefix_type>(str, len < prefix_len ? len : prefix_len);
+            return {prefix_rep<Size>::from_const_val(val), chars_view{str, len}};
+        }
+    }
+
+    //
+    // Constant keys, e.g., make_const_key<kdmt_str>("GET"), whose prefix is computed at compile time. The key views
+    // the string literal, and can search containers of KeydometT, or of any keydomet using the same encoding.
+    //
+    template<class KeydometT, size_t N>
+    constexpr auto make_const_key(const char (&str)[N])
+    {
+        return imp::make_const_key<KeydometT::size, typename KeydometT::stats, typename KeydometT::encoding>(str, N - 1);
+    }
+
+    //
+    // Searches using a single compare() per visited key. std::set::find and std::binary_search use operator<, so
+    // the key equal to the searched one is compared twice (once each way), and when its prefix collides, both
+    // comparisons fall back to the strings. These helpers branch on the three-way result instead.
+    //
+
+    // the first key in the sorted range that isn't less than the given one
+    template<class RandomIt, class StrImp, prefix_size Size, class Stats, class Encoding>
+    inline RandomIt lower_bound(RandomIt first, RandomIt last, const keydomet<StrImp, Size, Stats, Encoding>& key)
+    {
+        auto len = last - first;
+        while (len > 0)
+        {
+            const auto half = len / 2;
+            const RandomIt mid = first + half;
+            if (mid->compare(key) < 0)
+            {
+                first = mid + 1;
+                len -= half + 1;
+            }
+            else
+            {
+                len = half;
+            }
+        }
+        return first;
+    }
+
+    // a key of the sorted range equal to the given one, or last. The search stops at the first equal key it
+    // visits, which isn't necessarily the first of several equal keys.
+    template<class RandomIt, class StrImp, prefix_size Size, class Stats, class Encoding>
+    inline RandomIt binary_find(RandomIt first, RandomIt last, const keydomet<StrImp, Size, Stats, Encoding>& key)
+    {
+        auto len = last - first;
+        while (len > 0)
+        {
+            const auto half = len / 2;
+            const RandomIt mid = first + half;
+            const int res = mid->compare(key);
+            if (res == 0)
+                return mid;
+            if (res < 0)
+            {
+                first = mid + 1;
+                len -= half + 1;
+            }
+            else
+            {
+                len = half;
+            }
+        }
+        return last;
+    }
+
+    namespace imp
+    {
+        struct tie_bound
+        {
+            size_t pos;
+            bool equal;
+        };
+
+        //
+        // Resolves a prefix tie: the first key of the sorted range has the given key's prefix, and the position of
+        // the first key not less than the given one is looked for. Many keys may share the prefix (e.g., keys with
+        // a common head), so the keys are visited in exponentially growing steps and then binary searched, rather
+        // than scanned. Keys past the tied ones are told apart using their prefixes only.
+        //
+        template<class RandomIt, class KeyT>
+        inline tie_bound lower_tied(RandomIt first, RandomIt last, const KeyT& key)
+        {
+            const size_t len = static_cast<size_t>(last - first);
+            int cmp = first->compare(key);
+            if (cmp >= 0)
+                return {0, cmp == 0};
+            // the key at low is less than the given one, the one at high (if any) isn't
+            size_t low = 0;
+            size_t high = len;
+            cmp = 1;
+            for (size_t step = 1; step < len - low; step *= 2)
+            {
+                const int res = first[low + step].compare(key);
+                if (res >= 0)
+                {
+                    high = low + step;
+                    cmp = res;
+                    break;
+                }
+                low += step;
+            }
+            while (high - low > 1)
+            {
+                const size_t mid = low + (high - low) / 2;
+                const int res = first[mid].compare(key);
+                if (res >= 0)
+                {
+                    high = mid;
+                    cmp = res;
+                }
+                else
+                {
+                    low = mid;
+                }
+            }
+            return {high, high < len && cmp == 0};
+        }
+    }
+
+    namespace imp
+    {
+        //
+        // The key given to an associative container's lower_bound() by find(). The container compares it with
+        // its keys using operator<, and the probe remembers the key that compared equal, so the key lower_bound()
+        // returns needn't be compared again.
+        //
+        template<class KeydometT>
+        class find_probe
+        {
+
+        public:
+
+            explicit find_probe(const KeydometT& key_) : key{key_} {}
+
+            template<class OtherT>
+            int compare(const OtherT& other) const
+            {
+                const int res = other.compare(key);
+                if (res == 0)
+                    matched = &other;
+                return res;
+            }
+
+            bool matched_by(const void* other) const
+            {
+                return other == matched;
+            }
+
+        private:
+
+            const KeydometT& key;
+            mutable const void* matched = nullptr;
+
+        };
+
+        template<class StrImp, prefix_size Size, class Stats, class Encoding, class KeydometT>
+        inline bool operator<(const keydomet<StrImp, Size, Stats, Encoding>& other, const find_probe<KeydometT>& probe)
+        {
+            return probe.compare(other) < 0;
+        }
+
+        template<class StrImp, prefix_size Size, class Stats, class Encoding, class KeydometT>
+        inline bool operator<(const find_probe<KeydometT>& probe, const keydomet<StrImp, Size, Stats, Encoding>& other)
+        {
+            return probe.compare(other) > 0;
+        }
+
+        // the key of a set's or a map's element
+        template<class StrImp, prefix_size Size, class Stats, class Encoding>
+        inline const void* key_address(const keydomet<StrImp, Size, Stats, Encoding>& key)
+        {
+            return &key;
+        }
+
+        template<class KeyT, class ValueT>
+        inline const void* key_address(const std::pair<const KeyT, ValueT>& elem)
+        {
+            return &elem.first;
+        }
+    }
+
+    //
+    // Finds the given key in an associative container of keydomets using a transparent comparator (e.g., a
+    // std::set or a std::map using std::less<>), comparing each key visited once. The key is usually made by
+    // make_find_key().
+    //
+    template<class Container, class StrImp, prefix_size Size, class Stats, class Encoding>
+    inline auto find(Container& c, const keydomet<StrImp, Size, Stats, Encoding>& key)
+    {
+        imp::verify_container_uses_transparent_comperator<decltype(imp::is_transparent(c))>();
+        const imp::find_probe<keydomet<StrImp, Size, Stats, Encoding>> probe{key};
+        auto iter = c.lower_bound(probe);
+        return iter != c.end() && probe.matched_by(imp::key_address(*iter)) ? iter : c.end();
+    }
+
+    namespace literals
+    {
+        // "GET"_kdmt - a constant key using a 32 bit prefix and the raw encoding
+        constexpr keydomet<chars_view, prefix_size::SIZE_32BIT> operator""_kdmt(const char* str, size_t len)
+        {
+            return imp::make_const_key<prefix_size::SIZE_32BIT, no_stats, raw_encoding>(str, len);
+        }
+    }
+
 }
 
 #endif //KEYDOMET_KEYDOMET_H
@@ -0,0 +1,295 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef KEYDOMET_KSTRING_H
+#define KEYDOMET_KSTRING_H
+
+#include "Keydomet.h"
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+
+namespace kdmt
+{
+
+    //
+    // An immutable owning string, which is as small as a std::string (32B) yet carries a 64 bit keydomet.
+    // Short strings are stored inline, zero padded, hence their first 8 bytes are also their prefix.
+    // Long strings are stored on the heap, and the inline buffer they leave unused holds a copy of
+    // their first 8 characters. Either way, the prefix is obtained using a single load from the object,
+    // so keydomet<kstring, ...> doesn't need to store a prefix of its own.
+    //
+    class kstring
+    {
+
+    public:
+
+        using prefix_type = typename prefix_storage<prefix_size::SIZE_64BIT>::type;
+
+        static constexpr size_t short_capacity = 30;
+
+        kstring() noexcept
+        {
+            set_short(nullptr, 0);
+        }
+
+        kstring(const char* str) : kstring(str, strlen(str))
+        {
+        }
+
+        kstring(const std::string& str) : kstring(str.data(), str.size())
+        {
+        }
+
+        kstring(const char* str, size_t len)
+        {
+            if (len <= short_capacity)
+                set_short(str, len);
+            else
+                set_long(str, len);
+        }
+
+        kstring(const kstring& other)
+        {
+            if (other.is_inline())
+                copy_rep(other);
+            else
+                set_long(other.heap_ptr(), other.heap_size());
+        }
+
+        kstring(kstring&& other) noexcept
+        {
+            copy_rep(other);
+            other.set_short(nullptr, 0);
+        }
+
+        kstring& operator=(const kstring& other)
+        {
+            if (this != &other)
+            {
+                kstring copy{other};
+                swap(copy);
+            }
+            return *this;
+        }
+
+        kstring& operator=(kstring&& other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+
+        ~kstring()
+        {
+            if (!is_inline())
+                delete[] heap_ptr();
+        }
+
+        void swap(kstring& other) noexcept
+        {
+            kstring tmp;
+            tmp.copy_rep(*this);
+            copy_rep(other);
+            other.copy_rep(tmp);
+            tmp.set_short(nullptr, 0); // tmp's content (if on the heap) is now owned by other
+        }
+
+        const char* data() const noexcept
+        {
+            return is_inline() ? rep : heap_ptr();
+        }
+
+        const char* c_str() const noexcept
+        {
+            return data();
+        }
+
+        size_t size() const noexcept
+        {
+            return is_inline() ? tag : heap_size();
+        }
+
+        size_t length() const noexcept
+        {
+            return size();
+        }
+
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        // whether the characters are stored within the object (no heap buffer)
+        bool is_inline() const noexcept
+        {
+            return tag != long_tag;
+        }
+
+        // the first 8 characters as a (native order) number, zero padded if the string is shorter
+        prefix_type prefix() const noexcept
+        {
+            prefix_type val;
+            memcpy(&val, rep, sizeof(val));
+            flip_bytes(val);
+            return val;
+        }
+
+        std::string str() const
+        {
+            return {data(), size()};
+        }
+
+        int compare(const kstring& other) const noexcept
+        {
+            const prefix_type this_prefix = prefix(), other_prefix = other.prefix();
+            if (this_prefix != other_prefix)
+                return ((int)!(this_prefix < other_prefix) << 1) - 1;
+            const size_t len1 = size(), len2 = other.size();
+            const size_t common = len1 < len2 ? len1 : len2;
+            const size_t offset = common < sizeof(prefix_type) ? common : sizeof(prefix_type);
+            const int res = memcmp(data() + offset, other.data() + offset, common - offset);
+            if (res != 0)
+                return res;
+            return (int)(len1 > len2) - (int)(len1 < len2);
+        }
+
+        bool operator<(const kstring& other) const noexcept
+        {
+            return compare(other) < 0;
+        }
+
+        bool operator==(const kstring& other) const noexcept
+        {
+            return size() == other.size() && compare(other) == 0;
+        }
+
+        bool operator!=(const kstring& other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+    private:
+
+        // short strings: rep holds the characters, NUL terminated and zero padded, and tag holds the length.
+        // long strings: rep holds the first 8 characters, then the heap pointer and then the length,
+        //               and tag is set to long_tag.
+        static constexpr unsigned char long_tag = 0xFF;
+        static constexpr size_t ptr_offset = sizeof(prefix_type);
+        static constexpr size_t size_offset = ptr_offset + sizeof(char*);
+
+        alignas(8) char rep[short_capacity + 1];
+        unsigned char tag;
+
+        void copy_rep(const kstring& other) noexcept
+        {
+            memcpy(rep, other.rep, sizeof(rep));
+            tag = other.tag;
+        }
+
+        void set_short(const char* str, size_t len) noexcept
+        {
+            memset(rep, 0, sizeof(rep));
+            if (len > 0)
+                memcpy(rep, str, len);
+            tag = (unsigned char)len;
+        }
+
+        void set_long(const char* str, size_t len)
+        {
+            char* buf = new char[len + 1];
+            memcpy(buf, str, len);
+            buf[len] = '\0';
+            memset(rep, 0, sizeof(rep));
+            memcpy(rep, str, sizeof(prefix_type));
+            memcpy(rep + ptr_offset, &buf, sizeof(buf));
+            memcpy(rep + size_offset, &len, sizeof(len));
+            tag = long_tag;
+        }
+
+        const char* heap_ptr() const noexcept
+        {
+            const char* ptr;
+            memcpy(&ptr, rep + ptr_offset, sizeof(ptr));
+            return ptr;
+        }
+
+        size_t heap_size() const noexcept
+        {
+            size_t len;
+            memcpy(&len, rep + size_offset, sizeof(len));
+            return len;
+        }
+
+    };
+
+    static_assert(sizeof(kstring) == 32, "kstring is expected to be as small as a std::string");
+
+    inline std::ostream& operator<<(std::ostream& os, const kstring& str)
+    {
+        os.write(str.data(), str.size());
+        return os;
+    }
+
+    //
+    // A keydomet over a kstring takes its prefix from the string object itself, hence
+    // keydomet<kstring, ...> is no larger than the kstring. Prefixes of up to 64 bits are supported.
+    //
+    template<prefix_size PrefixSize>
+    class keydomet_storage<kstring, PrefixSize, raw_encoding>
+    {
+
+        using prefix_type = typename prefix_rep<PrefixSize>::prefix_type;
+
+        static_assert(sizeof(prefix_type) <= sizeof(kstring::prefix_type), "kstring caches up to 64 bits of prefix");
+
+    public:
+
+        keydomet_storage(const kstring& s) : str{s}
+        {
+        }
+
+        keydomet_storage(kstring&& s) noexcept : str{std::move(s)}
+        {
+        }
+
+        template<class... Args, class = std::enable_if_t<std::is_constructible<kstring, Args&&...>::value>>
+        explicit keydomet_storage(in_place_t, Args&&... args) : str(std::forward<Args>(args)...)
+        {
+        }
+
+        prefix_rep<PrefixSize> prefix() const
+        {
+            constexpr size_t shift = 8 * (sizeof(kstring::prefix_type) - sizeof(prefix_type));
+            return prefix_rep<PrefixSize>::from_val(static_cast<prefix_type>(str.prefix() >> shift));
+        }
+
+        const kstring& string() const
+        {
+            return str;
+        }
+
+        size_t cached_length() const
+        {
+            return str.size();
+        }
+
+        imp::sized_suffix suffix(size_t offset) const
+        {
+            return imp::suffix_of(str, offset);
+        }
+
+    private:
+
+        kstring str;
+
+    };
+
+}
+
+#endif //KEYDOMET_KSTRING_H
@@ -0,0 +1,371 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef KEYDOMET_LEARNEDINDEX_H
+#define KEYDOMET_LEARNEDINDEX_H
+
+#include "Keydomet.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+namespace kdmt
+{
+
+    enum class learned_search
+    {
+        model,        // a two stage model predicts a window of positions, which is then searched
+        interpolation // interpolation search, for prefixes which are about uniformly distributed
+    };
+
+    // the size and accuracy of a learned_index's model
+    struct learned_index_metrics
+    {
+        size_t leaf_models;  // the number of second stage models
+        size_t model_bytes;  // the memory taken by the models, not counting the prefixes
+        size_t max_window;   // the widest window searched for the prefixes of the keys
+        double mean_error;   // the mean distance of the predicted positions from the keys' positions
+    };
+
+    namespace imp
+    {
+        inline double prefix_to_double(uint16_t prefix) { return prefix; }
+        inline double prefix_to_double(uint32_t prefix) { return prefix; }
+        inline double prefix_to_double(uint64_t prefix) { return static_cast<double>(prefix); }
+
+        inline double prefix_to_double(const kdmt128_t& prefix)
+        {
+            return std::ldexp(static_cast<double>(prefix.msbs), 64) + static_cast<double>(prefix.lsbs);
+        }
+
+        struct linear_model
+        {
+            double slope = 0;
+            double intercept = 0;
+
+            double operator()(double x) const
+            {
+                return slope * x + intercept;
+            }
+
+            // a least squares fit of the positions to the values
+            static linear_model fit(const double* xs, const double* ys, size_t num)
+            {
+                linear_model model;
+                if (num == 0)
+                    return model;
+                double x_mean = 0, y_mean = 0;
+                for (size_t i = 0; i < num; ++i)
+                {
+                    x_mean += xs[i];
+                    y_mean += ys[i];
+                }
+                x_mean /= num;
+                y_mean /= num;
+                double cov = 0, var = 0;
+                for (size_t i = 0; i < num; ++i)
+                {
+                    cov += (xs[i] - x_mean) * (ys[i] - y_mean);
+                    var += (xs[i] - x_mean) * (xs[i] - x_mean);
+                }
+                // the positions grow along with the values, so the slope is kept non-negative
+                model.slope = var > 0 && cov > 0 ? cov / var : 0;
+                model.intercept = y_mean - model.slope * x_mean;
+                return model;
+            }
+        };
+    }
+
+    //
+    // A learned index of a sorted range of keydomets, which models the distribution of their prefixes (viewed as
+    // numbers) to predict where a key is, rather than searching the whole range (see "The Case for Learned Index
+    // Structures", Kraska et al., 2018). A root linear model picks one of the leaf linear models, whose prediction
+    // is searched within the window its training errors bound. Keys that weren't trained on may fall outside the
+    // window, in which case the search is extended. Alternatively, learned_search::interpolation uses no model,
+    // and is suited for prefixes that are about uniformly distributed, e.g., of random keys or hashes.
+    // The prefixes are copied into an array of their own, and prefix ties are resolved using the keys of the
+    // range, which must outlive the index and not change. Positions within the range are returned; as the leaf
+    // models bound their windows using 32 bit offsets, the range is limited to 4G keys.
+    //
+    template<class RandomIt>
+    class learned_index
+    {
+
+        using keydomet_type = std::decay_t<decltype(*std::declval<RandomIt>())>;
+        using prefix_type = typename prefix_rep<keydomet_type::size>::prefix_type;
+        using stats = typename keydomet_type::stats;
+
+        static constexpr size_t default_keys_per_leaf = 64;
+        // windows this short are scanned rather than searched
+        static constexpr size_t scan_len = 64 / sizeof(prefix_type);
+
+        struct leaf_model
+        {
+            imp::linear_model model;
+            // the keys' positions are within [predicted - below, predicted + above]
+            uint32_t below;
+            uint32_t above;
+        };
+
+    public:
+
+        // leaf_models is the number of second stage models, where 0 picks one per 64 keys
+        learned_index(RandomIt first, RandomIt last, learned_search search_type = learned_search::model,
+                      size_t leaf_models = 0) :
+            keys{first}, keys_num{static_cast<size_t>(std::distance(first, last))}, search_type{search_type}
+        {
+            if (keys_num > UINT32_MAX)
+                throw std::length_error("Learned indexes hold up to 4G keys");
+            prefixes.reserve(keys_num);
+            for (RandomIt key = first; key != last; ++key)
+                prefixes.push_back(key->getPrefix().get_val());
+            if (search_type == learned_search::model)
+                train(leaf_models != 0 ? leaf_models : std::max<size_t>(1, keys_num / default_keys_per_leaf));
+        }
+
+        size_t size() const
+        {
+            return keys_num;
+        }
+
+        learned_index_metrics metrics() const
+        {
+            size_t max_window = 0;
+            for (const leaf_model& leaf : leaves)
+                max_window = std::max<size_t>(max_window, size_t{leaf.below} + leaf.above + 1);
+            const size_t model_bytes = leaves.empty() ? 0 : sizeof(root) + leaves.size() * sizeof(leaf_model);
+            return {leaves.size(), model_bytes, max_window, mean_error};
+        }
+
+        // the position of the first key not smaller than the given one, or size() if there's none. The key may be
+        // any keydomet of the same prefix size and encoding, e.g., a keydomet<const std::string&, ...>
+        template<class KeyT>
+        size_t lower_bound(const KeyT& key) const
+        {
+            return search(key).pos;
+        }
+
+        // the position of a key equal to the given one, or size() if there's none
+        template<class KeyT>
+        size_t find(const KeyT& key) const
+        {
+            const position p = search(key);
+            return p.equal ? p.pos : keys_num;
+        }
+
+        template<class KeyT>
+        bool contains(const KeyT& key) const
+        {
+            return search(key).equal;
+        }
+
+    private:
+
+        RandomIt keys;
+        size_t keys_num;
+        learned_search search_type;
+        std::vector<prefix_type> prefixes;
+        imp::linear_model root;
+        std::vector<leaf_model> leaves;
+        double mean_error = 0;
+
+        struct position
+        {
+            size_t pos;
+            bool equal;
+        };
+
+        size_t leaf_of(double x) const
+        {
+            const double leaf = std::floor(root(x));
+            return leaf <= 0 ? 0 : std::min(leaves.size() - 1, static_cast<size_t>(std::min(leaf, 1e18)));
+        }
+
+        // the predicted position, clamped to [-1, keys_num + 1]
+        static int64_t clamp_position(double pos, size_t keys_num)
+        {
+            const double clamped = std::max(-1.0, std::min(std::floor(pos), static_cast<double>(keys_num) + 1));
+            return static_cast<int64_t>(clamped);
+        }
+
+        void train(size_t leaf_models)
+        {
+            // each prefix is trained to its first position, which is the lower bound of keys of that prefix
+            std::vector<double> xs(keys_num), ys(keys_num), leaf_ys(keys_num);
+            for (size_t i = 0; i < keys_num; ++i)
+            {
+                xs[i] = imp::prefix_to_double(prefixes[i]);
+                ys[i] = i > 0 && prefixes[i] == prefixes[i - 1] ? ys[i - 1] : static_cast<double>(i);
+                leaf_ys[i] = static_cast<double>(i) * leaf_models / std::max<size_t>(1, keys_num);
+            }
+            root = imp::linear_model::fit(xs.data(), leaf_ys.data(), keys_num);
+            leaves.assign(leaf_models, leaf_model{});
+            // the root model is monotonic, so each leaf is trained using a consecutive range of keys
+            double errors_sum = 0;
+            size_t begin = 0;
+            for (size_t leaf = 0; leaf < leaf_models; ++leaf)
+            {
+                size_t end = begin;
+                while (end < keys_num && leaf_of(xs[end]) == leaf)
+                    ++end;
+                leaf_model& model = leaves[leaf];
+                model.model = imp::linear_model::fit(xs.data() + begin, ys.data() + begin, end - begin);
+                if (begin == end)
+                    model.model.intercept = static_cast<double>(begin);
+                int64_t below = 0, above = 0;
+                for (size_t i = begin; i < end; ++i)
+                {
+                    const int64_t predicted = clamp_position(model.model(xs[i]), keys_num);
+                    const int64_t error = static_cast<int64_t>(ys[i]) - predicted;
+                    below = std::max(below, -error);
+                    above = std::max(above, error);
+                    errors_sum += static_cast<double>(error < 0 ? -error : error);
+                }
+                model.below = static_cast<uint32_t>(below);
+                model.above = static_cast<uint32_t>(above);
+                begin = end;
+            }
+            mean_error = keys_num > 0 ? errors_sum / keys_num : 0;
+        }
+
+        template<class KeyT>
+        position search(const KeyT& key) const
+        {
+            static_assert(KeyT::size == keydomet_type::size &&
+                          std::is_same<typename KeyT::encoding, typename keydomet_type::encoding>::value,
+                          "Learned indexes are searched using keys of their own prefix size and encoding");
+            const prefix_type prefix = key.getPrefix().get_val();
+            const size_t pos = search_type == learned_search::model ? model_search(prefix) :
+                                                                      interpolation_search(prefix);
+            if (pos == keys_num || !(prefixes[pos] == prefix))
+            {
+                stats::count_prefix();
+                return {pos, false};
+            }
+            // a model sees keys sharing a prefix as one number, so it can't place the key among them - their strings
+            // do, starting from the first of them the window search found
+            const imp::tie_bound tie = imp::lower_tied(keys + pos, keys + keys_num, key);
+            return {pos + tie.pos, tie.equal};
+        }
+
+        size_t model_search(const prefix_type& prefix) const
+        {
+            const double x = imp::prefix_to_double(prefix);
+            const leaf_model& leaf = leaves[leaf_of(x)];
+            const int64_t predicted = clamp_position(leaf.model(x), keys_num);
+            const int64_t last = static_cast<int64_t>(keys_num);
+            size_t low = static_cast<size_t>(std::max<int64_t>(0, std::min(last, predicted - leaf.below)));
+            size_t high = static_cast<size_t>(std::max<int64_t>(0, std::min(last, predicted + leaf.above + 1)));
+            // the lower bound of prefixes not trained on may be outside the window, which is then extended
+            if (low > 0 && !(prefixes[low - 1] < prefix))
+            {
+                const size_t bound = low;
+                low = extend_below(prefix, low);
+                high = bound;
+            }
+            else if (high < keys_num && prefixes[high] < prefix)
+            {
+                const size_t bound = high + 1;
+                high = extend_above(prefix, high);
+                low = bound;
+            }
+            return bounded_search(prefix, low, high);
+        }
+
+        // exponentially growing steps, till a prefix smaller than the given one (or the range's start) is reached
+        size_t extend_below(const prefix_type& prefix, size_t pos) const
+        {
+            for (size_t step = 1; pos > 0; step *= 2)
+            {
+                const size_t next = pos > step ? pos - step : 0;
+                if (prefixes[next] < prefix)
+                    return next + 1;
+                pos = next;
+            }
+            return 0;
+        }
+
+        // exponentially growing steps, till a prefix not smaller than the given one (or the range's end) is reached
+        size_t extend_above(const prefix_type& prefix, size_t pos) const
+        {
+            for (size_t step = 1; pos < keys_num; step *= 2)
+            {
+                const size_t next = std::min(keys_num, pos + step);
+                if (next == keys_num || !(prefixes[next] < prefix))
+                    return next;
+                pos = next;
+            }
+            return keys_num;
+        }
+
+        size_t interpolation_search(const prefix_type& prefix) const
+        {
+            // the lower bound is within [low, high]
+            size_t low = 0, high = keys_num;
+            const double x = imp::prefix_to_double(prefix);
+            // skewed prefixes are searched using a few interpolation steps only, and a binary search then
+            for (size_t steps = 0; high - low > scan_len && steps < 4; ++steps)
+            {
+                if (!(prefixes[low] < prefix))
+                    return low;
+                if (prefixes[high - 1] < prefix)
+                    return high;
+                const double low_x = imp::prefix_to_double(prefixes[low]);
+                const double high_x = imp::prefix_to_double(prefixes[high - 1]);
+                const double fraction = high_x > low_x ? (x - low_x) / (high_x - low_x) : 0;
+                const size_t mid = low + std::min(high - low - 1,
+                                                  static_cast<size_t>(fraction * static_cast<double>(high - 1 - low)));
+                if (prefixes[mid] < prefix)
+                    low = mid + 1;
+                else
+                    high = mid;
+            }
+            return bounded_search(prefix, low, high);
+        }
+
+        // the lower bound of the prefix, known to be within [low, high]
+        size_t bounded_search(const prefix_type& prefix, size_t low, size_t high) const
+        {
+            const prefix_type* base = prefixes.data() + low;
+            size_t len = high - low;
+            while (len > scan_len)
+            {
+                const size_t half = len / 2;
+                base = base[half] < prefix ? base + half : base;
+                len -= half;
+            }
+            size_t smaller = 0;
+            for (size_t i = 0; i < len; ++i)
+                smaller += base[i] < prefix ? 1 : 0;
+            return static_cast<size_t>(base - prefixes.data()) + smaller;
+        }
+
+    };
+
+    template<class RandomIt>
+    learned_index<RandomIt> make_learned_index(RandomIt first, RandomIt last,
+                                               learned_search search_type = learned_search::model,
+                                               size_t leaf_models = 0)
+    {
+        return {first, last, search_type, leaf_models};
+    }
+
+    // trains a learned index on all the keys of a sorted container, e.g., a std::vector of keydomets
+    template<class Container>
+    auto make_learned_index(const Container& keys, learned_search search_type = learned_search::model,
+                            size_t leaf_models = 0)
+    {
+        return make_learned_index(std::begin(keys), std::end(keys), search_type, leaf_models);
+    }
+
+}
+
+#endif //KEYDOMET_LEARNEDINDEX_H
@@ -0,0 +1,1300 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef KEYDOMET_RADIXTREE_H
+#define KEYDOMET_RADIXTREE_H
+
+#include "Keydomet.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+#include <initializer_list>
+
+namespace kdmt
+{
+
+    namespace imp
+    {
+        template<class KeydometT>
+        struct art_set_policy
+        {
+            using key_type = KeydometT;
+            using value_type = KeydometT;
+
+            static const key_type& key(const value_type& v)
+            {
+                return v;
+            }
+
+            static const value_type& value(const value_type& v)
+            {
+                return v;
+            }
+        };
+
+        template<class KeydometT, class T>
+        struct art_map_policy
+        {
+            using key_type = KeydometT;
+            using mapped_type = T;
+            using value_type = std::pair<const KeydometT, T>;
+
+            static const key_type& key(const value_type& v)
+            {
+                return v.first;
+            }
+
+            static value_type& value(value_type& v)
+            {
+                return v;
+            }
+        };
+
+        template<class T>
+        struct is_keydomet : std::false_type {};
+
+        template<class StrImp, prefix_size Size, class Stats, class Encoding>
+        struct is_keydomet<keydomet<StrImp, Size, Stats, Encoding>> : std::true_type {};
+
+        //
+        // The bytes of a key, as a radix tree reads them: the first PrefixBytes are taken from its prefix, which is
+        // already loaded, and only the following ones from its string. Each byte is still branched on by its own
+        // node (or compressed path), as are the string's.
+        //
+        template<class PrefixT, size_t PrefixBytes>
+        struct art_key
+        {
+            PrefixT prefix;
+            const unsigned char* chars;
+            size_t len;
+
+            // pos < len
+            unsigned char operator[](size_t pos) const
+            {
+                return pos < PrefixBytes ? prefix_byte(prefix, pos) : chars[pos];
+            }
+        };
+
+        enum class art_kind : uint8_t { leaf, node4, node16, node48, node256 };
+
+        struct art_node
+        {
+            explicit art_node(art_kind k) : kind{k} {}
+
+            const art_kind kind;
+        };
+
+        // the leaves are linked in the keys' order, around a sentinel held by the tree
+        struct art_links
+        {
+            art_links* prev;
+            art_links* next;
+        };
+
+        template<class Value>
+        struct art_leaf : art_node, art_links
+        {
+            template<class... Args>
+            explicit art_leaf(Args&&... args) :
+                art_node{art_kind::leaf}, art_links{nullptr, nullptr}, value(std::forward<Args>(args)...)
+            {
+            }
+
+            Value value;
+        };
+
+        struct art_inner : art_node
+        {
+            static constexpr size_t max_path = 8;
+
+            explicit art_inner(art_kind k) : art_node{k} {}
+
+            uint16_t count = 0;
+            // the length of the path compressed into the node, whose first max_path bytes are kept. The following
+            // ones are skipped by lookups, and read from the node's leaves when needed
+            uint32_t path_len = 0;
+            unsigned char path[max_path];
+            art_node* terminal = nullptr; // the leaf of the key ending at the node, which precedes its children
+        };
+
+        struct art_node4 : art_inner
+        {
+            art_node4() : art_inner{art_kind::node4} {}
+
+            unsigned char keys[4] = {};
+            art_node* children[4];
+        };
+
+        struct art_node16 : art_inner
+        {
+            art_node16() : art_inner{art_kind::node16} {}
+
+            unsigned char keys[16] = {};
+            art_node* children[16];
+        };
+
+        struct art_node48 : art_inner
+        {
+            art_node48() : art_inner{art_kind::node48} {}
+
+            unsigned char index[256] = {}; // the child's slot + 1, or 0 when the byte has no child
+            art_node* children[48] = {};
+        };
+
+        struct art_node256 : art_inner
+        {
+            art_node256() : art_inner{art_kind::node256} {}
+
+            art_node* children[256] = {};
+        };
+
+        inline void delete_inner(art_inner* n)
+        {
+            switch (n->kind)
+            {
+                case art_kind::node4: delete static_cast<art_node4*>(n); break;
+                case art_kind::node16: delete static_cast<art_node16*>(n); break;
+                case art_kind::node48: delete static_cast<art_node48*>(n); break;
+                default: delete static_cast<art_node256*>(n); break;
+            }
+        }
+
+        // calls f(byte, child) for the node's children, in the bytes' order
+        template<class F>
+        void for_each_child(const art_inner* n, F f)
+        {
+            switch (n->kind)
+            {
+                case art_kind::node4:
+                {
+                    const art_node4* n4 = static_cast<const art_node4*>(n);
+                    for (size_t i = 0; i < n->count; ++i)
+                        f(n4->keys[i], n4->children[i]);
+                    break;
+                }
+                case art_kind::node16:
+                {
+                    const art_node16* n16 = static_cast<const art_node16*>(n);
+                    for (size_t i = 0; i < n->count; ++i)
+                        f(n16->keys[i], n16->children[i]);
+                    break;
+                }
+                case art_kind::node48:
+                {
+                    const art_node48* n48 = static_cast<const art_node48*>(n);
+                    for (size_t b = 0; b < 256; ++b)
+                        if (n48->index[b] != 0)
+                            f(static_cast<unsigned char>(b), n48->children[n48->index[b] - 1]);
+                    break;
+                }
+                default:
+                {
+                    const art_node256* n256 = static_cast<const art_node256*>(n);
+                    for (size_t b = 0; b < 256; ++b)
+                        if (n256->children[b] != nullptr)
+                            f(static_cast<unsigned char>(b), n256->children[b]);
+                    break;
+                }
+            }
+        }
+
+        // the slot of the child of the given byte, or null if there's none
+        inline art_node* const* find_child(const art_inner* n, unsigned char b)
+        {
+            switch (n->kind)
+            {
+                case art_kind::node4:
+                {
+                    const art_node4* n4 = static_cast<const art_node4*>(n);
+                    for (size_t i = 0; i < n->count; ++i)
+                        if (n4->keys[i] == b)
+                            return &n4->children[i];
+                    return nullptr;
+                }
+                case art_kind::node16:
+                {
+                    const art_node16* n16 = static_cast<const art_node16*>(n);
+#if KDMT_X86_SIMD
+                    const __m128i keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(n16->keys));
+                    const unsigned eq = static_cast<unsigned>(_mm_movemask_epi8(
+                            _mm_cmpeq_epi8(keys, _mm_set1_epi8(static_cast<char>(b))))) & ((1U << n->count) - 1);
+                    return eq != 0 ? &n16->children[__builtin_ctz(eq)] : nullptr;
+#else
+                    for (size_t i = 0; i < n->count; ++i)
+                        if (n16->keys[i] == b)
+                            return &n16->children[i];
+                    return nullptr;
+#endif // KDMT_X86_SIMD
+                }
+                case art_kind::node48:
+                {
+                    const art_node48* n48 = static_cast<const art_node48*>(n);
+                    return n48->index[b] != 0 ? &n48->children[n48->index[b] - 1] : nullptr;
+                }
+                default:
+                {
+                    const art_node256* n256 = static_cast<const art_node256*>(n);
+                    return n256->children[b] != nullptr ? &n256->children[b] : nullptr;
+                }
+            }
+        }
+
+        inline art_node** find_child(art_inner* n, unsigned char b)
+        {
+            return const_cast<art_node**>(find_child(static_cast<const art_inner*>(n), b));
+        }
+
+        // the child of the lowest byte not below from, or null if there's none
+        inline art_node* child_from(const art_inner* n, size_t from)
+        {
+            switch (n->kind)
+            {
+                case art_kind::node4:
+                {
+                    const art_node4* n4 = static_cast<const art_node4*>(n);
+                    for (size_t i = 0; i < n->count; ++i)
+                        if (n4->keys[i] >= from)
+                            return n4->children[i];
+                    return nullptr;
+                }
+                case art_kind::node16:
+                {
+                    const art_node16* n16 = static_cast<const art_node16*>(n);
+                    for (size_t i = 0; i < n->count; ++i)
+                        if (n16->keys[i] >= from)
+                            return n16->children[i];
+                    return nullptr;
+                }
+                case art_kind::node48:
+                {
+                    const art_node48* n48 = static_cast<const art_node48*>(n);
+                    for (size_t b = from; b < 256; ++b)
+                        if (n48->index[b] != 0)
+                            return n48->children[n48->index[b] - 1];
+                    return nullptr;
+                }
+                default:
+                {
+                    const art_node256* n256 = static_cast<const art_node256*>(n);
+                    for (size_t b = from; b < 256; ++b)
+                        if (n256->children[b] != nullptr)
+                            return n256->children[b];
+                    return nullptr;
+                }
+            }
+        }
+
+        inline art_node* last_child(const art_inner* n)
+        {
+            switch (n->kind)
+            {
+                case art_kind::node4:
+                    return n->count > 0 ? static_cast<const art_node4*>(n)->children[n->count - 1] : nullptr;
+                case art_kind::node16:
+                    return n->count > 0 ? static_cast<const art_node16*>(n)->children[n->count - 1] : nullptr;
+                case art_kind::node48:
+                {
+                    const art_node48* n48 = static_cast<const art_node48*>(n);
+                    for (size_t b = 256; b-- > 0;)
+                        if (n48->index[b] != 0)
+                            return n48->children[n48->index[b] - 1];
+                    return nullptr;
+                }
+                default:
+                {
+                    const art_node256* n256 = static_cast<const art_node256*>(n);
+                    for (size_t b = 256; b-- > 0;)
+                        if (n256->children[b] != nullptr)
+                            return n256->children[b];
+                    return nullptr;
+                }
+            }
+        }
+
+        // a node of another kind, taking over the node's path, terminal and children
+        template<class Node>
+        Node* convert(const art_inner* n)
+        {
+            Node* converted = new Node;
+            converted->path_len = n->path_len;
+            memcpy(converted->path, n->path, sizeof(n->path));
+            converted->terminal = n->terminal;
+            return converted;
+        }
+
+        template<class Node>
+        void insert_sorted(Node* n, unsigned char b, art_node* child)
+        {
+            size_t pos = 0;
+            while (pos < n->count && n->keys[pos] < b)
+                ++pos;
+            memmove(n->keys + pos + 1, n->keys + pos, n->count - pos);
+            memmove(n->children + pos + 1, n->children + pos, (n->count - pos) * sizeof(art_node*));
+            n->keys[pos] = b;
+            n->children[pos] = child;
+            ++n->count;
+        }
+
+        template<class Node>
+        void remove_sorted(Node* n, unsigned char b)
+        {
+            size_t pos = 0;
+            while (n->keys[pos] != b)
+                ++pos;
+            memmove(n->keys + pos, n->keys + pos + 1, n->count - pos - 1);
+            memmove(n->children + pos, n->children + pos + 1, (n->count - pos - 1) * sizeof(art_node*));
+            --n->count;
+        }
+
+        inline void add_child(art_node** ref, unsigned char b, art_node* child);
+
+        // moves the node's children to a node of another kind, which replaces it
+        template<class Node>
+        void replace_node(art_node** ref)
+        {
+            art_inner* n = static_cast<art_inner*>(*ref);
+            art_node* converted = convert<Node>(n);
+            for_each_child(n, [&converted](unsigned char b, art_node* child) { add_child(&converted, b, child); });
+            *ref = converted;
+            delete_inner(n);
+        }
+
+        // adds a child, growing the node when it's full
+        inline void add_child(art_node** ref, unsigned char b, art_node* child)
+        {
+            art_inner* n = static_cast<art_inner*>(*ref);
+            switch (n->kind)
+            {
+                case art_kind::node4:
+                    if (n->count == 4)
+                        break;
+                    insert_sorted(static_cast<art_node4*>(n), b, child);
+                    return;
+                case art_kind::node16:
+                    if (n->count == 16)
+                        break;
+                    insert_sorted(static_cast<art_node16*>(n), b, child);
+                    return;
+                case art_kind::node48:
+                {
+                    if (n->count == 48)
+                        break;
+                    art_node48* n48 = static_cast<art_node48*>(n);
+                    size_t slot = 0;
+                    while (n48->children[slot] != nullptr)
+                        ++slot;
+                    n48->children[slot] = child;
+                    n48->index[b] = static_cast<unsigned char>(slot + 1);
+                    ++n->count;
+                    return;
+                }
+                default:
+                    static_cast<art_node256*>(n)->children[b] = child;
+                    ++n->count;
+                    return;
+            }
+            switch (n->kind)
+            {
+                case art_kind::node4: replace_node<art_node16>(ref); break;
+                case art_kind::node16: replace_node<art_node48>(ref); break;
+                default: replace_node<art_node256>(ref); break;
+            }
+            add_child(ref, b, child);
+        }
+
+        // removes a child, shrinking the node when it's sparse enough (with some slack, so nodes don't keep
+        // growing and shrinking when a key is inserted and erased repeatedly)
+        inline void remove_child(art_node** ref, unsigned char b)
+        {
+            art_inner* n = static_cast<art_inner*>(*ref);
+            switch (n->kind)
+            {
+                case art_kind::node4:
+                    remove_sorted(static_cast<art_node4*>(n), b);
+                    break;
+                case art_kind::node16:
+                    remove_sorted(static_cast<art_node16*>(n), b);
+                    if (n->count <= 3)
+                        replace_node<art_node4>(ref);
+                    break;
+                case art_kind::node48:
+                {
+                    art_node48* n48 = static_cast<art_node48*>(n);
+                    n48->children[n48->index[b] - 1] = nullptr;
+                    n48->index[b] = 0;
+                    if (--n->count <= 12)
+                        replace_node<art_node16>(ref);
+                    break;
+                }
+                default:
+                    static_cast<art_node256*>(n)->children[b] = nullptr;
+                    if (--n->count <= 37)
+                        replace_node<art_node48>(ref);
+                    break;
+            }
+        }
+
+        //
+        // An adaptive radix tree (see "The Adaptive Radix Tree: ARTful Indexing for Main-Memory Databases", Leis et
+        // al., 2013) of keydomets, the common part of art_set and art_map. Each inner node branches on one byte of
+        // the keys, and holds 4, 16, 48 or 256 children, growing and shrinking along with their number. Paths of a
+        // single child are compressed into the node following them, and keys are kept by leaves placed as high as
+        // they can be, which are only expanded into nodes once another key shares their path.
+        // The key bytes the prefix holds are taken from the already loaded prefix, rather than the string, so the
+        // first levels are descended using the prefix alone, as keydomet comparisons do. Once a lookup reaches a
+        // leaf, the keys are compared as keydomets, which verifies the bytes the inner nodes didn't keep.
+        // The leaves are linked in the keys' order, for iteration.
+        //
+        template<class Policy>
+        class art
+        {
+
+            using kdmt_type = typename Policy::key_type;
+            using prefix_type = typename prefix_rep<kdmt_type::size>::prefix_type;
+            using stats = typename kdmt_type::stats;
+            using leaf = art_leaf<typename Policy::value_type>;
+
+            static constexpr size_t prefix_bytes = static_cast<size_t>(kdmt_type::size);
+            static constexpr size_t max_path = art_inner::max_path;
+
+            using key_bytes = art_key<prefix_type, prefix_bytes>;
+
+            static_assert(std::is_same<typename kdmt_type::encoding, raw_encoding>::value,
+                          "Radix trees use the raw encoding, whose prefixes are the first bytes of the keys");
+            static_assert(!is_deduplicated<typename kdmt_type::str_imp>::value,
+                          "Radix trees read the keys' bytes, deduplicated keydomets don't store the prefix ones");
+
+            template<bool Const>
+            class iterator_base
+            {
+
+                friend class art;
+                template<bool> friend class iterator_base;
+
+            public:
+
+                using iterator_category = std::bidirectional_iterator_tag;
+                using value_type = typename Policy::value_type;
+                using difference_type = std::ptrdiff_t;
+                using reference = std::conditional_t<Const, const value_type&,
+                                  decltype(Policy::value(std::declval<value_type&>()))>;
+                using pointer = std::add_pointer_t<reference>;
+
+                iterator_base() = default;
+
+                template<bool OtherConst, class = std::enable_if_t<Const && !OtherConst>>
+                iterator_base(const iterator_base<OtherConst>& other) : links{other.links}
+                {
+                }
+
+                reference operator*() const
+                {
+                    return Policy::value(static_cast<leaf*>(links)->value);
+                }
+
+                pointer operator->() const
+                {
+                    return &**this;
+                }
+
+                iterator_base& operator++()
+                {
+                    links = links->next;
+                    return *this;
+                }
+
+                iterator_base operator++(int)
+                {
+                    iterator_base prev{*this};
+                    ++*this;
+                    return prev;
+                }
+
+                iterator_base& operator--()
+                {
+                    links = links->prev;
+                    return *this;
+                }
+
+                iterator_base operator--(int)
+                {
+                    iterator_base prev{*this};
+                    --*this;
+                    return prev;
+                }
+
+                template<bool OtherConst>
+                bool operator==(const iterator_base<OtherConst>& other) const
+                {
+                    return links == other.links;
+                }
+
+                template<bool OtherConst>
+                bool operator!=(const iterator_base<OtherConst>& other) const
+                {
+                    return !(*this == other);
+                }
+
+            private:
+
+                explicit iterator_base(art_links* l) : links{l} {}
+
+                art_links* links = nullptr; // the tree's sentinel at the end
+
+            };
+
+        public:
+
+            using key_type = kdmt_type;
+            using value_type = typename Policy::value_type;
+            using size_type = size_t;
+            using difference_type = std::ptrdiff_t;
+            using key_compare = std::less<>;
+            using reference = value_type&;
+            using const_reference = const value_type&;
+            using iterator = iterator_base<false>;
+            using const_iterator = iterator_base<true>;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+            art() = default;
+
+            template<class InputIt>
+            art(InputIt first, InputIt last)
+            {
+                insert(first, last);
+            }
+
+            art(std::initializer_list<value_type> values) : art(values.begin(), values.end())
+            {
+            }
+
+            art(const art& other) : art(other.begin(), other.end())
+            {
+            }
+
+            art(art&& other) noexcept
+            {
+                swap(other);
+            }
+
+            art& operator=(const art& other)
+            {
+                if (this != &other)
+                {
+                    art copy{other};
+                    swap(copy);
+                }
+                return *this;
+            }
+
+            art& operator=(art&& other) noexcept
+            {
+                art moved{std::move(other)};
+                swap(moved);
+                return *this;
+            }
+
+            ~art()
+            {
+                clear();
+            }
+
+            iterator begin() { return iterator{sentinel.next}; }
+            const_iterator begin() const { return const_iterator{sentinel.next}; }
+            const_iterator cbegin() const { return begin(); }
+            iterator end() { return iterator{&sentinel}; }
+            const_iterator end() const { return const_iterator{const_cast<art_links*>(&sentinel)}; }
+            const_iterator cend() const { return end(); }
+            reverse_iterator rbegin() { return reverse_iterator{end()}; }
+            const_reverse_iterator rbegin() const { return const_reverse_iterator{end()}; }
+            const_reverse_iterator crbegin() const { return rbegin(); }
+            reverse_iterator rend() { return reverse_iterator{begin()}; }
+            const_reverse_iterator rend() const { return const_reverse_iterator{begin()}; }
+            const_reverse_iterator crend() const { return rend(); }
+
+            bool empty() const
+            {
+                return keys_num == 0;
+            }
+
+            size_type size() const
+            {
+                return keys_num;
+            }
+
+            key_compare key_comp() const
+            {
+                return {};
+            }
+
+            void clear()
+            {
+                if (root != nullptr)
+                    free_subtree(root);
+                root = nullptr;
+                sentinel.prev = sentinel.next = &sentinel;
+                keys_num = 0;
+            }
+
+            void swap(art& other) noexcept
+            {
+                std::swap(root, other.root);
+                std::swap(keys_num, other.keys_num);
+                std::swap(sentinel, other.sentinel);
+                relink_sentinel();
+                other.relink_sentinel();
+            }
+
+            std::pair<iterator, bool> insert(const value_type& value)
+            {
+                return emplace(value);
+            }
+
+            std::pair<iterator, bool> insert(value_type&& value)
+            {
+                return emplace(std::move(value));
+            }
+
+            template<class InputIt>
+            void insert(InputIt first, InputIt last)
+            {
+                for (; first != last; ++first)
+                    emplace(*first);
+            }
+
+            void insert(std::initializer_list<value_type> values)
+            {
+                insert(values.begin(), values.end());
+            }
+
+            template<class... Args>
+            std::pair<iterator, bool> emplace(Args&&... args)
+            {
+                std::unique_ptr<leaf> new_leaf{new leaf(std::forward<Args>(args)...)};
+                const std::pair<leaf*, bool> res = insert_leaf(new_leaf.get());
+                if (res.second)
+                    new_leaf.release();
+                return {iterator{res.first}, res.second};
+            }
+
+            iterator erase(const_iterator pos)
+            {
+                return iterator{erase_leaf(static_cast<leaf*>(pos.links))};
+            }
+
+            iterator erase(iterator pos)
+            {
+                return iterator{erase_leaf(static_cast<leaf*>(pos.links))};
+            }
+
+            iterator erase(const_iterator first_value, const_iterator last_value)
+            {
+                while (first_value != last_value)
+                    first_value = erase(first_value);
+                return iterator{last_value.links};
+            }
+
+            size_type erase(const key_type& key)
+            {
+                leaf* l = find_leaf(key);
+                if (l == nullptr)
+                    return 0;
+                erase_leaf(l);
+                return 1;
+            }
+
+            template<class KeyT>
+            iterator find(const KeyT& key)
+            {
+                leaf* l = find_leaf(probe_of(key));
+                return l != nullptr ? iterator{l} : end();
+            }
+
+            template<class KeyT>
+            const_iterator find(const KeyT& key) const
+            {
+                return const_cast<art*>(this)->find(key);
+            }
+
+            template<class KeyT>
+            size_type count(const KeyT& key) const
+            {
+                return find_leaf(probe_of(key)) != nullptr ? 1 : 0;
+            }
+
+            template<class KeyT>
+            bool contains(const KeyT& key) const
+            {
+                return find_leaf(probe_of(key)) != nullptr;
+            }
+
+            template<class KeyT>
+            iterator lower_bound(const KeyT& key)
+            {
+                return iterator{lower_links(probe_of(key))};
+            }
+
+            template<class KeyT>
+            const_iterator lower_bound(const KeyT& key) const
+            {
+                return const_cast<art*>(this)->lower_bound(key);
+            }
+
+            template<class KeyT>
+            iterator upper_bound(const KeyT& key)
+            {
+                return equal_range(key).second;
+            }
+
+            template<class KeyT>
+            const_iterator upper_bound(const KeyT& key) const
+            {
+                return const_cast<art*>(this)->upper_bound(key);
+            }
+
+            template<class KeyT>
+            std::pair<iterator, iterator> equal_range(const KeyT& key)
+            {
+                const auto& probe = probe_of(key);
+                art_links* lower = lower_links(probe);
+                if (lower == &sentinel || Policy::key(static_cast<leaf*>(lower)->value).compare(probe) != 0)
+                    return {iterator{lower}, iterator{lower}};
+                return {iterator{lower}, iterator{lower->next}};
+            }
+
+            template<class KeyT>
+            std::pair<const_iterator, const_iterator> equal_range(const KeyT& key) const
+            {
+                return const_cast<art*>(this)->equal_range(key);
+            }
+
+            friend bool operator==(const art& a1, const art& a2)
+            {
+                return a1.size() == a2.size() && std::equal(a1.begin(), a1.end(), a2.begin());
+            }
+
+            friend bool operator!=(const art& a1, const art& a2)
+            {
+                return !(a1 == a2);
+            }
+
+        protected:
+
+            template<class KeyT>
+            static std::enable_if_t<is_keydomet<KeyT>::value, const KeyT&> probe_of(const KeyT& key)
+            {
+                static_assert(KeyT::size == kdmt_type::size &&
+                              std::is_same<typename KeyT::encoding, typename kdmt_type::encoding>::value,
+                              "Radix trees are searched using keys of their own prefix size and encoding");
+                return key;
+            }
+
+            // string views are searched for using keydomets viewing them
+            template<class KeyT>
+            static std::enable_if_t<!is_keydomet<KeyT>::value, keydomet<const KeyT&, kdmt_type::size, stats,
+                    typename kdmt_type::encoding>> probe_of(const KeyT& key)
+            {
+                return keydomet<const KeyT&, kdmt_type::size, stats, typename kdmt_type::encoding>{key};
+            }
+
+            template<class KeyT>
+            leaf* find_leaf(const KeyT& probe) const
+            {
+                const key_bytes key = bytes_of(probe);
+                const art_node* n = root;
+                size_t depth = 0;
+                while (n != nullptr)
+                {
+                    if (n->kind == art_kind::leaf)
+                    {
+                        leaf* l = static_cast<leaf*>(const_cast<art_node*>(n));
+                        return Policy::key(l->value).compare(probe) == 0 ? l : nullptr;
+                    }
+                    const art_inner* inner = static_cast<const art_inner*>(n);
+                    if (inner->path_len != 0)
+                    {
+                        if (depth + inner->path_len > key.len)
+                            return miss(key.len);
+                        // the bytes the node didn't keep are verified by the leaf
+                        const size_t kept = std::min<size_t>(inner->path_len, max_path);
+                        for (size_t i = 0; i < kept; ++i)
+                            if (key[depth + i] != inner->path[i])
+                                return miss(depth + i);
+                        depth += inner->path_len;
+                    }
+                    if (depth == key.len)
+                    {
+                        n = inner->terminal;
+                        continue;
+                    }
+                    art_node* const* child = find_child(inner, key[depth]);
+                    if (child == nullptr)
+                        return miss(depth);
+                    n = *child;
+                    ++depth;
+                }
+                return nullptr;
+            }
+
+            // lookups decided by a byte of the prefix didn't read the key's string
+            static leaf* miss(size_t depth)
+            {
+                if (depth < prefix_bytes)
+                    stats::count_prefix();
+                else
+                    stats::count_string();
+                return nullptr;
+            }
+
+            template<class K, class... Args>
+            std::pair<iterator, bool> emplace_key(K&& key, Args&&... args)
+            {
+                leaf* l = find_leaf(key);
+                if (l != nullptr)
+                    return {iterator{l}, false};
+                return emplace(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                               std::forward_as_tuple(std::forward<Args>(args)...));
+            }
+
+        private:
+
+            art_node* root = nullptr;
+            size_t keys_num = 0;
+            art_links sentinel{&sentinel, &sentinel};
+
+            template<class KeyT>
+            static key_bytes bytes_of(const KeyT& key)
+            {
+                const auto& str = key.get_str();
+                return {key.getPrefix().get_val(), reinterpret_cast<const unsigned char*>(get_raw_str(str)),
+                        chars_len(str, SIZE_MAX)};
+            }
+
+            static key_bytes leaf_bytes(const art_node* l)
+            {
+                return bytes_of(Policy::key(static_cast<const leaf*>(l)->value));
+            }
+
+            static leaf* min_leaf(art_node* n)
+            {
+                while (n->kind != art_kind::leaf)
+                {
+                    art_inner* inner = static_cast<art_inner*>(n);
+                    n = inner->terminal != nullptr ? inner->terminal : child_from(inner, 0);
+                }
+                return static_cast<leaf*>(n);
+            }
+
+            static leaf* max_leaf(art_node* n)
+            {
+                while (n->kind != art_kind::leaf)
+                {
+                    art_inner* inner = static_cast<art_inner*>(n);
+                    n = inner->count > 0 ? last_child(inner) : inner->terminal;
+                }
+                return static_cast<leaf*>(n);
+            }
+
+            // the byte at the given position of the node's path, the node being at the given depth
+            static unsigned char path_byte(art_inner* n, size_t pos, size_t depth)
+            {
+                return pos < max_path ? n->path[pos] : leaf_bytes(min_leaf(n))[depth + pos];
+            }
+
+            // the number of the node's path bytes the key matches
+            static size_t match_path(art_inner* n, const key_bytes& key, size_t depth)
+            {
+                const size_t kept = std::min<size_t>(n->path_len, max_path);
+                size_t i = 0;
+                for (; i < kept; ++i)
+                    if (depth + i == key.len || key[depth + i] != n->path[i])
+                        return i;
+                if (i < n->path_len)
+                {
+                    const key_bytes path = leaf_bytes(min_leaf(n));
+                    for (; i < n->path_len; ++i)
+                        if (depth + i == key.len || key[depth + i] != path[depth + i])
+                            return i;
+                }
+                return i;
+            }
+
+            static void set_path(art_inner* n, const key_bytes& key, size_t depth, size_t len)
+            {
+                n->path_len = static_cast<uint32_t>(len);
+                for (size_t i = 0; i < len && i < max_path; ++i)
+                    n->path[i] = key[depth + i];
+            }
+
+            // a node holding the leaf, or the key ending at the node
+            static void place_leaf(art_node** ref, leaf* l, const key_bytes& key, size_t depth)
+            {
+                if (key.len == depth)
+                    static_cast<art_inner*>(*ref)->terminal = l;
+                else
+                    add_child(ref, key[depth], l);
+            }
+
+            // the first leaf not smaller than the key, or the sentinel
+            template<class KeyT>
+            art_links* lower_links(const KeyT& probe) const
+            {
+                art_links* end_links = const_cast<art_links*>(&sentinel);
+                if (root == nullptr)
+                    return end_links;
+                const key_bytes key = bytes_of(probe);
+                art_node* n = root;
+                size_t depth = 0;
+                while (true)
+                {
+                    if (n->kind == art_kind::leaf)
+                    {
+                        // the leaf is the only key sharing the probe's bytes so far, so the next one is greater
+                        leaf* l = static_cast<leaf*>(n);
+                        return Policy::key(l->value).compare(probe) >= 0 ? l : l->next;
+                    }
+                    art_inner* inner = static_cast<art_inner*>(n);
+                    const size_t matched = match_path(inner, key, depth);
+                    if (matched < inner->path_len)
+                    {
+                        // the key precedes or follows all the keys of the node
+                        if (depth + matched == key.len || key[depth + matched] < path_byte(inner, matched, depth))
+                            return min_leaf(inner);
+                        return max_leaf(inner)->next;
+                    }
+                    depth += inner->path_len;
+                    if (depth == key.len)
+                        return min_leaf(inner);
+                    art_node* const* child = find_child(inner, key[depth]);
+                    if (child == nullptr)
+                    {
+                        art_node* next = child_from(inner, key[depth] + 1U);
+                        return next != nullptr ? min_leaf(next) : max_leaf(inner)->next;
+                    }
+                    n = *child;
+                    ++depth;
+                }
+            }
+
+            std::pair<leaf*, bool> insert_leaf(leaf* l)
+            {
+                if (root == nullptr)
+                {
+                    root = l;
+                    link_before(l, &sentinel);
+                    ++keys_num;
+                    return {l, true};
+                }
+                const kdmt_type& kdmt = Policy::key(l->value);
+                const key_bytes key = bytes_of(kdmt);
+                art_node** ref = &root;
+                size_t depth = 0;
+                while (true)
+                {
+                    if ((*ref)->kind == art_kind::leaf)
+                    {
+                        leaf* other = static_cast<leaf*>(*ref);
+                        const int cmp = Policy::key(other->value).compare(kdmt);
+                        if (cmp == 0)
+                            return {other, false};
+                        // lazy expansion: a node branching at the first byte the keys differ at replaces the leaf
+                        const key_bytes other_key = leaf_bytes(other);
+                        size_t end = depth;
+                        while (end < key.len && end < other_key.len && key[end] == other_key[end])
+                            ++end;
+                        art_node* n = new art_node4;
+                        set_path(static_cast<art_inner*>(n), key, depth, end - depth);
+                        place_leaf(&n, other, other_key, end);
+                        place_leaf(&n, l, key, end);
+                        *ref = n;
+                        link_before(l, cmp < 0 ? other->next : other);
+                        break;
+                    }
+                    art_inner* n = static_cast<art_inner*>(*ref);
+                    const size_t matched = match_path(n, key, depth);
+                    if (matched < n->path_len)
+                    {
+                        split_path(ref, matched, depth, l, key);
+                        break;
+                    }
+                    depth += n->path_len;
+                    if (depth == key.len)
+                    {
+                        if (n->terminal != nullptr)
+                            return {static_cast<leaf*>(n->terminal), false};
+                        n->terminal = l;
+                        link_before(l, min_leaf(child_from(n, 0)));
+                        break;
+                    }
+                    art_node** child = find_child(n, key[depth]);
+                    if (child == nullptr)
+                    {
+                        art_node* next = child_from(n, key[depth] + 1U);
+                        art_links* successor = next != nullptr ? min_leaf(next) : max_leaf(n)->next;
+                        add_child(ref, key[depth], l);
+                        link_before(l, successor);
+                        break;
+                    }
+                    ref = child;
+                    ++depth;
+                }
+                ++keys_num;
+                return {l, true};
+            }
+
+            // the key branches off the path of the node at ref, which is split by a node holding the matched bytes
+            void split_path(art_node** ref, size_t matched, size_t depth, leaf* l, const key_bytes& key)
+            {
+                art_inner* n = static_cast<art_inner*>(*ref);
+                const unsigned char branch = path_byte(n, matched, depth);
+                const bool precedes = depth + matched == key.len || key[depth + matched] < branch;
+                art_links* successor = precedes ? min_leaf(n) : max_leaf(n)->next;
+                // the node keeps the bytes following the branch
+                unsigned char rest[max_path];
+                const size_t rest_len = n->path_len - matched - 1;
+                for (size_t i = 0; i < rest_len && i < max_path; ++i)
+                    rest[i] = path_byte(n, matched + 1 + i, depth);
+                memcpy(n->path, rest, std::min(rest_len, max_path));
+                n->path_len = static_cast<uint32_t>(rest_len);
+                art_node* parent = new art_node4;
+                set_path(static_cast<art_inner*>(parent), key, depth, matched);
+                add_child(&parent, branch, n);
+                place_leaf(&parent, l, key, depth + matched);
+                *ref = parent;
+                link_before(l, successor);
+            }
+
+            // returns the links following the erased leaf
+            art_links* erase_leaf(leaf* l)
+            {
+                const key_bytes key = leaf_bytes(l);
+                art_node** ref = &root;
+                art_node** parent_ref = nullptr;
+                size_t depth = 0;
+                while (*ref != l)
+                {
+                    art_inner* n = static_cast<art_inner*>(*ref);
+                    depth += n->path_len;
+                    parent_ref = ref;
+                    if (depth == key.len)
+                    {
+                        ref = &n->terminal;
+                        break;
+                    }
+                    ref = find_child(n, key[depth]);
+                    ++depth;
+                }
+                art_links* next = l->next;
+                l->prev->next = l->next;
+                l->next->prev = l->prev;
+                if (parent_ref == nullptr)
+                {
+                    root = nullptr;
+                }
+                else
+                {
+                    art_inner* parent = static_cast<art_inner*>(*parent_ref);
+                    if (ref == &parent->terminal)
+                        parent->terminal = nullptr;
+                    else
+                        remove_child(parent_ref, key[depth - 1]);
+                    collapse(parent_ref);
+                }
+                delete l;
+                --keys_num;
+                return next;
+            }
+
+            // a node left with a single child or terminal is replaced by it, the child taking over its path
+            static void collapse(art_node** ref)
+            {
+                art_inner* n = static_cast<art_inner*>(*ref);
+                if (n->count + (n->terminal != nullptr ? 1 : 0) > 1)
+                    return;
+                if (n->count == 0)
+                {
+                    *ref = n->terminal;
+                }
+                else
+                {
+                    unsigned char branch = 0;
+                    art_node* child = nullptr;
+                    for_each_child(n, [&](unsigned char b, art_node* c) {
+                        branch = b;
+                        child = c;
+                    });
+                    if (child->kind != art_kind::leaf)
+                    {
+                        art_inner* inner = static_cast<art_inner*>(child);
+                        unsigned char path[max_path];
+                        size_t len = std::min<size_t>(n->path_len, max_path);
+                        memcpy(path, n->path, len);
+                        if (len < max_path)
+                            path[len++] = branch;
+                        for (size_t i = 0; len < max_path && i < std::min<size_t>(inner->path_len, max_path); ++i)
+                            path[len++] = inner->path[i];
+                        memcpy(inner->path, path, len);
+                        inner->path_len += n->path_len + 1;
+                    }
+                    *ref = child;
+                }
+                delete_inner(n);
+            }
+
+            static void link_before(leaf* l, art_links* successor)
+            {
+                l->next = successor;
+                l->prev = successor->prev;
+                successor->prev->next = l;
+                successor->prev = l;
+            }
+
+            void relink_sentinel()
+            {
+                if (keys_num == 0)
+                {
+                    sentinel.prev = sentinel.next = &sentinel;
+                }
+                else
+                {
+                    sentinel.next->prev = &sentinel;
+                    sentinel.prev->next = &sentinel;
+                }
+            }
+
+            static void free_subtree(art_node* n)
+            {
+                if (n->kind == art_kind::leaf)
+                {
+                    delete static_cast<leaf*>(n);
+                    return;
+                }
+                art_inner* inner = static_cast<art_inner*>(n);
+                if (inner->terminal != nullptr)
+                    free_subtree(inner->terminal);
+                for_each_child(inner, [](unsigned char, art_node* child) { free_subtree(child); });
+                delete_inner(inner);
+            }
+
+        };
+
+        template<class Policy>
+        constexpr size_t art<Policy>::max_path;
+    }
+
+    //
+    // An ordered set of keydomets, e.g., art_set<keydomet<std::string, prefix_size::SIZE_64BIT>>, with the API of a
+    // std::set using a transparent comparator, kept in an adaptive radix tree. Suited for dense keys sharing long
+    // heads (paths, URLs and such), which a comparison tree would compare again and again: the tree branches on
+    // each byte once, taking the first ones from the prefix. The prefix doesn't let lookups skip levels, though -
+    // its bytes are branched on one node at a time (or as part of a compressed path), just like the string's,
+    // only without reading the string. Keydomets must use the raw encoding.
+    // Lookups take any keydomet of the same prefix size and encoding, e.g., one made by make_find_key(), as well as
+    // string views, e.g., a chars_view or a std::string_view. Inserting and erasing keys doesn't invalidate iterators
+    // to other keys.
+    //
+    template<class KeydometT>
+    class art_set : public imp::art<imp::art_set_policy<KeydometT>>
+    {
+
+        using base = imp::art<imp::art_set_policy<KeydometT>>;
+
+    public:
+
+        using base::base;
+
+        art_set() = default;
+
+        art_set(std::initializer_list<KeydometT> values) : base(values)
+        {
+        }
+
+    };
+
+    //
+    // An ordered map from keydomets, e.g., art_map<keydomet<std::string, prefix_size::SIZE_64BIT>, int>, with the
+    // API of a std::map using a transparent comparator. See art_set.
+    //
+    template<class KeydometT, class T>
+    class art_map : public imp::art<imp::art_map_policy<KeydometT, T>>
+    {
+
+        using base = imp::art<imp::art_map_policy<KeydometT, T>>;
+
+    public:
+
+        using mapped_type = T;
+        using typename base::key_type;
+        using typename base::value_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+
+        using base::base;
+        using base::insert;
+
+        art_map() = default;
+
+        art_map(std::initializer_list<value_type> values) : base(values)
+        {
+        }
+
+        template<class P, class = std::enable_if_t<std::is_constructible<value_type, P&&>::value>>
+        std::pair<iterator, bool> insert(P&& value)
+        {
+            return this->emplace(std::forward<P>(value));
+        }
+
+        template<class... Args>
+        std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args)
+        {
+            return this->emplace_key(key, std::forward<Args>(args)...);
+        }
+
+        template<class... Args>
+        std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args)
+        {
+            return this->emplace_key(std::move(key), std::forward<Args>(args)...);
+        }
+
+        T& operator[](const key_type& key)
+        {
+            return try_emplace(key).first->second;
+        }
+
+        T& operator[](key_type&& key)
+        {
+            return try_emplace(std::move(key)).first->second;
+        }
+
+        template<class KeyT>
+        T& at(const KeyT& key)
+        {
+            const iterator iter = this->find(key);
+            if (iter == this->end())
+                throw std::out_of_range("art_map::at");
+            return iter->second;
+        }
+
+        template<class KeyT>
+        const T& at(const KeyT& key) const
+        {
+            return const_cast<art_map*>(this)->at(key);
+        }
+
+    };
+
+}
+
+#endif //KEYDOMET_RADIXTREE_H
@@ -0,0 +1,190 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef KEYDOMET_STRINGHEAP_H
+#define KEYDOMET_STRINGHEAP_H
+
+#include "Keydomet.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <stdexcept>
+#include <utility>
+#include <type_traits>
+
+namespace kdmt
+{
+
+    //
+    // An append-only heap of strings, addressed by 32 bit offsets. Each string is stored as its 32 bit length,
+    // followed by its characters and a terminating NUL, so up to 4GB of strings can be stored.
+    // There's a single heap per Tag, shared by all keydomet<heap_stored<Tag>, ...> objects; giving each container
+    // its own Tag gives it its own heap. Strings are never removed - erasing keys doesn't reclaim their space, and
+    // clear() may only be called once no key referencing the heap is used. Neither does a failed insertion, e.g.,
+    // std::set::emplace() of a key already held, whose key is built (and appended) before being rejected; use
+    // heap_emplace() for inserting keys that may be held already.
+    // Appending may move the characters, invalidating views (but not offsets) of strings already stored. Appending
+    // must not be done concurrently with the heap's use.
+    //
+    template<class Tag = void>
+    class string_heap
+    {
+
+    public:
+
+        static uint32_t append(const char* chars, size_t len)
+        {
+            std::vector<char>& buf = bytes();
+            const size_t offset = buf.size();
+            if (len > UINT32_MAX || offset + sizeof(uint32_t) + len + 1 > UINT32_MAX)
+                throw std::length_error("string heap exceeds 4GB");
+            const uint32_t len32 = static_cast<uint32_t>(len);
+            buf.resize(offset + sizeof(len32) + len + 1);
+            memcpy(buf.data() + offset, &len32, sizeof(len32));
+            if (len > 0)
+                memcpy(buf.data() + offset + sizeof(len32), chars, len);
+            buf[offset + sizeof(len32) + len] = '\0';
+            return static_cast<uint32_t>(offset);
+        }
+
+        // the string stored at the given offset, valid until the next append
+        static chars_view view(uint32_t offset)
+        {
+            const char* rec = bytes().data() + offset;
+            uint32_t len;
+            memcpy(&len, rec, sizeof(len));
+            return {rec + sizeof(len), len};
+        }
+
+        // the number of bytes used, including the lengths and NULs
+        static size_t size()
+        {
+            return bytes().size();
+        }
+
+        static void reserve(size_t bytes_num)
+        {
+            bytes().reserve(bytes_num);
+        }
+
+        // drops the strings appended since size() returned mark, which no key may reference anymore
+        static void truncate(size_t mark)
+        {
+            std::vector<char>& buf = bytes();
+            if (mark < buf.size())
+                buf.resize(mark);
+        }
+
+        static void clear()
+        {
+            std::vector<char>().swap(bytes());
+        }
+
+    private:
+
+        static std::vector<char>& bytes()
+        {
+            static std::vector<char> buf;
+            return buf;
+        }
+
+    };
+
+    //
+    // A compact key - keydomet<heap_stored<Tag>, ...> holds its prefix and the offset of its string within
+    // string_heap<Tag>, hence takes 8 bytes with prefixes of up to 32 bits. It's constructed from any string type,
+    // whose characters are appended to the heap, and the heap is only read when the prefixes collide.
+    // get_str() returns a chars_view of the heap. Lookups should use view-based find keys (see make_find_key), so
+    // that the heap isn't appended to by lookups.
+    //
+    template<class Tag = void>
+    struct heap_stored
+    {
+        using heap = string_heap<Tag>;
+    };
+
+    //
+    // Emplaces a heap stored key into a container of such keys, e.g., a std::set. When the container holds the key
+    // already, the space appended to the heap for the rejected key is reclaimed.
+    //
+    template<class Container, class... Args>
+    auto heap_emplace(Container& container, Args&&... args)
+    {
+        using heap = typename Container::key_type::str_imp::heap;
+        const size_t mark = heap::size();
+        try
+        {
+            auto res = container.emplace(std::forward<Args>(args)...);
+            if (!res.second)
+                heap::truncate(mark);
+            return res;
+        }
+        catch (...)
+        {
+            heap::truncate(mark);
+            throw;
+        }
+    }
+
+    template<class Tag, prefix_size PrefixSize, class Encoding>
+    class keydomet_storage<heap_stored<Tag>, PrefixSize, Encoding>
+    {
+
+        using prefix_type = typename prefix_rep<PrefixSize>::prefix_type;
+        using heap = string_heap<Tag>;
+
+        static_assert(sizeof(prefix_type) <= sizeof(uint32_t),
+                      "Heap stored keydomets support prefixes of up to 32 bits");
+
+    public:
+
+        template<class SrcStr, class = imp::void_t<decltype(get_raw_str(std::declval<const SrcStr&>()))>>
+        keydomet_storage(const SrcStr& s) :
+            prefix_val{prefix_rep<PrefixSize>::from_val(Encoding::template encode<prefix_type>(s))},
+            heap_offset{heap::append(get_raw_str(s), imp::chars_len(s, SIZE_MAX))}
+        {
+        }
+
+        explicit keydomet_storage(in_place_t, const char* chars, size_t len) :
+            keydomet_storage(chars_view{chars, len})
+        {
+        }
+
+        template<class SrcStr, class = imp::void_t<decltype(get_raw_str(std::declval<const SrcStr&>()))>>
+        explicit keydomet_storage(in_place_t, const SrcStr& s) : keydomet_storage(s)
+        {
+        }
+
+        const prefix_rep<PrefixSize>& prefix() const
+        {
+            return prefix_val;
+        }
+
+        chars_view string() const
+        {
+            return heap::view(heap_offset);
+        }
+
+        imp::sized_suffix suffix(size_t offset) const
+        {
+            return imp::suffix_of(string(), offset);
+        }
+
+        size_t cached_length() const
+        {
+            return imp::unknown_length;
+        }
+
+    private:
+
+        prefix_rep<PrefixSize> prefix_val;
+        uint32_t heap_offset;
+
+    };
+
+}
+
+#endif //KEYDOMET_STRINGHEAP_H
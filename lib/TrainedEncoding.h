@@ -0,0 +1,220 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef KEYDOMET_TRAINEDENCODING_H
+#define KEYDOMET_TRAINEDENCODING_H
+
+#include "Keydomet.h"
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+namespace kdmt
+{
+
+    namespace imp
+    {
+        //
+        // An order preserving (alphabetic) prefix-free code of the 256 byte values, plus an end of string symbol which
+        // precedes them all. Frequent symbols get short codes, so the codes of a typical string's head take fewer bits
+        // than its raw characters. As the codes of ordered symbols are ordered too, and no code is a prefix of another,
+        // concatenating the codes of a string's characters preserves the order of strings.
+        // The code tree is built by recursively splitting the (ordered) symbols where their weights are best balanced.
+        //
+        class alphabetic_code_table
+        {
+
+        public:
+
+            static constexpr size_t symbols_num = 257; // the end of string, followed by the 256 byte values
+            static constexpr unsigned max_code_len = 24;
+
+            static size_t symbol_of(char c) noexcept
+            {
+                return (size_t)(unsigned char)c + 1;
+            }
+
+            // weights holds symbols_num non-zero weights, the end of string first
+            explicit alphabetic_code_table(const uint64_t* weights)
+            {
+                uint64_t cum_weights[symbols_num + 1] = {0};
+                for (size_t i = 0; i < symbols_num; ++i)
+                    cum_weights[i + 1] = cum_weights[i] + weights[i];
+                assign(0, symbols_num, 0, 0, cum_weights);
+            }
+
+            // the code of the given symbol, left aligned in 32 bits
+            uint32_t code(size_t symbol) const noexcept
+            {
+                return codes[symbol];
+            }
+
+            unsigned code_len(size_t symbol) const noexcept
+            {
+                return lens[symbol];
+            }
+
+            // finds the symbol whose code's interval contains the given (left aligned) bits
+            size_t decode(uint32_t bits) const noexcept
+            {
+                return std::upper_bound(codes, codes + symbols_num, bits) - codes - 1;
+            }
+
+        private:
+
+            uint32_t codes[symbols_num];
+            uint8_t lens[symbols_num];
+
+            void assign(size_t lo, size_t hi, uint32_t prefix, unsigned depth, const uint64_t* cum_weights)
+            {
+                if (hi - lo == 1)
+                {
+                    codes[lo] = prefix;
+                    lens[lo] = (uint8_t)depth;
+                    return;
+                }
+                // each side must be small enough to be coded using the bits left
+                const size_t side_cap = size_t{1} << (max_code_len - depth - 1);
+                const size_t first = std::max(lo + 1, hi > side_cap ? hi - side_cap : lo + 1);
+                const size_t last = std::min(hi - 1, lo + side_cap);
+                const uint64_t total = cum_weights[hi] - cum_weights[lo];
+                size_t split = first;
+                uint64_t best_diff = UINT64_MAX;
+                for (size_t k = first; k <= last; ++k)
+                {
+                    const uint64_t left = 2 * (cum_weights[k] - cum_weights[lo]);
+                    const uint64_t diff = left > total ? left - total : total - left;
+                    if (diff < best_diff)
+                    {
+                        best_diff = diff;
+                        split = k;
+                    }
+                }
+                assign(lo, split, prefix, depth + 1, cum_weights);
+                assign(split, hi, prefix | (uint32_t{1} << (31 - depth)), depth + 1, cum_weights);
+            }
+
+        };
+    }
+
+    //
+    // A prefix encoding trained on a sample of the keys, in the spirit of HOPE's single character scheme: each
+    // character is replaced by an order preserving variable length code, so a skewed character distribution lets
+    // many more characters fit into the prefix, while comparisons remain exactly lexicographic.
+    // The code table is shared by all keydomets using the same Tag, including find keys, hence train() must be
+    // called before such keydomets are constructed, and not concurrently with their use. Until trained, all
+    // characters are assumed to be equally likely. Prefixes of up to 64 bits are supported.
+    //
+    template<class Tag = void>
+    class trained_encoding
+    {
+
+        using table_type = imp::alphabetic_code_table;
+
+    public:
+
+        // the number of leading characters sampled from each key - later characters rarely make it into the prefix
+        static constexpr size_t head_len = 24;
+
+        template<class Iter>
+        static void train(Iter first, Iter last)
+        {
+            uint64_t weights[table_type::symbols_num];
+            std::fill(weights, weights + table_type::symbols_num, 1); // symbols missing from the sample still need codes
+            for (; first != last; ++first)
+            {
+                const char* chars = get_raw_str(*first);
+                const size_t len = imp::chars_len(*first, head_len);
+                for (size_t i = 0; i < len && i < head_len; ++i)
+                    ++weights[table_type::symbol_of(chars[i])];
+                if (len < head_len)
+                    ++weights[0];
+            }
+            table() = table_type{weights};
+            is_trained() = true;
+        }
+
+        static bool trained()
+        {
+            return is_trained();
+        }
+
+        template<typename PrefixT, typename StrImp>
+        static PrefixT encode(const StrImp& str)
+        {
+            static_assert(std::is_unsigned<PrefixT>::value, "Trained encodings support prefixes of up to 64 bits");
+            constexpr unsigned width = 8 * sizeof(PrefixT);
+            const table_type& codes = table();
+            const char* chars = get_raw_str(str);
+            const size_t len = imp::chars_len(str, width); // every code takes at least a bit
+            uint64_t val = 0;
+            unsigned used = 0;
+            for (size_t i = 0; i < len && used < width; ++i)
+            {
+                const size_t symbol = table_type::symbol_of(chars[i]);
+                // a code crossing the prefix's end is truncated
+                val |= ((uint64_t)codes.code(symbol) << 32) >> used;
+                used += codes.code_len(symbol);
+            }
+            // the end of string code is all zeros, as is the padding following it
+            return static_cast<PrefixT>(val >> (64 - width));
+        }
+
+        template<typename PrefixT>
+        static tie_info on_tie(const PrefixT& val)
+        {
+            constexpr unsigned width = 8 * sizeof(PrefixT);
+            const table_type& codes = table();
+            const uint64_t bits = (uint64_t)val << (64 - width);
+            unsigned used = 0;
+            size_t chars = 0;
+            while (used < width)
+            {
+                const size_t symbol = codes.decode((uint32_t)((bits << used) >> 32));
+                if (used + codes.code_len(symbol) > width)
+                    break; // truncated code - the character may differ
+                if (symbol == 0)
+                    return {true, chars};
+                used += codes.code_len(symbol);
+                ++chars;
+            }
+            return {false, chars};
+        }
+
+        template<typename NarrowT, typename WideT>
+        static NarrowT narrow(const WideT& val)
+        {
+            // encoding stops at the prefix's end, truncating the last code - just as narrowing does
+            return imp::narrow_prefix<NarrowT>(val);
+        }
+
+    private:
+
+        static table_type& table()
+        {
+            static table_type codes{uniform_weights()};
+            return codes;
+        }
+
+        static bool& is_trained()
+        {
+            static bool trained_flag = false;
+            return trained_flag;
+        }
+
+        static const uint64_t* uniform_weights()
+        {
+            static uint64_t weights[table_type::symbols_num];
+            std::fill(weights, weights + table_type::symbols_num, 1);
+            return weights;
+        }
+
+    };
+
+}
+
+#endif //KEYDOMET_TRAINEDENCODING_H
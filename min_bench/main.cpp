@@ -20,7 +20,7 @@ using namespace kdmt;
 constexpr auto keydomet_size_to_use = prefix_size::SIZE_32BIT;
 //constexpr auto keydomet_size_to_use = prefix_size::SIZE_16BIT;
 
-using keydomet_str = keydomet<std::string, keydomet_size_to_use>;
+using keydomet_str = keydomet<std::string, keydomet_size_to_use, atomic_stats<>>;
 
 using kdmt_set = set<keydomet_str, less<>>;
 
@@ -44,11 +44,12 @@ vector<string> get_input(size_t keys_num, size_t key_len)
     return input;
 }
 
-template<template<class, typename...> class Container, typename StrT, prefix_size Size, typename... ContainerArgs>
-void build_container(Container<keydomet<StrT, Size>, ContainerArgs...>& container, const vector<string>& input)
+template<template<class, typename...> class Container, typename StrT, prefix_size Size, class Stats,
+        typename... ContainerArgs>
+void build_container(Container<keydomet<StrT, Size, Stats>, ContainerArgs...>& container, const vector<string>& input)
 {
     transform(input.begin(), input.end(), std::inserter(container, container.begin()), [](const string& str) {
-        return keydomet<StrT, Size>{str};
+        return keydomet<StrT, Size, Stats>{str};
     });
 }
 
@@ -92,12 +93,14 @@ void benchmark(const vector<string>& input, const vector<string>& lookups)
     build_container(pkc, input);
     build_container(ssc, input);
     cout << "running series of " << lookups.size() << " lookups..." << endl;
+    keydomet_str::reset_stats();
     timer_ms timer(timer_start::Now);
     for (const string& s : lookups)
         lookup(pkc, s);
     auto elapsed = timer.elapsed_str();
     cout << "prefixed strings: " << elapsed << endl;
-    cout << "\tused keydomet: " << keydomet_str::used_prefix() << ", used str: " << keydomet_str::used_string() << endl;
+    const compare_stats stats = keydomet_str::get_stats();
+    cout << "\tused keydomet: " << stats.used_prefix << ", used str: " << stats.used_string << endl;
     timer.start();
     for (const string& s : lookups)
         lookup(ssc, s);
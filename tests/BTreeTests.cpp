@@ -0,0 +1,212 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "BTree.h"
+#include "Kstring.h"
+
+#include "TestUtils.h"
+#include "catch.hpp"
+
+#include <set>
+#include <map>
+#include <vector>
+#include <string>
+#include <iterator>
+#include <algorithm>
+#include <random>
+
+using namespace kdmt;
+using namespace std;
+using namespace test_utils;
+
+namespace
+{
+    template<class KdmtStr, class Slots>
+    void require_set_ops(mt19937& gen)
+    {
+        using kdm_set_type = btree_set<KdmtStr, Slots>;
+        const vector<string> org_vals = random_keys(3000, gen);
+        kdm_set_type kdm_set;
+        set<string> str_set;
+        for (size_t i = 0; i < org_vals.size(); i += 2)
+        {
+            const bool inserted = kdm_set.emplace(in_place, org_vals[i]).second;
+            REQUIRE(inserted == str_set.insert(org_vals[i]).second);
+        }
+        require_same_keys(kdm_set, str_set);
+        require_same_search(kdm_set, str_set, org_vals);
+        // erasing by key and by iterator, till the tree empties
+        for (size_t i = 0; i < org_vals.size(); i += 3)
+            REQUIRE(kdm_set.erase(KdmtStr{org_vals[i]}) == str_set.erase(org_vals[i]));
+        require_same_keys(kdm_set, str_set);
+        require_same_search(kdm_set, str_set, org_vals);
+        const kdm_set_type copy{kdm_set};
+        REQUIRE(copy == kdm_set);
+        for (auto iter = kdm_set.begin(); iter != kdm_set.end();)
+        {
+            const string key = str_of(iter->get_str());
+            iter = kdm_set.erase(iter);
+            auto str_iter = str_set.erase(str_set.find(key));
+            REQUIRE((iter == kdm_set.end()) == (str_iter == str_set.end()));
+            if (iter != kdm_set.end())
+                REQUIRE(str_of(iter->get_str()) == *str_iter);
+        }
+        require_same_keys(kdm_set, str_set);
+        REQUIRE(kdm_set.begin() == kdm_set.end());
+        // the copy isn't affected, and can be inserted to again
+        REQUIRE(copy.size() > 0);
+        kdm_set = copy;
+        for (const string& val : org_vals)
+            kdm_set.emplace(val);
+        REQUIRE(kdm_set.size() == set<string>(org_vals.begin(), org_vals.end()).size());
+    }
+}
+
+TEST_CASE("B+-tree sets hold sorted keys", "[btree]")
+{
+    mt19937 gen{random_device{}()};
+    // small nodes split and empty often
+    require_set_ops<keydomet<string, prefix_size::SIZE_32BIT>, btree_slots<4>>(gen);
+    require_set_ops<keydomet<string, prefix_size::SIZE_32BIT>, btree_slots<5>>(gen);
+    require_set_ops<keydomet<string, prefix_size::SIZE_16BIT>, btree_slots<32>>(gen);
+    require_set_ops<keydomet<string, prefix_size::SIZE_64BIT>, btree_slots<16>>(gen);
+    require_set_ops<keydomet<string, prefix_size::SIZE_128BIT>, btree_slots<8>>(gen);
+    require_set_ops<keydomet<string, prefix_bytes(6)>, btree_slots<8>>(gen);
+    require_set_ops<keydomet<kstring, prefix_size::SIZE_64BIT>, btree_slots<32>>(gen);
+    require_set_ops<keydomet<string, prefix_size::SIZE_32BIT, no_stats, binary_encoding>, btree_slots<8>>(gen);
+}
+
+TEST_CASE("B+-tree sets are built from sorted and unsorted ranges", "[btree]")
+{
+    mt19937 gen{random_device{}()};
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    vector<string> org_vals = random_keys(2000, gen);
+    const set<string> str_set{org_vals.begin(), org_vals.end()};
+    const btree_set<kdmt_str, btree_slots<8>> unsorted{org_vals.begin(), org_vals.end()};
+    require_same_keys(unsorted, str_set);
+    const btree_set<kdmt_str, btree_slots<8>> sorted{str_set.begin(), str_set.end()};
+    require_same_keys(sorted, str_set);
+    require_same_search(sorted, str_set, org_vals);
+    REQUIRE(sorted == unsorted);
+    const btree_set<kdmt_str> listed{kdmt_str{"b"}, kdmt_str{"a"}, kdmt_str{"b"}};
+    REQUIRE(listed.size() == 2);
+    REQUIRE(listed.begin()->get_str() == "a");
+}
+
+namespace
+{
+    // a string whose copies fail while copies_fail is set, as allocating ones may
+    struct fragile_string : string
+    {
+        fragile_string(const string& s) : string{s} {}
+        fragile_string(const fragile_string& other) : string{copied(other)} {}
+        fragile_string(fragile_string&&) noexcept = default;
+        fragile_string& operator=(const fragile_string&) = default;
+        fragile_string& operator=(fragile_string&&) = default;
+
+        static const string& copied(const fragile_string& s)
+        {
+            if (copies_fail)
+                throw bad_alloc();
+            return s;
+        }
+
+        static bool copies_fail;
+    };
+
+    bool fragile_string::copies_fail = false;
+}
+
+TEST_CASE("B+-tree sets are left as they were when copying a separator throws", "[btree]")
+{
+    using kdmt_str = keydomet<fragile_string, prefix_size::SIZE_32BIT>;
+    mt19937 gen{random_device{}()};
+    const vector<string> org_vals = random_keys(3000, gen);
+    btree_set<kdmt_str, btree_slots<4>> kdm_set;
+    set<string> str_set;
+    size_t failed = 0;
+    for (const string& val : org_vals)
+    {
+        // inserting into a full leaf copies a key into its parent, which fails the first time
+        fragile_string::copies_fail = true;
+        bool inserted;
+        try
+        {
+            inserted = kdm_set.emplace(in_place, val).second;
+        }
+        catch (const bad_alloc&)
+        {
+            ++failed;
+            fragile_string::copies_fail = false;
+            require_same_keys(kdm_set, str_set);
+            inserted = kdm_set.emplace(in_place, val).second;
+        }
+        fragile_string::copies_fail = false;
+        REQUIRE(inserted == str_set.insert(val).second);
+    }
+    REQUIRE(failed > 0);
+    require_same_keys(kdm_set, str_set);
+    require_same_search(kdm_set, str_set, org_vals);
+}
+
+TEST_CASE("B+-tree lookups compare strings only on prefix ties", "[btree]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT, atomic_stats<>>;
+    btree_set<kdmt_str> kdm_set;
+    for (int i = 0; i < 10000; ++i)
+        kdm_set.emplace(to_string(i * 10));
+    REQUIRE(kdm_set.size() == 10000);
+    // lookups of keys whose prefixes differ from all others decide every node using the prefixes
+    kdmt_str::reset_stats();
+    const string unique_prefix{"abcd"};
+    REQUIRE(kdm_set.find(make_find_key(kdm_set, unique_prefix)) == kdm_set.end());
+    REQUIRE(kdmt_str::get_stats().used_string == 0);
+    // keys sharing a prefix are told apart using the strings
+    kdmt_str::reset_stats();
+    REQUIRE(kdm_set.find(make_find_key(kdm_set, string{"12345"})) == kdm_set.end());
+    REQUIRE(kdm_set.find(make_find_key(kdm_set, string{"12340"})) != kdm_set.end());
+    REQUIRE(kdmt_str::get_stats().used_string > 0);
+}
+
+TEST_CASE("B+-tree maps", "[btree]")
+{
+    mt19937 gen{random_device{}()};
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    const vector<string> org_vals = random_keys(3000, gen);
+    btree_map<kdmt_str, size_t, btree_slots<6>> kdm_map;
+    map<string, size_t> str_map;
+    for (size_t i = 0; i < org_vals.size(); ++i)
+    {
+        kdm_map[kdmt_str{org_vals[i]}] += i;
+        str_map[org_vals[i]] += i;
+    }
+    REQUIRE(kdm_map.size() == str_map.size());
+    REQUIRE(equal(kdm_map.begin(), kdm_map.end(), str_map.begin(), str_map.end(),
+                  [](const pair<const kdmt_str, size_t>& k, const pair<const string, size_t>& s) {
+                      return k.first.get_str() == s.first && k.second == s.second;
+                  }));
+    for (const auto& val : str_map)
+        REQUIRE(kdm_map.at(make_find_key(kdm_map, val.first)) == val.second);
+    REQUIRE_THROWS_AS(kdm_map.at(make_find_key(kdm_map, string{"missing"})), std::out_of_range);
+    // inserting existing keys keeps their values
+    REQUIRE(!kdm_map.insert({kdmt_str{str_map.begin()->first}, 0}).second);
+    REQUIRE(!kdm_map.try_emplace(kdmt_str{str_map.begin()->first}, 0).second);
+    REQUIRE(kdm_map.begin()->second == str_map.begin()->second);
+    REQUIRE(kdm_map.emplace(piecewise_construct, forward_as_tuple(in_place, "missing"), forward_as_tuple(7)).second);
+    REQUIRE(kdm_map.at(make_find_key(kdm_map, string{"missing"})) == 7);
+    // the values move along with their keys as nodes split and empty
+    auto from = kdm_map.lower_bound(make_find_key(kdm_map, string{"b"}));
+    auto to = kdm_map.lower_bound(make_find_key(kdm_map, string{"head"}));
+    kdm_map.erase(from, to);
+    str_map.erase(str_map.lower_bound("b"), str_map.lower_bound("head"));
+    kdm_map.erase(kdm_map.find(make_find_key(kdm_map, string{"missing"})));
+    const auto moved{std::move(kdm_map)};
+    REQUIRE(kdm_map.empty());
+    REQUIRE(moved.size() == str_map.size());
+    REQUIRE(equal(moved.begin(), moved.end(), str_map.begin(), str_map.end(),
+                  [](const pair<const kdmt_str, size_t>& k, const pair<const string, size_t>& s) {
+                      return k.first.get_str() == s.first && k.second == s.second;
+                  }));
+}
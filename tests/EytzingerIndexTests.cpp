@@ -0,0 +1,97 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "EytzingerIndex.h"
+
+#include "TestUtils.h"
+#include "catch.hpp"
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+
+using namespace kdmt;
+using namespace std;
+using namespace test_utils;
+
+TEST_CASE("Eytzinger indexes, all sizes", "[eytzinger]")
+{
+    // complete and incomplete trees of every depth up to 8
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    vector<string> keys;
+    for (size_t size = 0; size <= 300; ++size)
+    {
+        CAPTURE(size);
+        vector<string> sorted{keys};
+        sort(sorted.begin(), sorted.end());
+        const vector<kdmt_str> kdmt_keys{sorted.begin(), sorted.end()};
+        const auto index = make_eytzinger_index(kdmt_keys);
+        vector<string> probes{sorted};
+        for (const string& key : sorted)
+            probes.push_back(key + "!");
+        probes.push_back("");
+        probes.push_back("~");
+        require_same_positions(index, sorted, probes);
+        keys.push_back(to_string(size * 7));
+    }
+}
+
+TEST_CASE("Eytzinger indexes resolve prefix ties using the keys", "[eytzinger]")
+{
+    mt19937 gen{random_device{}()};
+    vector<string> sorted = random_keys(5000, gen);
+    sort(sorted.begin(), sorted.end());
+    sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+    const vector<string> probes = random_keys(5000, gen);
+    // any random access range of keydomets
+    const deque<keydomet<string, prefix_size::SIZE_32BIT>> kdmt_keys{sorted.begin(), sorted.end()};
+    const auto index = make_eytzinger_index(kdmt_keys.begin(), kdmt_keys.end());
+    require_same_positions(index, sorted, probes);
+    // copies have a layout of their own
+    auto copy = index;
+    require_same_positions(copy, sorted, probes);
+    const auto moved = std::move(copy);
+    require_same_positions(moved, sorted, probes);
+}
+
+TEST_CASE("Eytzinger indexes of other prefix sizes", "[eytzinger]")
+{
+    mt19937 gen{random_device{}()};
+    vector<string> sorted = random_keys(3000, gen);
+    sort(sorted.begin(), sorted.end());
+    sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+    const vector<string> probes = random_keys(3000, gen);
+    const vector<keydomet<string, prefix_size::SIZE_16BIT>> keys16{sorted.begin(), sorted.end()};
+    const vector<keydomet<string, prefix_size::SIZE_128BIT>> keys128{sorted.begin(), sorted.end()};
+    const vector<keydomet<string, prefix_bytes(6)>> keys6{sorted.begin(), sorted.end()};
+    const auto index16 = make_eytzinger_index(keys16);
+    const auto index128 = make_eytzinger_index(keys128);
+    const auto index6 = make_eytzinger_index(keys6);
+    for (const string& probe : probes)
+    {
+        const size_t lower = static_cast<size_t>(lower_bound(sorted.begin(), sorted.end(), probe) - sorted.begin());
+        REQUIRE(index16.lower_bound(keydomet<const string&, prefix_size::SIZE_16BIT>{probe}) == lower);
+        REQUIRE(index128.lower_bound(keydomet<const string&, prefix_size::SIZE_128BIT>{probe}) == lower);
+        REQUIRE(index6.lower_bound(keydomet<const string&, prefix_bytes(6)>{probe}) == lower);
+    }
+}
+
+TEST_CASE("Eytzinger index lookups read strings only on prefix ties", "[eytzinger]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT, atomic_stats<>>;
+    using kdmt_view = keydomet<const string&, prefix_size::SIZE_32BIT, atomic_stats<>>;
+    const vector<string> keys = digit_keys();
+    const vector<kdmt_str> kdmt_keys{keys.begin(), keys.end()};
+    const auto index = make_eytzinger_index(kdmt_keys);
+    require_strings_read_on_ties<kdmt_str>([&](const string& key) { return index.contains(kdmt_view{key}); });
+    // keys sharing their prefixes are searched, rather than scanned
+    const vector<string> tied = tied_keys();
+    const vector<kdmt_str> kdmt_tied{tied.begin(), tied.end()};
+    const auto tied_index = make_eytzinger_index(kdmt_tied);
+    require_same_positions(tied_index, tied, tied_probes());
+    require_few_string_reads<kdmt_str>([&](const string& key) { return tied_index.contains(kdmt_view{key}); });
+}
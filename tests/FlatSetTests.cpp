@@ -0,0 +1,236 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "FlatSet.h"
+
+#include "TestUtils.h"
+#include "catch.hpp"
+
+#include <set>
+#include <map>
+#include <vector>
+#include <string>
+#include <iterator>
+#include <algorithm>
+#include <random>
+
+using namespace kdmt;
+using namespace std;
+using namespace test_utils;
+
+namespace
+{
+    template<class KdmtStr>
+    void require_set_ops(mt19937& gen)
+    {
+        const vector<string> org_vals = random_keys(3000, gen);
+        // built from unsorted keys holding duplicates
+        const vector<string> first_half{org_vals.begin(), org_vals.begin() + org_vals.size() / 2};
+        flat_set<KdmtStr> kdm_set{first_half.begin(), first_half.end()};
+        set<string> str_set{first_half.begin(), first_half.end()};
+        require_same_keys(kdm_set, str_set);
+        require_same_search(kdm_set, str_set, org_vals);
+        // merged with a batch of keys, some of which are held already
+        kdm_set.insert(org_vals.begin() + org_vals.size() / 4, org_vals.end());
+        str_set.insert(org_vals.begin() + org_vals.size() / 4, org_vals.end());
+        require_same_keys(kdm_set, str_set);
+        require_same_search(kdm_set, str_set, org_vals);
+        // single keys
+        for (size_t i = 0; i < org_vals.size(); i += 3)
+            REQUIRE(kdm_set.erase(KdmtStr{org_vals[i]}) == str_set.erase(org_vals[i]));
+        for (size_t i = 0; i < org_vals.size(); i += 7)
+            REQUIRE(kdm_set.emplace(org_vals[i]).second == str_set.insert(org_vals[i]).second);
+        require_same_keys(kdm_set, str_set);
+        require_same_search(kdm_set, str_set, org_vals);
+        const auto from = kdm_set.lower_bound(make_find_key(kdm_set, string{"b"}));
+        const auto to = kdm_set.lower_bound(make_find_key(kdm_set, string{"head"}));
+        kdm_set.erase(from, to);
+        str_set.erase(str_set.lower_bound("b"), str_set.lower_bound("head"));
+        require_same_keys(kdm_set, str_set);
+        require_same_search(kdm_set, str_set, org_vals);
+        // sorted keys are taken as they are
+        const flat_set<KdmtStr> sorted{sorted_unique, kdm_set.begin(), kdm_set.end()};
+        REQUIRE(sorted == kdm_set);
+    }
+}
+
+TEST_CASE("flat sets hold sorted keys", "[flat set]")
+{
+    mt19937 gen{random_device{}()};
+    require_set_ops<keydomet<string, prefix_size::SIZE_16BIT>>(gen);
+    require_set_ops<keydomet<string, prefix_size::SIZE_32BIT>>(gen);
+    require_set_ops<keydomet<string, prefix_size::SIZE_64BIT>>(gen);
+    require_set_ops<keydomet<string, prefix_size::SIZE_128BIT>>(gen);
+    require_set_ops<keydomet<string, prefix_bytes(3)>>(gen);
+    require_set_ops<keydomet<string, prefix_size::SIZE_32BIT, no_stats, binary_encoding>>(gen);
+}
+
+TEST_CASE("flat set lookups, all sizes", "[flat set]")
+{
+    // the binary search hands the last prefixes to a scan, whose bounds are checked using every size
+    using kdmt_str = keydomet<string, prefix_size::SIZE_16BIT>;
+    vector<string> keys;
+    for (size_t size = 0; size <= 200; ++size)
+    {
+        CAPTURE(size);
+        const flat_set<kdmt_str> kdm_set{keys.begin(), keys.end()};
+        const set<string> str_set{keys.begin(), keys.end()};
+        vector<string> probes{keys};
+        for (const string& key : keys)
+            probes.push_back(key + "!");
+        probes.push_back("");
+        probes.push_back("~");
+        require_same_keys(kdm_set, str_set);
+        require_same_search(kdm_set, str_set, probes);
+        keys.push_back(string(1, char('0' + size % 64)) + to_string(size));
+    }
+}
+
+TEST_CASE("flat set lookups read strings only on prefix ties", "[flat set]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT, atomic_stats<>>;
+    const vector<string> keys = digit_keys();
+    const flat_set<kdmt_str> kdm_set{keys.begin(), keys.end()};
+    require_strings_read_on_ties<kdmt_str>([&](const string& key) {
+        return kdm_set.contains(make_find_key(kdm_set, key));
+    });
+    // keys sharing their prefixes are searched, rather than scanned
+    const vector<string> tied = tied_keys();
+    const flat_set<kdmt_str> tied_set{tied.begin(), tied.end()};
+    require_same_keys(tied_set, set<string>{tied.begin(), tied.end()});
+    require_few_string_reads<kdmt_str>([&](const string& key) {
+        return tied_set.contains(make_find_key(tied_set, key));
+    });
+}
+
+TEST_CASE("flat maps", "[flat set]")
+{
+    mt19937 gen{random_device{}()};
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    const vector<string> org_vals = random_keys(3000, gen);
+    vector<pair<kdmt_str, size_t>> pairs;
+    for (size_t i = 0; i < org_vals.size() / 2; ++i)
+        pairs.emplace_back(kdmt_str{org_vals[i]}, i);
+    // the first of equal keys is kept, as done by std::map
+    flat_map<kdmt_str, size_t> kdm_map{pairs.begin(), pairs.end()};
+    map<string, size_t> str_map;
+    for (size_t i = 0; i < org_vals.size() / 2; ++i)
+        str_map.emplace(org_vals[i], i);
+    auto require_same = [&] {
+        REQUIRE(kdm_map.size() == str_map.size());
+        REQUIRE(equal(kdm_map.begin(), kdm_map.end(), str_map.begin(), str_map.end(),
+                      [](const pair<const kdmt_str&, const size_t&>& k, const pair<const string, size_t>& s) {
+                          return k.first.get_str() == s.first && k.second == s.second;
+                      }));
+        for (const auto& val : str_map)
+            REQUIRE(kdm_map.at(make_find_key(kdm_map, val.first)) == val.second);
+    };
+    require_same();
+    // merging keeps the values already held
+    pairs.clear();
+    for (size_t i = org_vals.size() / 4; i < org_vals.size(); ++i)
+        pairs.emplace_back(kdmt_str{org_vals[i]}, i);
+    kdm_map.insert(pairs.begin(), pairs.end());
+    for (size_t i = org_vals.size() / 4; i < org_vals.size(); ++i)
+        str_map.emplace(org_vals[i], i);
+    require_same();
+    for (size_t i = 0; i < org_vals.size(); i += 5)
+    {
+        kdm_map[kdmt_str{org_vals[i]}] += 1;
+        str_map[org_vals[i]] += 1;
+    }
+    require_same();
+    REQUIRE_THROWS_AS(kdm_map.at(make_find_key(kdm_map, string{"missing"})), std::out_of_range);
+    REQUIRE(kdm_map.emplace(kdmt_str{"missing"}, 7).second);
+    REQUIRE(!kdm_map.try_emplace(kdmt_str{"missing"}, 8).second);
+    REQUIRE(kdm_map.find(make_find_key(kdm_map, string{"missing"}))->second == 7);
+    REQUIRE(kdm_map.erase(kdmt_str{"missing"}) == 1);
+    auto from = kdm_map.lower_bound(make_find_key(kdm_map, string{"b"}));
+    auto to = kdm_map.lower_bound(make_find_key(kdm_map, string{"head"}));
+    kdm_map.erase(from, to);
+    str_map.erase(str_map.lower_bound("b"), str_map.lower_bound("head"));
+    require_same();
+    REQUIRE(kdm_map.get_keys().size() == kdm_map.get_values().size());
+}
+
+TEST_CASE("flat maps of bools", "[flat set]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    flat_map<kdmt_str, bool> kdm_map;
+    map<string, bool> str_map;
+    for (int i = 0; i < 1000; ++i)
+    {
+        const string key = to_string(i % 300);
+        kdm_map[kdmt_str{key}] = i % 3 == 0;
+        str_map[key] = i % 3 == 0;
+    }
+    kdm_map.insert({{kdmt_str{string{"a"}}, true}, {kdmt_str{string{"0"}}, false}});
+    str_map.insert({{"a", true}, {"0", false}});
+    kdm_map.emplace(kdmt_str{string{"b"}}, true);
+    str_map.emplace("b", true);
+    // values are referenced like those of a std::map
+    bool& flag = kdm_map.at(make_find_key(kdm_map, string{"7"}));
+    flag = !flag;
+    str_map["7"] = !str_map["7"];
+    kdm_map.begin()->second = true;
+    str_map.begin()->second = true;
+    REQUIRE(equal(kdm_map.begin(), kdm_map.end(), str_map.begin(), str_map.end(),
+                  [](const pair<const kdmt_str&, const bool&>& k, const pair<const string, bool>& s) {
+                      return k.first.get_str() == s.first && k.second == s.second;
+                  }));
+    const flat_map<kdmt_str, bool> copy{kdm_map};
+    REQUIRE(copy == kdm_map);
+    kdm_map.erase(kdmt_str{string{"7"}});
+    REQUIRE(copy != kdm_map);
+    REQUIRE(kdm_map.get_values().size() == kdm_map.size());
+}
+
+namespace
+{
+    // a value whose construction fails for negative numbers
+    struct picky_value
+    {
+        explicit picky_value(int val) : v{val}
+        {
+            if (val < 0)
+                throw invalid_argument("negative");
+        }
+
+        int v;
+    };
+}
+
+TEST_CASE("flat maps stay consistent when an insertion throws", "[flat set]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    flat_map<kdmt_str, picky_value> kdm_map;
+    map<string, int> str_map;
+    for (int i = 0; i < 500; ++i)
+    {
+        const string key = to_string(i * 7 % 500);
+        const int val = i % 5 == 0 ? -1 : i;
+        if (val < 0)
+        {
+            REQUIRE_THROWS_AS(kdm_map.try_emplace(kdmt_str{key}, val), invalid_argument);
+            REQUIRE_THROWS_AS(kdm_map.emplace(piecewise_construct, forward_as_tuple(key), forward_as_tuple(val)),
+                              invalid_argument);
+        }
+        else
+        {
+            REQUIRE(kdm_map.try_emplace(kdmt_str{key}, val).second);
+            str_map.emplace(key, val);
+        }
+    }
+    REQUIRE(kdm_map.size() == str_map.size());
+    REQUIRE(kdm_map.get_values().size() == str_map.size());
+    for (const auto& val : str_map)
+    {
+        const auto iter = kdm_map.find(make_find_key(kdm_map, val.first));
+        REQUIRE(iter != kdm_map.end());
+        REQUIRE(iter->first.get_str() == val.first);
+        REQUIRE(iter->second.v == val.second);
+    }
+    REQUIRE(kdm_map.find(make_find_key(kdm_map, string{"0"})) == kdm_map.end());
+}
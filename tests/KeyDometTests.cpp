@@ -14,6 +14,9 @@
 #include <algorithm>
 #include <random>
 #include <sstream>
+#include <thread>
+#include <memory>
+#include <array>
 
 #if (__cplusplus < 201703L) && !(defined(__clang__) && __clang_major__ > 7)
     #include <experimental/string_view>
@@ -30,6 +33,31 @@ using prefix4B = prefix_storage<prefix_size::SIZE_32BIT>;
 using prefix8B = prefix_storage<prefix_size::SIZE_64BIT>;
 using prefix16B = prefix_storage<prefix_size::SIZE_128BIT>;
 
+static int signum(int v)
+{
+    return (v > 0) - (v < 0);
+}
+
+// a string counting the allocations of its buffers, for verifying keys aren't copied behind the scenes
+static size_t string_allocations = 0;
+
+template<class T>
+struct counting_allocator : allocator<T>
+{
+    template<class U> struct rebind { using other = counting_allocator<U>; };
+
+    counting_allocator() = default;
+    template<class U> counting_allocator(const counting_allocator<U>&) {}
+
+    T* allocate(size_t n)
+    {
+        ++string_allocations;
+        return allocator<T>::allocate(n);
+    }
+};
+
+using counted_string = basic_string<char, char_traits<char>, counting_allocator<char>>;
+
 TEST_CASE("Verify sizes", "[keydomet]")
 {
     REQUIRE(sizeof(prefix2B::type) == 2);
@@ -102,6 +130,48 @@ TEST_CASE("str_to_prefix, 16B, std::string", "[str_to_prefix]")
     REQUIRE((char)(prefix.msbs >> (8 * 7)) == '0');
 }
 
+template<typename PrefixT>
+static void verify_sized_matches_scanned(const char* buf, size_t max_len)
+{
+    for (size_t len = 0; len <= max_len; ++len)
+    {
+        string str(buf, len);
+        CAPTURE(len);
+        REQUIRE((str_to_prefix<PrefixT>(str) == str_to_prefix<PrefixT>(str.c_str())));
+    }
+}
+
+TEST_CASE("str_to_prefix, length-aware matches scanning, all sizes", "[str_to_prefix]")
+{
+    const char* buf = "0123456789abcdefghij";
+    verify_sized_matches_scanned<prefix2B::type>(buf, 20);
+    verify_sized_matches_scanned<prefix4B::type>(buf, 20);
+    verify_sized_matches_scanned<prefix8B::type>(buf, 20);
+    verify_sized_matches_scanned<prefix16B::type>(buf, 20);
+}
+
+TEST_CASE("str_to_prefix, short string is padded with zeros", "[str_to_prefix]")
+{
+    string str = "01";
+    auto prefix = str_to_prefix<prefix8B::type>(str);
+    REQUIRE(prefix == ((prefix8B::type)'0' << (8 * 7) | (prefix8B::type)'1' << (8 * 6)));
+}
+
+TEST_CASE("str_to_prefix, short string at the end of a page", "[str_to_prefix]")
+{
+    constexpr size_t page = 4096;
+    vector<char> buf(3 * page, 'x');
+    char* page_end = (char*)(((uintptr_t)buf.data() + 2 * page) & ~(uintptr_t)(page - 1));
+    for (size_t len = 0; len < sizeof(prefix16B::type); ++len)
+    {
+        string_view str{page_end - len, len};
+        string copy{str.data(), str.size()};
+        CAPTURE(len);
+        REQUIRE((str_to_prefix<prefix4B::type>(str) == str_to_prefix<prefix4B::type>(copy.c_str())));
+        REQUIRE((str_to_prefix<prefix16B::type>(str) == str_to_prefix<prefix16B::type>(copy.c_str())));
+    }
+}
+
 TEST_CASE("flip_bytes, 2B", "[flip_bytes]")
 {
     prefix2B::type prefix = 0x0011;
@@ -339,6 +409,36 @@ TEST_CASE("compare k1 > k2, short keys, 4B", "[keydomet]")
     REQUIRE(res > 0);
 }
 
+TEST_CASE("compare k1 < k2, diff at suffix, sized strings, 4B", "[keydomet]")
+{
+    keydomet<string, prefix_size::SIZE_32BIT> k1{string{"kkkkkkkk"}}, k2{string{"kkkkkkkl"}};
+    REQUIRE(k1.compare(k2) < 0);
+    REQUIRE(k2.compare(k1) > 0);
+}
+
+TEST_CASE("compare k1 < k2, k1 is a prefix of k2, sized strings, 4B", "[keydomet]")
+{
+    keydomet<string, prefix_size::SIZE_32BIT> k1{string{"kkkkkk"}}, k2{string{"kkkkkkk"}};
+    REQUIRE(k1.compare(k2) < 0);
+    REQUIRE(k2.compare(k1) > 0);
+}
+
+TEST_CASE("compare equal keys, exactly prefix long, sized strings, 4B", "[keydomet]")
+{
+    keydomet<string, prefix_size::SIZE_32BIT> k1{string{"kkkk"}}, k2{string{"kkkk"}};
+    REQUIRE(k1.compare(k2) == 0);
+}
+
+TEST_CASE("compare string with string_view, diff at suffix, 8B", "[keydomet]")
+{
+    string s1{"kkkkkkkkkkkka"}, s2{"kkkkkkkkkkkkb"};
+    keydomet<string, prefix_size::SIZE_64BIT> k1{s1};
+    keydomet<string_view, prefix_size::SIZE_64BIT> k2{string_view{s2}};
+    REQUIRE(k1.compare(k2) < 0);
+    REQUIRE(k2.compare(k1) > 0);
+    REQUIRE(k1.compare(keydomet<string_view, prefix_size::SIZE_64BIT>{string_view{s1}}) == 0);
+}
+
 TEST_CASE("operator< k1 < k2, 4B", "[keydomet]")
 {
     keydomet<const char*, prefix_size::SIZE_32BIT> k1{"kkkkk"}, k2{"lllll"};
@@ -381,6 +481,92 @@ TEST_CASE("operator== k1 == k2, 4B", "[keydomet]")
     REQUIRE(res == true);
 }
 
+TEST_CASE("no_stats counts nothing", "[stats]")
+{
+    keydomet<string, prefix_size::SIZE_32BIT> k1{string{"aaaaa"}}, k2{string{"aaaab"}};
+    REQUIRE(k1 < k2);
+    compare_stats stats = decltype(k1)::get_stats();
+    REQUIRE(stats.used_prefix == 0);
+    REQUIRE(stats.used_string == 0);
+}
+
+template<class Stats>
+static void verify_stats_counting()
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT, Stats>;
+    kdmt_str::reset_stats();
+    kdmt_str k1{string{"aaaaa"}}, k2{string{"aaaab"}}, k3{string{"bbbbb"}};
+    REQUIRE(k1 < k2);  // prefix collision
+    REQUIRE(k1 < k3);  // decided by prefix
+    REQUIRE(k2 < k3);  // decided by prefix
+    compare_stats stats = kdmt_str::get_stats();
+    REQUIRE(stats.used_prefix == 2);
+    REQUIRE(stats.used_string == 1);
+    kdmt_str::reset_stats();
+    stats = kdmt_str::get_stats();
+    REQUIRE(stats.used_prefix == 0);
+    REQUIRE(stats.used_string == 0);
+}
+
+TEST_CASE("atomic_stats counts comparisons", "[stats]")
+{
+    struct tag {};
+    verify_stats_counting<atomic_stats<tag>>();
+}
+
+TEST_CASE("sharded_stats counts comparisons", "[stats]")
+{
+    struct tag {};
+    verify_stats_counting<sharded_stats<tag>>();
+}
+
+template<class Stats>
+static void verify_stats_counting_threads()
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT, Stats>;
+    kdmt_str::reset_stats();
+    constexpr size_t threads_num = 4, compares_num = 10000;
+    const kdmt_str k1{string{"aaaaa"}}, k2{string{"aaaab"}}, k3{string{"bbbbb"}};
+    vector<thread> threads;
+    for (size_t t = 0; t < threads_num; ++t)
+    {
+        threads.emplace_back([&] {
+            for (size_t i = 0; i < compares_num; ++i)
+            {
+                k1.compare(k2);
+                k1.compare(k3);
+            }
+        });
+    }
+    for (thread& t : threads)
+        t.join();
+    compare_stats stats = kdmt_str::get_stats();
+    REQUIRE(stats.used_prefix == threads_num * compares_num);
+    REQUIRE(stats.used_string == threads_num * compares_num);
+}
+
+TEST_CASE("atomic_stats counts comparisons of multiple threads", "[stats]")
+{
+    struct tag {};
+    verify_stats_counting_threads<atomic_stats<tag>>();
+}
+
+TEST_CASE("sharded_stats counts comparisons of multiple threads", "[stats]")
+{
+    struct tag {};
+    verify_stats_counting_threads<sharded_stats<tag>>();
+}
+
+TEST_CASE("find key uses the container's stats policy", "[make_find_key]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT, atomic_stats<>>;
+    set<kdmt_str, less<>> s;
+    string lookupStr{"dummy"};
+    constexpr bool same_stats = is_same<decltype(make_find_key(s, lookupStr)),
+            keydomet<const string&, prefix_size::SIZE_32BIT, atomic_stats<>>>::value;
+    REQUIRE(same_stats);
+}
+
 TEST_CASE("associative containers take a const str&", "[make_find_key]")
 {
     using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
@@ -402,6 +588,1012 @@ TEST_CASE("associative container key requires no allocation", "[make_find_key]")
     REQUIRE(&ref == &org);
 }
 
+TEST_CASE("string_view key requires no allocation", "[make_find_key]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    set<kdmt_str, less<>> s{string{"request"}, string{"request/path"}};
+    const string buf{"GET request/path HTTP"};
+    const string_view slice = string_view{buf}.substr(4, 12);
+    auto fk = make_find_key(s, slice);
+    REQUIRE(fk.get_str().data() == buf.data() + 4);
+    REQUIRE(s.find(fk) != s.end());
+    REQUIRE(s.find(make_find_key(s, string_view{buf}.substr(4, 7))) != s.end());
+    REQUIRE(s.find(make_find_key(s, string_view{buf}.substr(4, 9))) == s.end());
+}
+
+TEST_CASE("const char* key requires no allocation", "[make_find_key]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_64BIT>;
+    set<kdmt_str, less<>> s{string{"short"}, string{"a key longer than the prefix"}};
+    const char* org = "a key longer than the prefix";
+    auto fk = make_find_key(s, org);
+    static_assert(is_same<decltype(fk), keydomet<const char*, prefix_size::SIZE_64BIT>>::value, "");
+    REQUIRE(fk.get_str() == org);
+    REQUIRE(s.find(fk) != s.end());
+    REQUIRE(s.find(make_find_key(s, "short")) != s.end());
+    REQUIRE(s.find(make_find_key(s, "shorter")) == s.end());
+    char buf[] = "short";
+    REQUIRE(s.find(make_find_key(s, buf)) != s.end());
+}
+
+TEST_CASE("(pointer, length) key requires no allocation", "[make_find_key]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    set<kdmt_str, less<>> s{string{"key"}, string{"key with a suffix"}};
+    const char* buf = "key with a suffix, and more";
+    auto fk = make_find_key(s, buf, 17);
+    static_assert(is_same<decltype(fk), keydomet<chars_view, prefix_size::SIZE_32BIT>>::value, "");
+    REQUIRE(fk.get_str().data() == buf);
+    REQUIRE(s.find(fk) != s.end());
+    REQUIRE(s.find(make_find_key(s, buf, 3)) != s.end());
+    REQUIRE(s.find(make_find_key(s, buf, 4)) == s.end());
+    REQUIRE(s.find(make_find_key(s, buf, 18)) == s.end());
+}
+
+TEST_CASE("keydomets move without copying the string", "[construction]")
+{
+    using kdmt_str = keydomet<counted_string, prefix_size::SIZE_32BIT>;
+    static_assert(is_nothrow_move_constructible<kdmt_str>::value, "");
+    static_assert(is_nothrow_move_assignable<kdmt_str>::value, "");
+    static_assert(is_nothrow_move_constructible<keydomet<deduplicated<>, prefix_size::SIZE_64BIT>>::value, "");
+    counted_string org(100, 'm');
+    const char* chars = org.data();
+    const size_t before = string_allocations;
+    kdmt_str k{std::move(org)};
+    kdmt_str moved{std::move(k)};
+    k = std::move(moved);
+    REQUIRE(string_allocations == before);
+    REQUIRE(k.get_str().data() == chars);
+    REQUIRE(k == keydomet<string, prefix_size::SIZE_32BIT>{string(100, 'm')});
+}
+
+TEST_CASE("growing containers doesn't copy the strings", "[construction]")
+{
+    using kdmt_str = keydomet<counted_string, prefix_size::SIZE_32BIT>;
+    vector<kdmt_str> v;
+    for (size_t i = 0; i < 16; ++i)
+        v.emplace_back(in_place, 100, char('a' + i));
+    vector<const char*> bufs;
+    for (const kdmt_str& k : v)
+        bufs.push_back(k.get_str().data());
+    const size_t before = string_allocations;
+    v.reserve(1024);
+    REQUIRE(string_allocations == before);
+    for (size_t i = 0; i < v.size(); ++i)
+        REQUIRE(v[i].get_str().data() == bufs[i]);
+}
+
+TEST_CASE("emplacing keydomets constructs the string in place", "[construction]")
+{
+    using kdmt_str = keydomet<counted_string, prefix_size::SIZE_64BIT>;
+    set<kdmt_str, less<>> s;
+    const char* chars = "a key too long for short string optimization";
+    size_t before = string_allocations;
+    s.emplace(in_place, chars, strlen(chars));
+    REQUIRE(string_allocations == before + 1);
+    counted_string org{chars};
+    before = string_allocations;
+    s.insert(kdmt_str{std::move(org)});
+    REQUIRE(string_allocations == before);
+    REQUIRE(s.size() == 1);
+    REQUIRE(s.find(make_find_key(s, chars)) != s.end());
+    kdmt_str k{in_place, 5, 'x'};
+    REQUIRE(k.get_str() == "xxxxx");
+    REQUIRE(k == kdmt_str{counted_string{"xxxxx"}});
+}
+
+TEST_CASE("deduplicated keydomet is smaller than the string", "[deduplicated]")
+{
+    REQUIRE(sizeof(keydomet<deduplicated<>, prefix_size::SIZE_32BIT>) == 16);
+    REQUIRE(sizeof(keydomet<deduplicated<>, prefix_size::SIZE_64BIT>) == 24);
+}
+
+template<prefix_size Size>
+static void verify_dedup_reconstruction()
+{
+    const string src = "0123456789abcdefghijklmnopqrstuvwxyz";
+    for (size_t len = 0; len <= src.size(); ++len)
+    {
+        string str = src.substr(0, len);
+        keydomet<deduplicated<>, Size> k{str};
+        CAPTURE(len);
+        REQUIRE(k.get_str() == str);
+        keydomet<deduplicated<>, Size> copy{k};
+        REQUIRE(copy.get_str() == str);
+    }
+}
+
+TEST_CASE("deduplicated keydomet reconstructs the string", "[deduplicated]")
+{
+    verify_dedup_reconstruction<prefix_size::SIZE_16BIT>();
+    verify_dedup_reconstruction<prefix_size::SIZE_32BIT>();
+    verify_dedup_reconstruction<prefix_size::SIZE_64BIT>();
+    verify_dedup_reconstruction<prefix_size::SIZE_128BIT>();
+}
+
+TEST_CASE("deduplicated keydomet compares with view keys", "[deduplicated]")
+{
+    using kdmt_dedup = keydomet<deduplicated<>, prefix_size::SIZE_32BIT>;
+    string s1{"kkkkkkkka"}, s2{"kkkkkkkkb"}, s3{"kkkk"};
+    kdmt_dedup k{s2};
+    REQUIRE(k.compare(keydomet<const string&, prefix_size::SIZE_32BIT>{s1}) > 0);
+    REQUIRE(k.compare(keydomet<const string&, prefix_size::SIZE_32BIT>{s2}) == 0);
+    REQUIRE(k.compare(keydomet<string_view, prefix_size::SIZE_32BIT>{string_view{s3}}) > 0);
+    REQUIRE(k.compare(kdmt_dedup{s1}) > 0);
+    REQUIRE(kdmt_dedup{s1} < k);
+}
+
+namespace
+{
+    // claims to hold more characters than a deduplicated suffix may, while only the prefix is ever read
+    struct oversized_string
+    {
+        const char* data() const { return "kkkkkkkk"; }
+        size_t size() const { return static_cast<size_t>(UINT32_MAX) + 16; }
+    };
+}
+
+TEST_CASE("deduplicated keydomet rejects suffixes of 4GB", "[deduplicated]")
+{
+    if (sizeof(size_t) > sizeof(uint32_t))
+        REQUIRE_THROWS_AS((keydomet<deduplicated<>, prefix_size::SIZE_32BIT>{oversized_string{}}), length_error);
+}
+
+TEST_CASE("sorting deduplicated keydomets", "[deduplicated]")
+{
+    vector<string> org_vals(1000);
+    mt19937 gen{random_device{}()};
+    uniform_int_distribution<short> len_dis(0, 12), char_dis('a', 'c');
+    generate(org_vals.begin(), org_vals.end(), [&] {
+        string s(len_dis(gen), ' ');
+        for (char& c : s)
+            c = (char)char_dis(gen);
+        return s;
+    });
+    vector<keydomet<deduplicated<>, prefix_size::SIZE_32BIT>> kdm_vals{org_vals.begin(), org_vals.end()};
+    sort(org_vals.begin(), org_vals.end());
+    sort(kdm_vals.begin(), kdm_vals.end());
+    for (size_t i = 0; i < org_vals.size(); ++i)
+        REQUIRE(kdm_vals[i].get_str() == org_vals[i]);
+}
+
+TEST_CASE("deduplicated container key requires no allocation", "[deduplicated]")
+{
+    using kdmt_dedup = keydomet<deduplicated<>, prefix_size::SIZE_64BIT>;
+    set<kdmt_dedup, less<>> s;
+    s.insert(kdmt_dedup{string{"a key longer than the prefix"}});
+    string org{"a key longer than the prefix"};
+    auto fk = make_find_key(s, org);
+    const string& ref = fk.get_str();
+    REQUIRE(&ref == &org);
+    REQUIRE(s.find(fk) != s.end());
+    REQUIRE(s.find(make_find_key(s, string{"a key longer than the prefiy"})) == s.end());
+}
+
+TEST_CASE("alphabet encodings pack more characters into the prefix", "[encoding]")
+{
+    using lower_enc = alphabet_encoding<alphabets::lowercase>;
+    using letters_enc = alphabet_encoding<alphabets::letters>;
+    REQUIRE(alphabet_encoding<alphabets::digits>::bits == 4);
+    REQUIRE(lower_enc::bits == 5);
+    REQUIRE(letters_enc::bits == 6);
+    REQUIRE(alphabet_encoding<alphabets::hostname>::bits == 6);
+    REQUIRE(letters_enc::chars_num<uint32_t>() == 5);
+    REQUIRE(letters_enc::chars_num<uint64_t>() == 10);
+    // strings differing only at their 10th character are told apart by a 64 bit prefix
+    using kdmt_lower = keydomet<string, prefix_size::SIZE_64BIT, no_stats, lower_enc>;
+    REQUIRE(kdmt_lower{string{"abcdefghia"}}.getPrefix() < kdmt_lower{string{"abcdefghib"}}.getPrefix());
+}
+
+TEST_CASE("alphabet encodings preserve order", "[encoding]")
+{
+    mt19937 gen{random_device{}()};
+    uniform_int_distribution<short> len_dis(0, 20), char_dis(0, 5);
+    // mostly alphabet characters, some bytes below, between and above them
+    const char chars[] = {'a', 'b', 'z', '5', '{', '\xF0'};
+    vector<string> org_vals(2000);
+    generate(org_vals.begin(), org_vals.end(), [&] {
+        string s(len_dis(gen), ' ');
+        for (char& c : s)
+            c = chars[char_dis(gen)];
+        return s;
+    });
+    using kdmt_lower32 = keydomet<string, prefix_size::SIZE_32BIT, no_stats, alphabet_encoding<alphabets::lowercase>>;
+    using kdmt_lower64 = keydomet<string, prefix_size::SIZE_64BIT, no_stats, alphabet_encoding<alphabets::lowercase>>;
+    using kdmt_host16 = keydomet<string, prefix_size::SIZE_16BIT, no_stats, alphabet_encoding<alphabets::hostname>>;
+    vector<kdmt_lower32> kdm_vals32{org_vals.begin(), org_vals.end()};
+    vector<kdmt_lower64> kdm_vals64{org_vals.begin(), org_vals.end()};
+    vector<kdmt_host16> kdm_vals16{org_vals.begin(), org_vals.end()};
+    sort(org_vals.begin(), org_vals.end());
+    sort(kdm_vals32.begin(), kdm_vals32.end());
+    sort(kdm_vals64.begin(), kdm_vals64.end());
+    sort(kdm_vals16.begin(), kdm_vals16.end());
+    for (size_t i = 0; i < org_vals.size(); ++i)
+    {
+        REQUIRE(kdm_vals32[i].get_str() == org_vals[i]);
+        REQUIRE(kdm_vals64[i].get_str() == org_vals[i]);
+        REQUIRE(kdm_vals16[i].get_str() == org_vals[i]);
+    }
+}
+
+TEST_CASE("alphabet encoded keydomets compare equal strings", "[encoding]")
+{
+    using kdmt_digits = keydomet<string, prefix_size::SIZE_32BIT, no_stats, alphabet_encoding<alphabets::digits>>;
+    using kdmt_digits_view = keydomet<const char*, prefix_size::SIZE_32BIT, no_stats, alphabet_encoding<alphabets::digits>>;
+    REQUIRE(kdmt_digits{string{"123"}} == kdmt_digits{string{"123"}});
+    REQUIRE(kdmt_digits{string{"12345678"}} == kdmt_digits{string{"12345678"}});
+    REQUIRE(kdmt_digits{string{"123456789"}} == kdmt_digits_view{"123456789"});
+    REQUIRE(kdmt_digits{string{"12x"}} == kdmt_digits_view{"12x"});
+    REQUIRE(kdmt_digits{string{"12x"}} < kdmt_digits_view{"12y"});
+    REQUIRE(kdmt_digits{string{"123"}} < kdmt_digits_view{"1234"});
+    REQUIRE(kdmt_digits{string{""}} < kdmt_digits_view{"0"});
+    set<kdmt_digits, less<>> s{string{"42"}, string{"4242"}, string{"424242424242"}};
+    REQUIRE(s.find(make_find_key(s, string{"4242"})) != s.end());
+    REQUIRE(s.find(make_find_key(s, string{"424242424242"})) != s.end());
+    REQUIRE(s.find(make_find_key(s, string{"424"})) == s.end());
+}
+
+TEST_CASE("common_head finds the longest shared head", "[encoding]")
+{
+    vector<string> keys{"https://www.abc", "https://www.abd", "https://www.xyz"};
+    REQUIRE(common_head(keys.begin(), keys.end()) == "https://www.");
+    keys.push_back("https://");
+    REQUIRE(common_head(keys.begin(), keys.end()) == "https://");
+    const char* cstrs[] = {"/var/log/a", "/var/lib"};
+    REQUIRE(common_head(begin(cstrs), end(cstrs)) == "/var/l");
+    REQUIRE(common_head(keys.begin(), keys.begin()).empty());
+}
+
+namespace
+{
+    struct urls_tag {};
+    struct tenants_tag {};
+}
+
+TEST_CASE("common head encoding preserves order", "[encoding]")
+{
+    using encoding = common_head_encoding<urls_tag>;
+    mt19937 gen{random_device{}()};
+    uniform_int_distribution<short> len_dis(0, 12), char_dis('a', 'c'), head_dis(0, 9);
+    const string head{"https://www."};
+    vector<string> org_vals(2000);
+    generate(org_vals.begin(), org_vals.end(), [&] {
+        string s(len_dis(gen), ' ');
+        for (char& c : s)
+            c = (char)char_dis(gen);
+        // a few keys don't start with the head, or only with a part of it
+        const short kind = head_dis(gen);
+        return kind == 0 ? s : kind == 1 ? head.substr(0, s.size()) + s : head + s;
+    });
+    encoding::set_head(head);
+    using kdmt_url = keydomet<string, prefix_size::SIZE_32BIT, no_stats, encoding>;
+    using kdmt_url_cstr = keydomet<const char*, prefix_size::SIZE_32BIT, no_stats, encoding>;
+    vector<kdmt_url> kdm_vals{org_vals.begin(), org_vals.end()};
+    sort(org_vals.begin(), org_vals.end());
+    sort(kdm_vals.begin(), kdm_vals.end());
+    for (size_t i = 0; i < org_vals.size(); ++i)
+    {
+        REQUIRE(kdm_vals[i].get_str() == org_vals[i]);
+        REQUIRE(kdm_vals[i] == kdmt_url_cstr{org_vals[i].c_str()});
+    }
+    REQUIRE(kdmt_url{head} == kdmt_url_cstr{"https://www."});
+    REQUIRE(kdmt_url{head} < kdmt_url_cstr{"https://www.a"});
+    REQUIRE(kdmt_url_cstr{"https://"} < kdmt_url{head});
+    REQUIRE(kdmt_url_cstr{"zzz"} == kdmt_url{string{"zzz"}});
+}
+
+TEST_CASE("common head encoding lets the prefix decide", "[encoding]")
+{
+    struct head_stats_tag {};
+    struct raw_stats_tag {};
+    using encoding = common_head_encoding<tenants_tag>;
+    using kdmt_head = keydomet<string, prefix_size::SIZE_32BIT, atomic_stats<head_stats_tag>, encoding>;
+    using kdmt_raw = keydomet<string, prefix_size::SIZE_32BIT, atomic_stats<raw_stats_tag>>;
+    vector<string> keys;
+    for (char c1 = 'a'; c1 <= 'z'; ++c1)
+        for (char c2 = 'a'; c2 <= 'z'; ++c2)
+            keys.push_back(string{"tenant-00042:"} + c1 + c2 + "/data");
+    encoding::train(keys.begin(), keys.end());
+    REQUIRE(encoding::get_head() == "tenant-00042:");
+    set<kdmt_head, less<>> head_set{keys.begin(), keys.end()};
+    set<kdmt_raw, less<>> raw_set{keys.begin(), keys.end()};
+    kdmt_head::reset_stats();
+    kdmt_raw::reset_stats();
+    for (const string& key : keys)
+    {
+        REQUIRE(head_set.find(make_find_key(head_set, key)) != head_set.end());
+        REQUIRE(raw_set.find(make_find_key(raw_set, key)) != raw_set.end());
+    }
+    // only comparisons with the equal key (at most two per lookup) use the strings
+    REQUIRE(kdmt_head::get_stats().used_string <= 2 * keys.size());
+    REQUIRE(kdmt_head::get_stats().used_prefix > 0);
+    REQUIRE(kdmt_raw::get_stats().used_prefix == 0);
+    // the head is set once, as changing it would reorder the keys held
+    encoding::set_head("tenant-00042:");
+    REQUIRE_THROWS_AS(encoding::set_head("tenant-00043:"), std::logic_error);
+    REQUIRE_THROWS_AS(encoding::train(keys.begin(), keys.begin() + 1), std::logic_error);
+    REQUIRE(encoding::get_head() == "tenant-00042:");
+}
+
+TEST_CASE("common head encoding compares across prefix sizes", "[encoding][mixed sizes]")
+{
+    // packed inner encodings clear the unused bits when narrowing, which mustn't affect the reserved values
+    struct packed_tag {};
+    using encoding = common_head_encoding<packed_tag, alphabet_encoding<alphabets::letters>>;
+    encoding::set_head("http");
+    const vector<string> vals{"", "a", "htt", "http", "httpa", "httpab", "httpabcdefghij", "httpz", "xxx", "zzz"};
+    for (const string& v1 : vals)
+    {
+        keydomet<string, prefix_size::SIZE_64BIT, no_stats, encoding> k64{v1};
+        for (const string& v2 : vals)
+        {
+            keydomet<const string&, prefix_size::SIZE_32BIT, no_stats, encoding> s32{v2};
+            keydomet<const string&, prefix_size::SIZE_16BIT, no_stats, encoding> s16{v2};
+            const int expected = v1.compare(v2) < 0 ? -1 : v1.compare(v2) > 0 ? 1 : 0;
+            CAPTURE(v1);
+            CAPTURE(v2);
+            REQUIRE(signum(k64.compare(s32)) == expected);
+            REQUIRE(signum(k64.compare(s16)) == expected);
+            REQUIRE(signum(s32.compare(k64)) == -expected);
+        }
+    }
+}
+
+TEST_CASE("keydomets of different prefix sizes compare", "[mixed sizes]")
+{
+    mt19937 gen{random_device{}()};
+    uniform_int_distribution<short> len_dis(0, 20), char_dis('a', 'c');
+    vector<string> vals(150);
+    generate(vals.begin(), vals.end(), [&] {
+        string s(len_dis(gen), ' ');
+        for (char& c : s)
+            c = (char)char_dis(gen);
+        return s;
+    });
+    for (const string& v1 : vals)
+    {
+        keydomet<string, prefix_size::SIZE_16BIT> k16{v1};
+        keydomet<string, prefix_size::SIZE_64BIT> k64{v1};
+        keydomet<string, prefix_size::SIZE_128BIT> k128{v1};
+        for (const string& v2 : vals)
+        {
+            const int expected = v1.compare(v2) < 0 ? -1 : v1.compare(v2) > 0 ? 1 : 0;
+            keydomet<const char*, prefix_size::SIZE_32BIT> c32{v2.c_str()};
+            keydomet<const string&, prefix_size::SIZE_32BIT> s32{v2};
+            CAPTURE(v1);
+            CAPTURE(v2);
+            REQUIRE(signum(k16.compare(c32)) == expected);
+            REQUIRE(signum(k128.compare(c32)) == expected);
+            REQUIRE(signum(k64.compare(s32)) == expected);
+            REQUIRE(signum(s32.compare(k64)) == -expected);
+            REQUIRE(signum(k128.compare(s32)) == expected);
+            REQUIRE(signum(s32.compare(k16)) == -expected);
+        }
+    }
+}
+
+TEST_CASE("keydomets of different prefix sizes compare using packed encodings", "[mixed sizes]")
+{
+    using encoding = alphabet_encoding<alphabets::letters>;
+    const vector<string> vals{"", "a", "ab", "abcde", "abcdef", "abcdefghij", "abcdefghijk", "abcd{", "abcd{f", "b"};
+    for (const string& v1 : vals)
+    {
+        keydomet<string, prefix_size::SIZE_64BIT, no_stats, encoding> k64{v1};
+        for (const string& v2 : vals)
+        {
+            keydomet<const string&, prefix_size::SIZE_32BIT, no_stats, encoding> s32{v2};
+            keydomet<const string&, prefix_size::SIZE_16BIT, no_stats, encoding> s16{v2};
+            const int expected = v1.compare(v2) < 0 ? -1 : v1.compare(v2) > 0 ? 1 : 0;
+            CAPTURE(v1);
+            CAPTURE(v2);
+            REQUIRE(signum(k64.compare(s32)) == expected);
+            REQUIRE(signum(k64.compare(s16)) == expected);
+            REQUIRE(signum(s32.compare(k64)) == -expected);
+        }
+    }
+}
+
+TEST_CASE("containers can be searched using keys of another prefix size", "[mixed sizes]")
+{
+    set<keydomet<string, prefix_size::SIZE_64BIT>, less<>> s64{string{"migrating"}, string{"to"},
+                                                              string{"a wider prefix"}};
+    set<keydomet<string, prefix_size::SIZE_32BIT>, less<>> s32{s64.begin()->get_str(), string{"to"}};
+    const string key{"a wider prefix"};
+    // a probe made for one container can search the other
+    auto find_key = make_find_key(s32, key);
+    static_assert(is_same<decltype(find_key), keydomet<const string&, prefix_size::SIZE_32BIT>>::value, "");
+    REQUIRE(s64.find(find_key) != s64.end());
+    REQUIRE(s64.find(make_find_key(s64, key)) != s64.end());
+    REQUIRE(s32.find(make_find_key(s64, key)) != s32.end());
+    REQUIRE(s64.find(make_find_key(s32, string{"migrate"})) == s64.end());
+}
+
+TEST_CASE("binary keydomets order keys containing NULs", "[binary]")
+{
+    mt19937 gen{random_device{}()};
+    uniform_int_distribution<short> len_dis(0, 20), byte_dis(0, 3);
+    vector<string> org_vals(2000);
+    generate(org_vals.begin(), org_vals.end(), [&] {
+        string s(len_dis(gen), ' ');
+        for (char& c : s)
+            c = (char)byte_dis(gen); // mostly NULs and other low bytes
+        return s;
+    });
+    using kdmt16 = keydomet<string, prefix_size::SIZE_16BIT, no_stats, binary_encoding>;
+    using kdmt64 = keydomet<string, prefix_size::SIZE_64BIT, no_stats, binary_encoding>;
+    using kdmt128 = keydomet<string, prefix_size::SIZE_128BIT, no_stats, binary_encoding>;
+    vector<kdmt16> kdm_vals16{org_vals.begin(), org_vals.end()};
+    vector<kdmt64> kdm_vals64{org_vals.begin(), org_vals.end()};
+    vector<kdmt128> kdm_vals128{org_vals.begin(), org_vals.end()};
+    sort(org_vals.begin(), org_vals.end());
+    sort(kdm_vals16.begin(), kdm_vals16.end());
+    sort(kdm_vals64.begin(), kdm_vals64.end());
+    sort(kdm_vals128.begin(), kdm_vals128.end());
+    for (size_t i = 0; i < org_vals.size(); ++i)
+    {
+        REQUIRE(kdm_vals16[i].get_str() == org_vals[i]);
+        REQUIRE(kdm_vals64[i].get_str() == org_vals[i]);
+        REQUIRE(kdm_vals128[i].get_str() == org_vals[i]);
+        REQUIRE(kdm_vals64[i] == kdm_vals16[i]);
+    }
+}
+
+TEST_CASE("binary keydomets tell apart keys differing by trailing NULs", "[binary]")
+{
+    using kdmt_bin = keydomet<string, prefix_size::SIZE_32BIT, atomic_stats<struct binary_tag>, binary_encoding>;
+    const kdmt_bin abc{string{"abc"}}, abc0{string{"abc\0", 4}}, abc00{string{"abc\0\0", 5}};
+    kdmt_bin::reset_stats();
+    REQUIRE(abc < abc0);
+    REQUIRE(abc < abc00);
+    REQUIRE(!(abc == abc0));
+    // a string shorter than the prefix is told apart using the lengths, without reading the characters
+    REQUIRE(kdmt_bin::get_stats().used_string == 0);
+    REQUIRE(abc0 < abc00);
+    REQUIRE(!(abc0 == abc00));
+    REQUIRE(abc0 == kdmt_bin{string{"abc\0", 4}});
+    REQUIRE(abc0 == keydomet<chars_view, prefix_size::SIZE_32BIT, no_stats, binary_encoding>{chars_view{"abc\0", 4}});
+}
+
+TEST_CASE("binary keydomets of big endian integers and byte vectors", "[binary]")
+{
+    using kdmt_bytes = keydomet<vector<uint8_t>, prefix_size::SIZE_32BIT, no_stats, binary_encoding>;
+    vector<uint64_t> ints{0, 1, 255, 256, 65536, 1ULL << 32, (1ULL << 32) + 1, UINT64_MAX - 1, UINT64_MAX};
+    vector<kdmt_bytes> keys;
+    for (auto it = ints.rbegin(); it != ints.rend(); ++it)
+    {
+        vector<uint8_t> bytes(8);
+        for (size_t i = 0; i < 8; ++i)
+            bytes[i] = (uint8_t)(*it >> (8 * (7 - i)));
+        keys.emplace_back(std::move(bytes));
+    }
+    sort(keys.begin(), keys.end());
+    for (size_t i = 0; i < ints.size(); ++i)
+    {
+        uint64_t val = 0;
+        for (uint8_t byte : keys[i].get_str())
+            val = (val << 8) | byte;
+        REQUIRE(val == ints[i]);
+    }
+    set<kdmt_bytes, less<>> s{keys.begin(), keys.end()};
+    const char key[] = {0, 0, 0, 1, 0, 0, 0, 1};
+    REQUIRE(s.find(make_find_key(s, key, sizeof(key))) != s.end());
+    REQUIRE(s.find(make_find_key(s, key, sizeof(key) - 1)) == s.end());
+}
+
+// a string counting the accesses to its characters
+static size_t chars_accesses = 0;
+
+class watched_string
+{
+public:
+    watched_string(string s) : str(std::move(s)) {}
+    const char* data() const
+    {
+        ++chars_accesses;
+        return str.data();
+    }
+    size_t size() const { return str.size(); }
+    friend ostream& operator<<(ostream& os, const watched_string& s) { return os << s.str; }
+private:
+    string str;
+};
+
+TEST_CASE("keydomets cache the length in their padding", "[length cache]")
+{
+    REQUIRE(sizeof(keydomet<string, prefix_size::SIZE_16BIT>) == sizeof(string) + 8);
+    REQUIRE(sizeof(keydomet<string, prefix_size::SIZE_32BIT>) == sizeof(string) + 8);
+    REQUIRE(sizeof(keydomet<string, prefix_size::SIZE_64BIT>) == sizeof(string) + 8);
+    REQUIRE(sizeof(keydomet<const string&, prefix_size::SIZE_32BIT>) == sizeof(void*) + 8);
+}
+
+TEST_CASE("keydomets of different lengths are unequal without reading the strings", "[length cache]")
+{
+    using kdmt_watched = keydomet<watched_string, prefix_size::SIZE_32BIT>;
+    const kdmt_watched k1{string{"same prefix, one length"}}, k2{string{"same prefix, another length"}};
+    const kdmt_watched k3{string{"same prefix, one length"}};
+    chars_accesses = 0;
+    REQUIRE(!(k1 == k2));
+    REQUIRE(chars_accesses == 0);
+    REQUIRE(k1 == k3);
+    REQUIRE(chars_accesses > 0);
+    // view keys cache the length too
+    const string key{"same prefix, another length"};
+    REQUIRE(!(k1 == keydomet<const string&, prefix_size::SIZE_32BIT>{key}));
+    REQUIRE(k2 == keydomet<const string&, prefix_size::SIZE_32BIT>{key});
+}
+
+TEST_CASE("hashed keydomets cache the hash in their padding", "[hash]")
+{
+    REQUIRE(sizeof(keydomet<hashed<string>, prefix_size::SIZE_16BIT>) == sizeof(string) + 8);
+    REQUIRE(sizeof(keydomet<hashed<string>, prefix_size::SIZE_32BIT>) == sizeof(string) + 8);
+    using kdmt_hashed = keydomet<hashed<string>, prefix_size::SIZE_32BIT>;
+    const string s{"a key long enough to have a suffix"};
+    const kdmt_hashed k{s};
+    REQUIRE(k.get_str() == s);
+    // all keydomets hash the same string the same way, whether cached or not
+    REQUIRE(k.hash() == keydomet<string, prefix_size::SIZE_32BIT>{s}.hash());
+    REQUIRE(k.hash() == keydomet<const char*, prefix_size::SIZE_64BIT>{s.c_str()}.hash());
+    REQUIRE(k.hash() == kdmt_hashed{in_place, s.c_str()}.hash());
+    REQUIRE(k.hash() != kdmt_hashed{string{"a key long enough to have a suffiX"}}.hash());
+    REQUIRE(kdmt_hashed{string{""}}.hash() != kdmt_hashed{string(1, '\0')}.hash());
+}
+
+TEST_CASE("keydomets of different hashes are unequal without reading the strings", "[hash]")
+{
+    using kdmt_watched = keydomet<hashed<watched_string>, prefix_size::SIZE_32BIT>;
+    const kdmt_watched k1{string{"same prefix and length, 1"}}, k2{string{"same prefix and length, 2"}};
+    const kdmt_watched k3{string{"same prefix and length, 1"}};
+    chars_accesses = 0;
+    REQUIRE(!(k1 == k2));
+    REQUIRE(chars_accesses == 0);
+    REQUIRE(k1 == k3);
+    REQUIRE(chars_accesses > 0);
+    // ordering is unaffected by the hash
+    REQUIRE(k1 < k2);
+    REQUIRE(!(k2 < k1));
+}
+
+TEST_CASE("hash containers of keydomets", "[hash]")
+{
+    mt19937 gen{random_device{}()};
+    uniform_int_distribution<short> len_dis(0, 40), char_dis('a', 'e');
+    vector<string> org_vals(2000);
+    generate(org_vals.begin(), org_vals.end(), [&] {
+        string s(len_dis(gen), ' ');
+        for (char& c : s)
+            c = (char)char_dis(gen);
+        return s;
+    });
+    using kdmt_hashed = keydomet<hashed<string>, prefix_size::SIZE_32BIT>;
+    unordered_set<kdmt_hashed, kdmt::hash, kdmt::equal_to> kdm_set;
+    unordered_set<string> str_set;
+    for (size_t i = 0; i < org_vals.size(); i += 2)
+    {
+        kdm_set.emplace(in_place, org_vals[i]);
+        str_set.insert(org_vals[i]);
+    }
+    REQUIRE(kdm_set.size() == str_set.size());
+    for (const string& val : org_vals)
+        REQUIRE((kdm_set.find(kdmt_hashed{val}) != kdm_set.end()) == (str_set.find(val) != str_set.end()));
+    // the equality predicate accepts keydomets of other string types
+    const kdmt_hashed& k = *kdm_set.begin();
+    REQUIRE(kdmt::equal_to{}(k, keydomet<const string&, prefix_size::SIZE_32BIT>{k.get_str()}));
+}
+
+static vector<string> colliding_keys(size_t num, mt19937& gen)
+{
+    // short keys of a small alphabet, so prefixes of every width collide, and some keys end within them
+    uniform_int_distribution<short> len_dis(0, 20), char_dis('a', 'c');
+    vector<string> keys(num);
+    generate(keys.begin(), keys.end(), [&] {
+        string s(len_dis(gen), ' ');
+        for (char& c : s)
+            c = (char)char_dis(gen);
+        return s;
+    });
+    return keys;
+}
+
+template<prefix_size Size, class Encoding = raw_encoding, class StrT = string>
+static void require_order_of(vector<string> org_vals)
+{
+    CAPTURE(static_cast<size_t>(Size));
+    vector<keydomet<StrT, Size, no_stats, Encoding>> kdm_vals{org_vals.rbegin(), org_vals.rend()};
+    sort(org_vals.begin(), org_vals.end());
+    sort(kdm_vals.begin(), kdm_vals.end());
+    for (size_t i = 0; i < org_vals.size(); ++i)
+    {
+        REQUIRE(string{kdm_vals[i].get_str()} == org_vals[i]);
+        const keydomet<const string&, Size, no_stats, Encoding> key{org_vals[i]};
+        REQUIRE(kdm_vals[i] == key);
+        if (i + 1 < org_vals.size())
+            REQUIRE((kdm_vals[i] < kdm_vals[i + 1]) == (org_vals[i] < org_vals[i + 1]));
+    }
+}
+
+TEST_CASE("prefixes of any width fill the padding", "[prefix widths]")
+{
+    REQUIRE(sizeof(keydomet<string, prefix_bytes(3)>) == sizeof(string) + 8);
+    REQUIRE(sizeof(keydomet<string, prefix_bytes(7)>) == sizeof(string) + 8);
+    REQUIRE(sizeof(keydomet<string, prefix_bytes(12)>) == sizeof(string) + 16);
+    REQUIRE(sizeof(keydomet<const char*, prefix_bytes(5)>) == sizeof(const char*) + 8);
+    REQUIRE(sizeof(keydomet<deduplicated<string>, prefix_bytes(12)>) == sizeof(keydomet<deduplicated<string>,
+            prefix_size::SIZE_128BIT>) - 8);
+    static_assert(fitting_prefix_size<string>::value == prefix_size::SIZE_64BIT, "");
+    static_assert(fitting_prefix_size<string, true>::value == prefix_size::SIZE_32BIT, "");
+    static_assert(fitting_prefix_size<const char*>::value == prefix_size::SIZE_64BIT, "");
+    static_assert(fitting_prefix_size<const string&, true>::value == prefix_size::SIZE_32BIT, "");
+    REQUIRE(sizeof(keydomet<string, fitting_prefix_size<string>::value>) ==
+            sizeof(keydomet<string, prefix_size::SIZE_16BIT>));
+}
+
+TEST_CASE("prefixes of any width preserve order", "[prefix widths]")
+{
+    mt19937 gen{random_device{}()};
+    const vector<string> org_vals = colliding_keys(500, gen);
+    require_order_of<prefix_bytes(1)>(org_vals);
+    require_order_of<prefix_bytes(3)>(org_vals);
+    require_order_of<prefix_bytes(5)>(org_vals);
+    require_order_of<prefix_bytes(6)>(org_vals);
+    require_order_of<prefix_bytes(7)>(org_vals);
+    require_order_of<prefix_bytes(12)>(org_vals);
+    require_order_of<prefix_bytes(15)>(org_vals);
+    require_order_of<prefix_bytes(3), raw_encoding, deduplicated<string>>(org_vals);
+    require_order_of<prefix_bytes(12), raw_encoding, deduplicated<string>>(org_vals);
+    using encoding = alphabet_encoding<alphabets::lowercase>;
+    require_order_of<prefix_bytes(1), encoding>(org_vals);
+    require_order_of<prefix_bytes(3), encoding>(org_vals);
+    require_order_of<prefix_bytes(7), encoding>(org_vals);
+}
+
+TEST_CASE("binary keys use prefixes of any width", "[prefix widths]")
+{
+    const vector<string> org_vals{string(), string(1, '\0'), string(2, '\0'), string(3, '\0'), string("a\0", 2),
+                                  string("a\0\0b", 4), string("a\0\0c", 4), "a", "ab", "abc", string("abc\0", 4)};
+    require_order_of<prefix_bytes(3), binary_encoding>(org_vals);
+    require_order_of<prefix_bytes(5), binary_encoding>(org_vals);
+}
+
+TEST_CASE("prefixes of any width compare with other widths", "[prefix widths]")
+{
+    mt19937 gen{random_device{}()};
+    const vector<string> vals = colliding_keys(150, gen);
+    using encoding = alphabet_encoding<alphabets::lowercase>;
+    for (const string& v1 : vals)
+    {
+        keydomet<string, prefix_bytes(3)> k3{v1};
+        keydomet<string, prefix_bytes(12)> k12{v1};
+        keydomet<string, prefix_bytes(6), no_stats, encoding> a6{v1};
+        for (const string& v2 : vals)
+        {
+            const int expected = v1.compare(v2) < 0 ? -1 : v1.compare(v2) > 0 ? 1 : 0;
+            keydomet<const string&, prefix_bytes(5)> s5{v2};
+            keydomet<const string&, prefix_size::SIZE_128BIT> s16{v2};
+            keydomet<const string&, prefix_size::SIZE_32BIT, no_stats, encoding> a4{v2};
+            keydomet<const string&, prefix_bytes(7), no_stats, encoding> a7{v2};
+            CAPTURE(v1);
+            CAPTURE(v2);
+            REQUIRE(signum(k3.compare(s5)) == expected);
+            REQUIRE(signum(s5.compare(k3)) == -expected);
+            REQUIRE(signum(k12.compare(s5)) == expected);
+            REQUIRE(signum(k12.compare(s16)) == expected);
+            REQUIRE(signum(a6.compare(a4)) == expected);
+            REQUIRE(signum(a6.compare(a7)) == expected);
+        }
+    }
+}
+
+TEST_CASE("constant keys have their prefix computed at compile time", "[const key]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    constexpr auto key = make_const_key<kdmt_str>("hello");
+    static_assert(is_same<decltype(key), const keydomet<chars_view, prefix_size::SIZE_32BIT>>::value, "");
+    static_assert(key.getPrefix().get_val() == 0x68656C6C, "");
+    constexpr auto short_key = make_const_key<kdmt_str>("hi");
+    static_assert(short_key.getPrefix().get_val() == 0x68690000, "");
+    REQUIRE(key == kdmt_str{string{"hello"}});
+    REQUIRE(key < short_key);
+    using namespace kdmt::literals;
+    constexpr auto verb = "GET"_kdmt;
+    static_assert(verb.getPrefix().get_val() == 0x47455400, "");
+    REQUIRE(verb == kdmt_str{string{"GET"}});
+}
+
+template<prefix_size Size, class Encoding = raw_encoding>
+static void require_const_key_matches(const vector<string>& vals)
+{
+    using kdmt_str = keydomet<string, Size, no_stats, Encoding>;
+    const auto key = make_const_key<kdmt_str>("literal key");
+    const string key_str{"literal key"};
+    CAPTURE(static_cast<size_t>(Size));
+    REQUIRE(key.getPrefix() == kdmt_str{key_str}.getPrefix());
+    REQUIRE(key == kdmt_str{key_str});
+    for (const string& val : vals)
+    {
+        CAPTURE(val);
+        const kdmt_str k{val};
+        const auto const_key = imp::make_const_key<Size, no_stats, Encoding>(val.data(), val.size());
+        REQUIRE(const_key.getPrefix() == k.getPrefix());
+        REQUIRE(const_key == k);
+        REQUIRE((const_key < kdmt_str{key_str}) == (val < key_str));
+    }
+}
+
+TEST_CASE("constant keys match keydomets of any prefix width", "[const key]")
+{
+    const vector<string> vals{"", "l", "lit", "literal", "literal k", "literal key", "literal keys",
+                              "literally a much longer key"};
+    require_const_key_matches<prefix_size::SIZE_16BIT>(vals);
+    require_const_key_matches<prefix_size::SIZE_32BIT>(vals);
+    require_const_key_matches<prefix_size::SIZE_64BIT>(vals);
+    require_const_key_matches<prefix_size::SIZE_128BIT>(vals);
+    require_const_key_matches<prefix_bytes(3)>(vals);
+    require_const_key_matches<prefix_bytes(12)>(vals);
+    require_const_key_matches<prefix_size::SIZE_64BIT, binary_encoding>(vals);
+    // binary keys may contain NULs, literals included
+    using kdmt_bin = keydomet<string, prefix_size::SIZE_64BIT, no_stats, binary_encoding>;
+    constexpr auto bin_key = make_const_key<kdmt_bin>("bin\0key");
+    REQUIRE(bin_key == kdmt_bin{string{"bin\0key", 7}});
+    REQUIRE(kdmt_bin{string{"bin\0ke", 6}} < bin_key);
+    REQUIRE(bin_key < kdmt_bin{string{"bin\0keys", 8}});
+}
+
+TEST_CASE("containers are searched using constant keys", "[const key]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_64BIT>;
+    const set<kdmt_str, less<>> verbs{string{"GET"}, string{"HEAD"}, string{"POST"}, string{"PUT"}};
+    static constexpr auto get = make_const_key<kdmt_str>("GET");
+    static constexpr auto patch = make_const_key<kdmt_str>("PATCH");
+    REQUIRE(verbs.find(get) != verbs.end());
+    REQUIRE(verbs.find(patch) == verbs.end());
+    using namespace kdmt::literals;
+    REQUIRE(verbs.find("POST"_kdmt) != verbs.end());
+    REQUIRE(verbs.find("POS"_kdmt) == verbs.end());
+}
+
+TEST_CASE("suffixes are compared like memcmp, all lengths and mismatch positions", "[suffix compare]")
+{
+    // the buffers are exactly len bytes long, so blocks reaching past them would be caught by ASan
+    const string base = [] {
+        string s(300, ' ');
+        for (size_t i = 0; i < s.size(); ++i)
+            s[i] = (char)('a' + i % 26);
+        return s;
+    }();
+    for (size_t len = 0; len <= base.size(); ++len)
+    {
+        vector<char> buf1(base.begin(), base.begin() + len), buf2 = buf1;
+        const imp::sized_suffix s1{buf1.data(), len}, s2{buf2.data(), len};
+        CAPTURE(len);
+        REQUIRE(imp::compare_suffix(s1, s2) == 0);
+        REQUIRE(imp::first_mismatch(buf1.data(), buf2.data(), len) == len);
+        REQUIRE(imp::first_mismatch_words(buf1.data(), buf2.data(), len) == len);
+        for (size_t pos = 0; pos < len; ++pos)
+        {
+            CAPTURE(pos);
+            buf2[pos] = (char)0xF0; // compares as unsigned, hence greater than any letter
+            REQUIRE(imp::first_mismatch(buf1.data(), buf2.data(), len) == pos);
+            REQUIRE(imp::first_mismatch_words(buf1.data(), buf2.data(), len) == pos);
+            REQUIRE(signum(imp::compare_suffix(s1, s2)) == -1);
+            REQUIRE(signum(imp::compare_suffix(s2, s1)) == 1);
+            // a shorter equal head
+            REQUIRE(signum(imp::compare_suffix(imp::sized_suffix{buf1.data(), pos}, s1)) == -1);
+            buf2[pos] = buf1[pos];
+        }
+    }
+}
+
+TEST_CASE("NUL terminated suffixes are compared like strcmp", "[suffix compare]")
+{
+    // the strings are placed at every offset near a page end, covering both the word loop and the strcmp fallback
+    const size_t page = 4096;
+    vector<char> buf1(3 * page), buf2(3 * page);
+    char* end1 = (char*)(((uintptr_t)buf1.data() + 2 * page) & ~(uintptr_t)(page - 1));
+    char* end2 = (char*)(((uintptr_t)buf2.data() + 2 * page) & ~(uintptr_t)(page - 1));
+    const vector<pair<string, string>> pairs{{"", ""}, {"", "a"}, {"abc", "abd"}, {"abcdefgh", "abcdefgh"},
+                                             {"abcdefgh", "abcdefghi"}, {"abcdefghijklmnopq", "abcdefghijklmnopr"},
+                                             {"abcdefghijk", "abcdefgh\xF0"}, {"ab\x01", "ab"}, {"ab\x80", "ab\x7F"}};
+    for (size_t back = 1; back <= 24; ++back)
+    {
+        for (const auto& p : pairs)
+        {
+            if (p.first.size() >= back || p.second.size() >= back + 8)
+                continue;
+            char* c1 = end1 - back;
+            char* c2 = end2 - back - 8;
+            memcpy(c1, p.first.c_str(), p.first.size() + 1);
+            memcpy(c2, p.second.c_str(), p.second.size() + 1);
+            CAPTURE(back);
+            CAPTURE(p.first);
+            CAPTURE(p.second);
+            REQUIRE(signum(imp::compare_suffix(imp::unsized_suffix{c1}, imp::unsized_suffix{c2})) ==
+                    signum(strcmp(c1, c2)));
+            REQUIRE(signum(imp::compare_suffix(imp::unsized_suffix{c2}, imp::unsized_suffix{c1})) ==
+                    signum(strcmp(c2, c1)));
+        }
+    }
+}
+
+namespace
+{
+    template<size_t N>
+    vector<array<unsigned char, N>> random_fixed_keys(size_t num, unsigned char max_byte, mt19937& gen)
+    {
+        // few distinct bytes, so prefixes collide and the keys are compared a word at a time
+        uniform_int_distribution<short> byte_dis(0, max_byte);
+        vector<array<unsigned char, N>> keys(num);
+        for (auto& key : keys)
+            for (unsigned char& c : key)
+                c = (unsigned char)byte_dis(gen);
+        return keys;
+    }
+
+    template<prefix_size Size, class Encoding, size_t N>
+    void require_fixed_order(vector<array<unsigned char, N>> vals)
+    {
+        using kdmt_fixed = keydomet<array<unsigned char, N>, Size, no_stats, Encoding>;
+        CAPTURE(N);
+        CAPTURE(static_cast<size_t>(Size));
+        vector<kdmt_fixed> kdm_vals{vals.begin(), vals.end()};
+        sort(vals.begin(), vals.end());
+        sort(kdm_vals.begin(), kdm_vals.end());
+        for (size_t i = 0; i < vals.size(); ++i)
+        {
+            REQUIRE(kdm_vals[i].get_str() == vals[i]);
+            const keydomet<const array<unsigned char, N>&, Size, no_stats, Encoding> view{vals[i]};
+            REQUIRE(kdm_vals[i] == view);
+            if (i > 0)
+                REQUIRE(signum(kdm_vals[i - 1].compare(view)) == (vals[i - 1] == vals[i] ? 0 : -1));
+        }
+    }
+}
+
+TEST_CASE("fixed-width keys preserve order", "[fixed width]")
+{
+    mt19937 gen{random_device{}()};
+    // binary keys, e.g., hashes, may contain NULs anywhere
+    require_fixed_order<prefix_size::SIZE_32BIT, binary_encoding>(random_fixed_keys<32>(2000, 3, gen));
+    require_fixed_order<prefix_size::SIZE_64BIT, binary_encoding>(random_fixed_keys<32>(2000, 3, gen));
+    require_fixed_order<prefix_size::SIZE_128BIT, binary_encoding>(random_fixed_keys<32>(2000, 3, gen));
+    require_fixed_order<prefix_bytes(3), binary_encoding>(random_fixed_keys<12>(2000, 2, gen));
+    require_fixed_order<prefix_size::SIZE_64BIT, binary_encoding>(random_fixed_keys<5>(2000, 2, gen));
+    require_fixed_order<prefix_size::SIZE_16BIT, binary_encoding>(random_fixed_keys<1>(100, 255, gen));
+    // bytes above 0x7F compare as unsigned
+    require_fixed_order<prefix_size::SIZE_32BIT, binary_encoding>(random_fixed_keys<16>(2000, 255, gen));
+    // with the raw encoding, NULs may only pad the keys
+    auto padded = random_fixed_keys<16>(2000, 2, gen);
+    for (auto& key : padded)
+    {
+        for (unsigned char& c : key)
+            c = (unsigned char)('a' + c);
+        fill(key.begin() + gen() % key.size(), key.end(), 0);
+    }
+    require_fixed_order<prefix_size::SIZE_32BIT, raw_encoding>(padded);
+    require_fixed_order<prefix_size::SIZE_64BIT, raw_encoding>(padded);
+    require_fixed_order<prefix_bytes(6), raw_encoding>(padded);
+}
+
+TEST_CASE("fixed-width keys are built from other string types", "[fixed width]")
+{
+    using ticker = array<char, 16>;
+    using kdmt_ticker = keydomet<ticker, prefix_size::SIZE_64BIT>;
+    REQUIRE(sizeof(kdmt_ticker) == 24);
+    const ticker aapl{'A', 'A', 'P', 'L'};
+    const kdmt_ticker k1{aapl}, k2{string{"AAPL"}}, k3{in_place, "AAPL.O", 4}, k4{"AAPL"};
+    REQUIRE(k1.get_str() == aapl);
+    REQUIRE(k2.get_str() == aapl);
+    REQUIRE(k3.get_str() == aapl);
+    REQUIRE(k4.get_str() == aapl);
+    REQUIRE(k1 == k2);
+    // fields need not be NUL terminated, and longer strings are truncated
+    const char field[16] = {'B', 'R', 'K', '.', 'B', '.', 'C', 'L', 'A', 'S', 'S', '.', 'B', '.', 'U', 'S'};
+    const kdmt_ticker k5{field}, k6{string{field, 16} + "-TRUNCATED"};
+    REQUIRE(string(k5.get_str().data(), 16) == string(field, 16));
+    REQUIRE(k5 == k6);
+    REQUIRE(k1 < k5);
+    // NUL padded strings of other types compare alike
+    const string padded_aapl{"AAPL\0\0\0\0\0\0\0\0\0\0\0\0", 16};
+    REQUIRE(k1 == keydomet<const string&, prefix_size::SIZE_64BIT>{padded_aapl});
+    REQUIRE(k1 == keydomet<const string&, prefix_size::SIZE_32BIT>{padded_aapl});
+    REQUIRE(keydomet<string, prefix_size::SIZE_64BIT>{string{"AAPK"}} < k1);
+    REQUIRE(k1 < keydomet<string, prefix_size::SIZE_64BIT>{string{"AAPL.O"}});
+    ostringstream os;
+    os << k1;
+    REQUIRE(os.str() == padded_aapl);
+}
+
+TEST_CASE("sets of fixed-width keys", "[fixed width]")
+{
+    mt19937 gen{random_device{}()};
+    const auto vals = random_fixed_keys<32>(2000, 3, gen);
+    using hash_key = array<unsigned char, 32>;
+    using kdmt_hash = keydomet<hash_key, prefix_size::SIZE_32BIT, no_stats, binary_encoding>;
+    set<kdmt_hash, less<>> kdm_set;
+    set<hash_key> ref_set;
+    for (size_t i = 0; i < vals.size(); i += 2)
+    {
+        kdm_set.emplace(vals[i]);
+        ref_set.insert(vals[i]);
+    }
+    REQUIRE(kdm_set.size() == ref_set.size());
+    for (const hash_key& val : vals)
+    {
+        auto find_key = make_find_key(kdm_set, val);
+        static_assert(is_same<decltype(find_key),
+                              keydomet<const hash_key&, prefix_size::SIZE_32BIT, no_stats, binary_encoding>>::value, "");
+        REQUIRE((kdm_set.find(find_key) != kdm_set.end()) == (ref_set.count(val) > 0));
+    }
+}
+
+TEST_CASE("searching sorted ranges using three-way comparisons", "[three-way search]")
+{
+    mt19937 gen{random_device{}()};
+    vector<string> org_vals = colliding_keys(1000, gen);
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    vector<kdmt_str> kdm_vals{org_vals.begin(), org_vals.end()};
+    sort(org_vals.begin(), org_vals.end());
+    sort(kdm_vals.begin(), kdm_vals.end());
+    for (const string& val : colliding_keys(300, gen))
+    {
+        CAPTURE(val);
+        const keydomet<const string&, prefix_size::SIZE_32BIT> key{val};
+        const auto kdm_lb = kdmt::lower_bound(kdm_vals.begin(), kdm_vals.end(), key);
+        const auto org_lb = std::lower_bound(org_vals.begin(), org_vals.end(), val);
+        REQUIRE(kdm_lb - kdm_vals.begin() == org_lb - org_vals.begin());
+        const auto found = binary_find(kdm_vals.begin(), kdm_vals.end(), key);
+        REQUIRE((found != kdm_vals.end()) == binary_search(org_vals.begin(), org_vals.end(), val));
+        if (found != kdm_vals.end())
+            REQUIRE(found->get_str() == val);
+    }
+    REQUIRE(binary_find(kdm_vals.begin(), kdm_vals.begin(), kdm_vals.front()) == kdm_vals.begin());
+}
+
+TEST_CASE("find compares each visited key once", "[three-way search]")
+{
+    struct set_tag {};
+    struct find_tag {};
+    using set_kdmt = keydomet<string, prefix_size::SIZE_16BIT, atomic_stats<set_tag>>;
+    using find_kdmt = keydomet<string, prefix_size::SIZE_16BIT, atomic_stats<find_tag>>;
+    mt19937 gen{random_device{}()};
+    const vector<string> vals = colliding_keys(1000, gen);
+    const set<set_kdmt, less<>> kdm_set{vals.begin(), vals.begin() + 500};
+    const set<find_kdmt, less<>> kdm_find_set{vals.begin(), vals.begin() + 500};
+    const set<string> str_set{vals.begin(), vals.begin() + 500};
+    for (const string& val : vals)
+    {
+        CAPTURE(val);
+        set_kdmt::reset_stats();
+        find_kdmt::reset_stats();
+        const auto set_iter = kdm_set.find(make_find_key(kdm_set, val));
+        const auto find_iter = kdmt::find(kdm_find_set, make_find_key(kdm_find_set, val));
+        REQUIRE((find_iter != kdm_find_set.end()) == (str_set.count(val) > 0));
+        REQUIRE((set_iter != kdm_set.end()) == (find_iter != kdm_find_set.end()));
+        if (find_iter != kdm_find_set.end())
+            REQUIRE(find_iter->get_str() == val);
+        // std::set::find compares the key lower_bound() returns a second time
+        const compare_stats set_stats = set_kdmt::get_stats(), find_stats = find_kdmt::get_stats();
+        const bool has_lower_bound = kdm_set.lower_bound(make_find_key(kdm_set, val)) != kdm_set.end();
+        REQUIRE(find_stats.used_prefix + find_stats.used_string + (has_lower_bound ? 1 : 0) ==
+                set_stats.used_prefix + set_stats.used_string);
+    }
+}
+
+TEST_CASE("find searches maps", "[three-way search]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    map<kdmt_str, int, less<>> kdm_map;
+    for (int i = 0; i < 100; ++i)
+        kdm_map.emplace(string{"key number "} + to_string(i), i);
+    for (int i = 0; i < 120; ++i)
+    {
+        const string key = "key number " + to_string(i);
+        const auto iter = kdmt::find(kdm_map, make_find_key(kdm_map, key));
+        REQUIRE((iter != kdm_map.end()) == (i < 100));
+        if (iter != kdm_map.end())
+            REQUIRE(iter->second == i);
+    }
+}
+
 TEST_CASE("sorting multiple keys", "[containers]")
 {
     vector<string> org_vals(10 + 100 + 1000);
@@ -0,0 +1,124 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "Kstring.h"
+
+#include "catch.hpp"
+
+#include <set>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+
+using namespace kdmt;
+using namespace std;
+
+TEST_CASE("kstring and its keydomet are as small as std::string", "[kstring]")
+{
+    REQUIRE(sizeof(kstring) <= 32);
+    REQUIRE(sizeof(keydomet<kstring, prefix_size::SIZE_64BIT>) == sizeof(kstring));
+    REQUIRE(sizeof(keydomet<kstring, prefix_size::SIZE_32BIT>) == sizeof(kstring));
+}
+
+TEST_CASE("kstring stores short strings inline", "[kstring]")
+{
+    kstring empty{""}, s{string(kstring::short_capacity, 's')}, l{string(kstring::short_capacity + 1, 'l')};
+    REQUIRE(empty.is_inline());
+    REQUIRE(empty.size() == 0);
+    REQUIRE(s.is_inline());
+    REQUIRE(s.str() == string(kstring::short_capacity, 's'));
+    REQUIRE(!l.is_inline());
+    REQUIRE(l.str() == string(kstring::short_capacity + 1, 'l'));
+    REQUIRE(strlen(l.c_str()) == l.size());
+}
+
+TEST_CASE("kstring prefix matches str_to_prefix", "[kstring]")
+{
+    const string src = "0123456789abcdefghijklmnopqrstuvwxyz0123456789";
+    for (size_t len = 0; len <= src.size(); ++len)
+    {
+        string str = src.substr(0, len);
+        CAPTURE(len);
+        REQUIRE(kstring{str}.prefix() == str_to_prefix<kstring::prefix_type>(str));
+    }
+}
+
+TEST_CASE("kstring copy and move", "[kstring]")
+{
+    const string long_str(100, 'x'), short_str{"short"};
+    kstring l{long_str}, s{short_str};
+    kstring l_copy{l}, s_copy{s};
+    REQUIRE(l_copy == l);
+    REQUIRE(l_copy.data() != l.data());
+    REQUIRE(s_copy == s);
+    const char* l_buf = l.data();
+    kstring l_moved{std::move(l)};
+    REQUIRE(l_moved.data() == l_buf);
+    REQUIRE(l.empty());
+    s_copy = l_moved;
+    REQUIRE(s_copy.str() == long_str);
+    l_moved = std::move(s);
+    REQUIRE(l_moved.str() == short_str);
+}
+
+TEST_CASE("compare keydomet<kstring> keys", "[kstring]")
+{
+    using kdmt_kstr = keydomet<kstring, prefix_size::SIZE_64BIT>;
+    const string long_base(40, 'k');
+    kdmt_kstr s1{"kkk"}, s2{"kkl"}, l1{long_base + "a"}, l2{long_base + "b"};
+    REQUIRE(s1 < s2);
+    REQUIRE(!(s2 < s1));
+    REQUIRE(s1 < l1);
+    REQUIRE(l1 < l2);
+    REQUIRE(!(l2 < l1));
+    REQUIRE(l1 == kdmt_kstr{long_base + "a"});
+    REQUIRE(s2 == kdmt_kstr{"kkl"});
+}
+
+TEST_CASE("keydomet<kstring> compares with std::string keydomets", "[kstring]")
+{
+    using kdmt_kstr = keydomet<kstring, prefix_size::SIZE_32BIT>;
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    const string base(40, 'k');
+    kdmt_kstr k{base + "b"};
+    REQUIRE(k.compare(kdmt_str{base + "a"}) > 0);
+    REQUIRE(k.compare(kdmt_str{base + "b"}) == 0);
+    REQUIRE(k.compare(kdmt_str{base + "c"}) < 0);
+    REQUIRE(k.compare(kdmt_str{string{"z"}}) < 0);
+}
+
+TEST_CASE("sorting keydomet<kstring> keys", "[kstring]")
+{
+    mt19937 gen{random_device{}()};
+    uniform_int_distribution<short> len_dis(0, 50), char_dis('a', 'c');
+    vector<string> org_vals(1000);
+    generate(org_vals.begin(), org_vals.end(), [&] {
+        string s(len_dis(gen), ' ');
+        for (char& c : s)
+            c = (char)char_dis(gen);
+        return s;
+    });
+    vector<keydomet<kstring, prefix_size::SIZE_64BIT>> kdm_vals{org_vals.begin(), org_vals.end()};
+    sort(org_vals.begin(), org_vals.end());
+    sort(kdm_vals.begin(), kdm_vals.end());
+    for (size_t i = 0; i < org_vals.size(); ++i)
+        REQUIRE(kdm_vals[i].get_str().str() == org_vals[i]);
+}
+
+TEST_CASE("searching a keydomet<kstring> set using std::string keys", "[kstring]")
+{
+    using kdmt_kstr = keydomet<kstring, prefix_size::SIZE_64BIT>;
+    set<kdmt_kstr, less<>> s;
+    const string long_key(40, 'l');
+    s.insert(kdmt_kstr{"short"});
+    s.insert(kdmt_kstr{long_key});
+    string lookup{"short"};
+    auto fk = make_find_key(s, lookup);
+    REQUIRE(&fk.get_str() == &lookup);
+    REQUIRE(s.find(fk) != s.end());
+    REQUIRE(s.find(make_find_key(s, long_key)) != s.end());
+    REQUIRE(s.find(make_find_key(s, string{"shorter"})) == s.end());
+}
@@ -0,0 +1,126 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "LearnedIndex.h"
+
+#include "TestUtils.h"
+#include "catch.hpp"
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+
+using namespace kdmt;
+using namespace std;
+using namespace test_utils;
+
+TEST_CASE("Learned indexes, all sizes", "[learned]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    vector<string> keys;
+    for (size_t size = 0; size <= 300; ++size)
+    {
+        CAPTURE(size);
+        const vector<string> sorted = sorted_unique_keys(keys);
+        const vector<kdmt_str> kdmt_keys{sorted.begin(), sorted.end()};
+        vector<string> probes{sorted};
+        for (const string& key : sorted)
+            probes.push_back(key + "!");
+        probes.push_back("");
+        probes.push_back("~");
+        require_same_positions(make_learned_index(kdmt_keys), sorted, probes);
+        require_same_positions(make_learned_index(kdmt_keys, learned_search::model, 7), sorted, probes);
+        require_same_positions(make_learned_index(kdmt_keys, learned_search::interpolation), sorted, probes);
+        keys.push_back(to_string(size * 7));
+    }
+}
+
+TEST_CASE("Learned indexes resolve prefix ties using the keys", "[learned]")
+{
+    mt19937 gen{random_device{}()};
+    const vector<string> sorted = sorted_unique_keys(random_keys(5000, gen));
+    const vector<string> probes = random_keys(5000, gen);
+    // any random access range of keydomets
+    const deque<keydomet<string, prefix_size::SIZE_32BIT>> kdmt_keys{sorted.begin(), sorted.end()};
+    // a few leaves, trained on skewed prefixes, are often off and extend their windows
+    for (size_t leaves : {0, 1, 3, 100, 10000})
+    {
+        CAPTURE(leaves);
+        const auto index = make_learned_index(kdmt_keys.begin(), kdmt_keys.end(), learned_search::model, leaves);
+        require_same_positions(index, sorted, probes);
+    }
+    require_same_positions(make_learned_index(kdmt_keys.begin(), kdmt_keys.end(), learned_search::interpolation),
+                        sorted, probes);
+}
+
+TEST_CASE("Learned indexes of other prefix sizes", "[learned]")
+{
+    mt19937 gen{random_device{}()};
+    const vector<string> sorted = sorted_unique_keys(random_keys(3000, gen));
+    const vector<string> probes = random_keys(3000, gen);
+    const vector<keydomet<string, prefix_size::SIZE_16BIT>> keys16{sorted.begin(), sorted.end()};
+    const vector<keydomet<string, prefix_size::SIZE_64BIT>> keys64{sorted.begin(), sorted.end()};
+    const vector<keydomet<string, prefix_size::SIZE_128BIT>> keys128{sorted.begin(), sorted.end()};
+    for (learned_search search_type : {learned_search::model, learned_search::interpolation})
+    {
+        const auto index16 = make_learned_index(keys16, search_type);
+        const auto index64 = make_learned_index(keys64, search_type);
+        const auto index128 = make_learned_index(keys128, search_type);
+        for (const string& probe : probes)
+        {
+            const size_t lower = static_cast<size_t>(lower_bound(sorted.begin(), sorted.end(), probe) -
+                                                     sorted.begin());
+            REQUIRE(index16.lower_bound(keydomet<const string&, prefix_size::SIZE_16BIT>{probe}) == lower);
+            REQUIRE(index64.lower_bound(keydomet<const string&, prefix_size::SIZE_64BIT>{probe}) == lower);
+            REQUIRE(index128.lower_bound(keydomet<const string&, prefix_size::SIZE_128BIT>{probe}) == lower);
+        }
+    }
+}
+
+TEST_CASE("Learned index metrics", "[learned]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_64BIT>;
+    mt19937 gen{random_device{}()};
+    // fixed length keys of random letters have prefixes which are close enough to uniform
+    uniform_int_distribution<short> char_dis('a', 'z');
+    vector<string> keys(20000, string(8, ' '));
+    for (string& key : keys)
+        for (char& c : key)
+            c = (char)char_dis(gen);
+    const vector<string> sorted = sorted_unique_keys(keys);
+    const vector<kdmt_str> kdmt_keys{sorted.begin(), sorted.end()};
+    const auto index = make_learned_index(kdmt_keys, learned_search::model, 100);
+    const learned_index_metrics metrics = index.metrics();
+    REQUIRE(metrics.leaf_models == 100);
+    REQUIRE(metrics.model_bytes > 0);
+    REQUIRE(metrics.max_window > 0);
+    REQUIRE(metrics.max_window < sorted.size() / 10);
+    REQUIRE(metrics.mean_error < metrics.max_window);
+    require_same_positions(make_learned_index(vector<keydomet<string, prefix_size::SIZE_32BIT>>{}), {}, {"a"});
+    const learned_index_metrics interpolation = make_learned_index(kdmt_keys, learned_search::interpolation).metrics();
+    REQUIRE(interpolation.leaf_models == 0);
+    REQUIRE(interpolation.model_bytes == 0);
+}
+
+TEST_CASE("Learned index lookups read strings only on prefix ties", "[learned]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT, atomic_stats<>>;
+    using kdmt_view = keydomet<const string&, prefix_size::SIZE_32BIT, atomic_stats<>>;
+    const vector<string> keys = digit_keys();
+    const vector<kdmt_str> kdmt_keys{keys.begin(), keys.end()};
+    // all the tied keys map to the same model position, so the window is searched rather than scanned
+    const vector<string> tied = tied_keys();
+    const vector<kdmt_str> kdmt_tied{tied.begin(), tied.end()};
+    for (learned_search search_type : {learned_search::model, learned_search::interpolation})
+    {
+        const auto index = make_learned_index(kdmt_keys, search_type);
+        require_strings_read_on_ties<kdmt_str>([&](const string& key) { return index.contains(kdmt_view{key}); });
+        const auto tied_index = make_learned_index(kdmt_tied, search_type);
+        require_same_positions(tied_index, tied, tied_probes());
+        require_few_string_reads<kdmt_str>([&](const string& key) { return tied_index.contains(kdmt_view{key}); });
+    }
+}
@@ -0,0 +1,191 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "RadixTree.h"
+#include "Kstring.h"
+
+#include "TestUtils.h"
+#include "catch.hpp"
+
+#include <set>
+#include <map>
+#include <vector>
+#include <string>
+#include <iterator>
+#include <algorithm>
+#include <random>
+
+using namespace kdmt;
+using namespace std;
+using namespace test_utils;
+
+namespace
+{
+    // shared heads, some longer than the paths nodes keep, so keys share paths, end within them and are prefixes
+    // of each other
+    const vector<string> art_heads{"", "head", "https://www.example.com/"};
+
+    template<class KdmtStr>
+    void require_set_ops(mt19937& gen)
+    {
+        using kdm_set_type = art_set<KdmtStr>;
+        const vector<string> org_vals = random_keys(3000, gen, art_heads);
+        kdm_set_type kdm_set;
+        set<string> str_set;
+        for (size_t i = 0; i < org_vals.size(); i += 2)
+        {
+            const bool inserted = kdm_set.emplace(in_place, org_vals[i]).second;
+            REQUIRE(inserted == str_set.insert(org_vals[i]).second);
+        }
+        require_same_keys(kdm_set, str_set);
+        require_same_search(kdm_set, str_set, org_vals);
+        // erasing by key and by iterator, till the tree empties
+        for (size_t i = 0; i < org_vals.size(); i += 3)
+            REQUIRE(kdm_set.erase(KdmtStr{org_vals[i]}) == str_set.erase(org_vals[i]));
+        require_same_keys(kdm_set, str_set);
+        require_same_search(kdm_set, str_set, org_vals);
+        const kdm_set_type copy{kdm_set};
+        REQUIRE(copy == kdm_set);
+        for (auto iter = kdm_set.begin(); iter != kdm_set.end();)
+        {
+            const string key = str_of(iter->get_str());
+            iter = kdm_set.erase(iter);
+            auto str_iter = str_set.erase(str_set.find(key));
+            REQUIRE((iter == kdm_set.end()) == (str_iter == str_set.end()));
+            if (iter != kdm_set.end())
+                REQUIRE(str_of(iter->get_str()) == *str_iter);
+        }
+        require_same_keys(kdm_set, str_set);
+        REQUIRE(kdm_set.begin() == kdm_set.end());
+        // the copy isn't affected, and can be inserted to again
+        REQUIRE(copy.size() > 0);
+        kdm_set = copy;
+        for (const string& val : org_vals)
+            kdm_set.emplace(val);
+        str_set = set<string>(org_vals.begin(), org_vals.end());
+        require_same_keys(kdm_set, str_set);
+        require_same_search(kdm_set, str_set, org_vals);
+    }
+}
+
+TEST_CASE("Radix tree sets hold sorted keys", "[art]")
+{
+    mt19937 gen{random_device{}()};
+    require_set_ops<keydomet<string, prefix_size::SIZE_16BIT>>(gen);
+    require_set_ops<keydomet<string, prefix_size::SIZE_32BIT>>(gen);
+    require_set_ops<keydomet<string, prefix_size::SIZE_64BIT>>(gen);
+    require_set_ops<keydomet<string, prefix_size::SIZE_128BIT>>(gen);
+    require_set_ops<keydomet<string, prefix_bytes(6)>>(gen);
+    require_set_ops<keydomet<kstring, prefix_size::SIZE_64BIT>>(gen);
+}
+
+TEST_CASE("Radix tree nodes grow and shrink", "[art]")
+{
+    // two byte keys of every first byte and many second bytes, so nodes of all sizes hold them
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    mt19937 gen{random_device{}()};
+    vector<string> keys;
+    for (int first = 1; first < 256; first += 3)
+        for (int second = 1; second < 256; second += first % 7 + 1)
+            keys.push_back(string{(char)first, (char)second});
+    shuffle(keys.begin(), keys.end(), gen);
+    art_set<kdmt_str> kdm_set{keys.begin(), keys.end()};
+    set<string> str_set{keys.begin(), keys.end()};
+    require_same_keys(kdm_set, str_set);
+    vector<string> probes{keys};
+    probes.push_back("");
+    probes.push_back(string(1, '\x7f'));
+    probes.push_back(string(3, '\xff'));
+    require_same_search(kdm_set, str_set, probes);
+    shuffle(keys.begin(), keys.end(), gen);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        REQUIRE(kdm_set.erase(kdmt_str{keys[i]}) == 1);
+        str_set.erase(keys[i]);
+        if (i % 1000 == 0)
+        {
+            require_same_keys(kdm_set, str_set);
+            require_same_search(kdm_set, str_set, probes);
+        }
+    }
+    REQUIRE(kdm_set.empty());
+}
+
+TEST_CASE("Radix trees are searched using string views", "[art]")
+{
+    mt19937 gen{random_device{}()};
+    using kdmt_str = keydomet<string, prefix_size::SIZE_64BIT>;
+    const vector<string> org_vals = random_keys(2000, gen, art_heads);
+    const art_set<kdmt_str> kdm_set{org_vals.begin(), org_vals.begin() + org_vals.size() / 2};
+    const set<string> str_set{org_vals.begin(), org_vals.begin() + org_vals.size() / 2};
+    for (const string& key : org_vals)
+    {
+        const chars_view view{key.data(), key.size()};
+        REQUIRE(kdm_set.contains(view) == (str_set.count(key) > 0));
+        REQUIRE(kdm_set.contains(key) == (str_set.count(key) > 0));
+        REQUIRE(distance(kdm_set.begin(), kdm_set.lower_bound(view)) ==
+                distance(str_set.begin(), str_set.lower_bound(key)));
+    }
+}
+
+TEST_CASE("Radix tree lookups read strings only past the prefixes", "[art]")
+{
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT, atomic_stats<>>;
+    art_set<kdmt_str> kdm_set;
+    for (int i = 0; i < 10000; ++i)
+        kdm_set.emplace(to_string(i * 10));
+    REQUIRE(kdm_set.size() == 10000);
+    // lookups of keys whose prefixes differ from all others end within the prefix bytes
+    kdmt_str::reset_stats();
+    const string unique_prefix{"abcd"};
+    REQUIRE(kdm_set.find(make_find_key(kdm_set, unique_prefix)) == kdm_set.end());
+    REQUIRE(kdmt_str::get_stats().used_string == 0);
+    // keys sharing a prefix are told apart using the strings
+    kdmt_str::reset_stats();
+    REQUIRE(kdm_set.find(make_find_key(kdm_set, string{"12345"})) == kdm_set.end());
+    REQUIRE(kdm_set.find(make_find_key(kdm_set, string{"12340"})) != kdm_set.end());
+    REQUIRE(kdmt_str::get_stats().used_string > 0);
+}
+
+TEST_CASE("Radix tree maps", "[art]")
+{
+    mt19937 gen{random_device{}()};
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT>;
+    const vector<string> org_vals = random_keys(3000, gen, art_heads);
+    art_map<kdmt_str, size_t> kdm_map;
+    map<string, size_t> str_map;
+    for (size_t i = 0; i < org_vals.size(); ++i)
+    {
+        kdm_map[kdmt_str{org_vals[i]}] += i;
+        str_map[org_vals[i]] += i;
+    }
+    auto require_same = [&] {
+        REQUIRE(kdm_map.size() == str_map.size());
+        REQUIRE(equal(kdm_map.begin(), kdm_map.end(), str_map.begin(), str_map.end(),
+                      [](const pair<const kdmt_str, size_t>& k, const pair<const string, size_t>& s) {
+                          return k.first.get_str() == s.first && k.second == s.second;
+                      }));
+    };
+    require_same();
+    for (const auto& val : str_map)
+        REQUIRE(kdm_map.at(make_find_key(kdm_map, val.first)) == val.second);
+    REQUIRE_THROWS_AS(kdm_map.at(make_find_key(kdm_map, string{"missing"})), std::out_of_range);
+    // inserting existing keys keeps their values
+    REQUIRE(!kdm_map.insert({kdmt_str{str_map.begin()->first}, 0}).second);
+    REQUIRE(!kdm_map.try_emplace(kdmt_str{str_map.begin()->first}, 0).second);
+    REQUIRE(kdm_map.begin()->second == str_map.begin()->second);
+    REQUIRE(kdm_map.emplace(piecewise_construct, forward_as_tuple(in_place, "missing"), forward_as_tuple(7)).second);
+    REQUIRE(kdm_map.at(string{"missing"}) == 7);
+    kdm_map.erase(kdm_map.find(string{"missing"}));
+    auto from = kdm_map.lower_bound(make_find_key(kdm_map, string{"b"}));
+    auto to = kdm_map.lower_bound(make_find_key(kdm_map, string{"head"}));
+    kdm_map.erase(from, to);
+    str_map.erase(str_map.lower_bound("b"), str_map.lower_bound("head"));
+    require_same();
+    const auto moved{std::move(kdm_map)};
+    REQUIRE(kdm_map.empty());
+    REQUIRE(kdm_map.begin() == kdm_map.end());
+    REQUIRE(moved.size() == str_map.size());
+}
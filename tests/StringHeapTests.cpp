@@ -0,0 +1,134 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "StringHeap.h"
+
+#include "TestUtils.h"
+#include "catch.hpp"
+
+#include <set>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+
+using namespace kdmt;
+using namespace std;
+using namespace test_utils;
+
+namespace
+{
+    struct sizes_tag {};
+    struct order_tag {};
+    struct set_tag {};
+    struct binary_tag {};
+    struct duplicates_tag {};
+
+    // no shared head, so prefixes collide less often, yet often enough for the heap to be read
+    const vector<string> heap_keys_heads{""};
+}
+
+TEST_CASE("heap stored keydomets take 8 bytes", "[string heap]")
+{
+    using heap = string_heap<sizes_tag>;
+    using kdmt_heap = keydomet<heap_stored<sizes_tag>, prefix_size::SIZE_32BIT>;
+    REQUIRE(sizeof(keydomet<heap_stored<sizes_tag>, prefix_size::SIZE_16BIT>) == 8);
+    REQUIRE(sizeof(kdmt_heap) == 8);
+    const kdmt_heap k1{string{"first"}}, k2{"second"}, k3{in_place, "third, and longer", 5};
+    REQUIRE(str_of(k1.get_str()) == "first");
+    REQUIRE(str_of(k2.get_str()) == "second");
+    REQUIRE(str_of(k3.get_str()) == "third");
+    REQUIRE(heap::size() == 3 * (sizeof(uint32_t) + 1) + 5 + 6 + 5);
+    // copies share the string
+    const kdmt_heap k1_copy{k1};
+    REQUIRE(k1_copy == k1);
+    REQUIRE(k1_copy.get_str().data() == k1.get_str().data());
+    REQUIRE(heap::size() == 3 * (sizeof(uint32_t) + 1) + 5 + 6 + 5);
+    heap::clear();
+    REQUIRE(heap::size() == 0);
+}
+
+TEST_CASE("heap stored keydomets preserve order", "[string heap]")
+{
+    mt19937 gen{random_device{}()};
+    vector<string> org_vals = random_keys(2000, gen, heap_keys_heads, 20);
+    using kdmt16 = keydomet<heap_stored<order_tag>, prefix_size::SIZE_16BIT>;
+    using kdmt32 = keydomet<heap_stored<order_tag>, prefix_size::SIZE_32BIT>;
+    vector<kdmt16> kdm_vals16{org_vals.begin(), org_vals.end()};
+    vector<kdmt32> kdm_vals32{org_vals.begin(), org_vals.end()};
+    sort(org_vals.begin(), org_vals.end());
+    sort(kdm_vals16.begin(), kdm_vals16.end());
+    sort(kdm_vals32.begin(), kdm_vals32.end());
+    for (size_t i = 0; i < org_vals.size(); ++i)
+    {
+        REQUIRE(str_of(kdm_vals16[i].get_str()) == org_vals[i]);
+        REQUIRE(str_of(kdm_vals32[i].get_str()) == org_vals[i]);
+    }
+    // sorted vectors are searched using view keys, which don't touch the heap
+    const size_t heap_size = string_heap<order_tag>::size();
+    for (const string& val : random_keys(200, gen, heap_keys_heads, 20))
+    {
+        const keydomet<const string&, prefix_size::SIZE_32BIT> key{val};
+        REQUIRE(binary_search(kdm_vals32.begin(), kdm_vals32.end(), key, less<>{}) ==
+                binary_search(org_vals.begin(), org_vals.end(), val));
+    }
+    REQUIRE(string_heap<order_tag>::size() == heap_size);
+    string_heap<order_tag>::clear();
+}
+
+TEST_CASE("sets of heap stored keydomets", "[string heap]")
+{
+    mt19937 gen{random_device{}()};
+    const vector<string> org_vals = random_keys(2000, gen, heap_keys_heads, 20);
+    using kdmt_heap = keydomet<heap_stored<set_tag>, prefix_size::SIZE_32BIT>;
+    set<kdmt_heap, less<>> kdm_set;
+    set<string> str_set;
+    for (size_t i = 0; i < org_vals.size(); i += 2)
+    {
+        kdm_set.emplace(in_place, org_vals[i]);
+        str_set.insert(org_vals[i]);
+    }
+    REQUIRE(kdm_set.size() == str_set.size());
+    const size_t heap_size = string_heap<set_tag>::size();
+    for (const string& val : org_vals)
+    {
+        REQUIRE((kdm_set.find(make_find_key(kdm_set, val)) != kdm_set.end()) == (str_set.count(val) > 0));
+        REQUIRE((kdm_set.find(make_find_key(kdm_set, val.c_str())) != kdm_set.end()) == (str_set.count(val) > 0));
+    }
+    REQUIRE(string_heap<set_tag>::size() == heap_size);
+    string_heap<set_tag>::clear();
+}
+
+TEST_CASE("heap stored keydomets hold binary keys", "[string heap]")
+{
+    using kdmt_heap = keydomet<heap_stored<binary_tag>, prefix_size::SIZE_32BIT, no_stats, binary_encoding>;
+    const string with_nul{"ab\0cd", 5}, shorter{"ab\0c", 4}, other{"ab\0ce", 5};
+    const kdmt_heap k1{with_nul}, k2{shorter}, k3{other};
+    REQUIRE(str_of(k1.get_str()) == with_nul);
+    REQUIRE(k2 < k1);
+    REQUIRE(k1 < k3);
+    REQUIRE(!(k1 == k2));
+    REQUIRE(k1 == keydomet<const string&, prefix_size::SIZE_32BIT, no_stats, binary_encoding>{with_nul});
+    string_heap<binary_tag>::clear();
+}
+
+TEST_CASE("inserting heap stored keys held already doesn't grow the heap", "[string heap]")
+{
+    using kdmt_heap = keydomet<heap_stored<duplicates_tag>, prefix_size::SIZE_32BIT>;
+    set<kdmt_heap, less<>> kdm_set;
+    for (int i = 0; i < 100; ++i)
+        REQUIRE(heap_emplace(kdm_set, in_place, to_string(i)).second);
+    const size_t heap_size = string_heap<duplicates_tag>::size();
+    for (int round = 0; round < 1000; ++round)
+        REQUIRE(!heap_emplace(kdm_set, in_place, to_string(round % 100)).second);
+    REQUIRE(string_heap<duplicates_tag>::size() == heap_size);
+    REQUIRE(kdm_set.size() == 100);
+    for (int i = 0; i < 100; ++i)
+        REQUIRE(str_of(kdm_set.find(make_find_key(kdm_set, to_string(i)))->get_str()) == to_string(i));
+    // a plain emplace() leaks the rejected key's string
+    kdm_set.emplace(in_place, string{"0"});
+    REQUIRE(string_heap<duplicates_tag>::size() > heap_size);
+    string_heap<duplicates_tag>::clear();
+}
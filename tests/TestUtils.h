@@ -0,0 +1,183 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#ifndef KEYDOMET_TESTUTILS_H
+#define KEYDOMET_TESTUTILS_H
+
+#include "Keydomet.h"
+#include "Kstring.h"
+
+#include "catch.hpp"
+
+#include <set>
+#include <vector>
+#include <string>
+#include <iterator>
+#include <algorithm>
+#include <random>
+
+//
+// Helpers shared by the tests of the containers and indexes holding keydomets, which are checked against
+// std::set<std::string> and sorted vectors of strings holding the same keys.
+//
+namespace test_utils
+{
+
+    // a small alphabet, following one of the given heads (some of which may repeat, making them more likely),
+    // so many prefixes collide and the strings are compared
+    inline std::vector<std::string> random_keys(size_t num, std::mt19937& gen,
+                                                const std::vector<std::string>& heads = {"", "head", "head", "head"},
+                                                short max_len = 12)
+    {
+        std::uniform_int_distribution<short> len_dis(0, max_len), char_dis('a', 'c');
+        std::uniform_int_distribution<size_t> head_dis(0, heads.size() - 1);
+        std::vector<std::string> keys(num);
+        std::generate(keys.begin(), keys.end(), [&] {
+            std::string s(len_dis(gen), ' ');
+            for (char& c : s)
+                c = (char)char_dis(gen);
+            return heads[head_dis(gen)] + s;
+        });
+        return keys;
+    }
+
+    inline std::vector<std::string> sorted_unique_keys(std::vector<std::string> keys)
+    {
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        return keys;
+    }
+
+    inline const std::string& str_of(const std::string& s)
+    {
+        return s;
+    }
+
+    inline std::string str_of(const kdmt::kstring& s)
+    {
+        return s.str();
+    }
+
+    inline std::string str_of(kdmt::chars_view v)
+    {
+        return {v.data(), v.size()};
+    }
+
+    // the set holds the keys of str_set, in the same order
+    template<class KdmtSet>
+    void require_same_keys(const KdmtSet& kdm_set, const std::set<std::string>& str_set)
+    {
+        using key_type = typename KdmtSet::key_type;
+        REQUIRE(kdm_set.size() == str_set.size());
+        REQUIRE(kdm_set.empty() == str_set.empty());
+        REQUIRE(std::equal(kdm_set.begin(), kdm_set.end(), str_set.begin(), str_set.end(),
+                           [](const key_type& k, const std::string& s) { return str_of(k.get_str()) == s; }));
+        REQUIRE(std::equal(kdm_set.rbegin(), kdm_set.rend(), str_set.rbegin(), str_set.rend(),
+                           [](const key_type& k, const std::string& s) { return str_of(k.get_str()) == s; }));
+    }
+
+    // the set's lookups, using find keys made of the given keys, agree with those of str_set
+    template<class KdmtSet>
+    void require_same_search(const KdmtSet& kdm_set, const std::set<std::string>& str_set,
+                             const std::vector<std::string>& keys)
+    {
+        for (const std::string& key : keys)
+        {
+            CAPTURE(key);
+            const auto find_key = kdmt::make_find_key(kdm_set, key);
+            const auto iter = kdm_set.find(find_key);
+            REQUIRE((iter != kdm_set.end()) == (str_set.count(key) > 0));
+            if (iter != kdm_set.end())
+                REQUIRE(str_of(iter->get_str()) == key);
+            REQUIRE(kdm_set.count(find_key) == str_set.count(key));
+            REQUIRE(std::distance(kdm_set.begin(), kdm_set.lower_bound(find_key)) ==
+                    std::distance(str_set.begin(), str_set.lower_bound(key)));
+            REQUIRE(std::distance(kdm_set.begin(), kdm_set.upper_bound(find_key)) ==
+                    std::distance(str_set.begin(), str_set.upper_bound(key)));
+        }
+    }
+
+    // the positions an index of the sorted keys (using 32 bit prefixes) yields agree with those of searching the
+    // keys themselves
+    template<class Index>
+    void require_same_positions(const Index& index, const std::vector<std::string>& sorted,
+                                const std::vector<std::string>& probes)
+    {
+        using kdmt_view = kdmt::keydomet<const std::string&, kdmt::prefix_size::SIZE_32BIT>;
+        REQUIRE(index.size() == sorted.size());
+        for (const std::string& probe : probes)
+        {
+            CAPTURE(probe);
+            const size_t lower = static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), probe) -
+                                                     sorted.begin());
+            const bool found = std::binary_search(sorted.begin(), sorted.end(), probe);
+            REQUIRE(index.lower_bound(kdmt_view{probe}) == lower);
+            REQUIRE(index.find(kdmt_view{probe}) == (found ? lower : sorted.size()));
+            REQUIRE(index.contains(kdmt_view{probe}) == found);
+        }
+    }
+
+    //
+    // Checks of the strings read by lookups in a structure holding keys of the given type, done through a
+    // contains(key) callable. Structures holding digit_keys() read the strings only on prefix ties, and ones
+    // holding tied_keys(), whose prefixes are all the same, read the strings a logarithmic number of times.
+    //
+
+    inline std::vector<std::string> digit_keys()
+    {
+        std::vector<std::string> keys;
+        for (int i = 0; i < 10000; ++i)
+            keys.push_back(std::to_string(i * 10));
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+    template<class KdmtStr, class Contains>
+    void require_strings_read_on_ties(Contains contains)
+    {
+        KdmtStr::reset_stats();
+        REQUIRE(!contains(std::string{"abcd"}));
+        REQUIRE(KdmtStr::get_stats().used_string == 0);
+        REQUIRE(!contains(std::string{"12345"}));
+        REQUIRE(contains(std::string{"12340"}));
+        REQUIRE(KdmtStr::get_stats().used_string > 0);
+    }
+
+    inline std::vector<std::string> tied_keys()
+    {
+        std::vector<std::string> keys;
+        for (int i = 0; i < 20000; ++i)
+            keys.push_back("https://example.com/" + std::to_string(i * 2));
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+    // held and missing keys, and ones preceding and following all of tied_keys()
+    inline std::vector<std::string> tied_probes()
+    {
+        std::vector<std::string> probes;
+        for (int i = 0; i < 40000; i += 97)
+            probes.push_back("https://example.com/" + std::to_string(i));
+        probes.push_back("https://example.com/");
+        probes.push_back("https://example.com/~");
+        return probes;
+    }
+
+    template<class KdmtStr, class Contains>
+    void require_few_string_reads(Contains contains)
+    {
+        const std::vector<std::string> keys = tied_keys();
+        for (const std::string& probe : tied_probes())
+        {
+            CAPTURE(probe);
+            KdmtStr::reset_stats();
+            REQUIRE(contains(probe) == std::binary_search(keys.begin(), keys.end(), probe));
+            REQUIRE(KdmtStr::get_stats().used_string <= 40);
+        }
+    }
+
+}
+
+#endif //KEYDOMET_TESTUTILS_H
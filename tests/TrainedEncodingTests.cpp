@@ -0,0 +1,127 @@
+//
+// Copyright(c) 2019 Eran Gilad, https://github.com/erangi/kdmt
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+#include "TrainedEncoding.h"
+
+#include "catch.hpp"
+
+#include <set>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+
+using namespace kdmt;
+using namespace std;
+
+namespace
+{
+    // keys with a skewed character distribution - mostly 'e' and 't', some other letters
+    vector<string> skewed_keys(size_t num, mt19937& gen)
+    {
+        uniform_int_distribution<short> len_dis(0, 30), char_dis(0, 19);
+        const char chars[] = "eeeeeeeetttttaoinshr";
+        vector<string> keys(num);
+        generate(keys.begin(), keys.end(), [&] {
+            string s(len_dis(gen), ' ');
+            for (char& c : s)
+                c = chars[char_dis(gen)];
+            return s;
+        });
+        return keys;
+    }
+
+    struct skewed_tag {};
+    struct untrained_tag {};
+}
+
+TEST_CASE("trained encoding fits more characters into the prefix", "[trained encoding]")
+{
+    using encoding = trained_encoding<skewed_tag>;
+    mt19937 gen{random_device{}()};
+    vector<string> sample = skewed_keys(1000, gen);
+    encoding::train(sample.begin(), sample.end());
+    REQUIRE(encoding::trained());
+    const string key(40, 'e');
+    REQUIRE(encoding::on_tie(encoding::encode<uint32_t>(key)).offset > 4);
+    REQUIRE(encoding::on_tie(encoding::encode<uint64_t>(key)).offset > 8);
+    // characters missing from the sample are still coded, though using longer codes
+    REQUIRE(encoding::on_tie(encoding::encode<uint64_t>(string(40, '~'))).offset < 8);
+}
+
+TEST_CASE("trained encoding preserves order", "[trained encoding]")
+{
+    using encoding = trained_encoding<skewed_tag>;
+    mt19937 gen{random_device{}()};
+    vector<string> sample = skewed_keys(1000, gen);
+    encoding::train(sample.begin(), sample.end());
+    // the values include characters which are rare or missing from the sample, including NULs
+    vector<string> org_vals = skewed_keys(2000, gen);
+    uniform_int_distribution<short> pos_dis(0, 29), byte_dis(0, 255);
+    for (size_t i = 0; i < org_vals.size(); i += 3)
+        if (!org_vals[i].empty())
+            org_vals[i][pos_dis(gen) % org_vals[i].size()] = (char)byte_dis(gen);
+    using kdmt16 = keydomet<string, prefix_size::SIZE_16BIT, no_stats, encoding>;
+    using kdmt32 = keydomet<string, prefix_size::SIZE_32BIT, no_stats, encoding>;
+    using kdmt64 = keydomet<string, prefix_size::SIZE_64BIT, no_stats, encoding>;
+    vector<kdmt16> kdm_vals16{org_vals.begin(), org_vals.end()};
+    vector<kdmt32> kdm_vals32{org_vals.begin(), org_vals.end()};
+    vector<kdmt64> kdm_vals64{org_vals.begin(), org_vals.end()};
+    sort(org_vals.begin(), org_vals.end());
+    sort(kdm_vals16.begin(), kdm_vals16.end());
+    sort(kdm_vals32.begin(), kdm_vals32.end());
+    sort(kdm_vals64.begin(), kdm_vals64.end());
+    for (size_t i = 0; i < org_vals.size(); ++i)
+    {
+        REQUIRE(kdm_vals16[i].get_str() == org_vals[i]);
+        REQUIRE(kdm_vals32[i].get_str() == org_vals[i]);
+        REQUIRE(kdm_vals64[i].get_str() == org_vals[i]);
+    }
+}
+
+TEST_CASE("trained encoding compares equal strings", "[trained encoding]")
+{
+    using encoding = trained_encoding<skewed_tag>;
+    mt19937 gen{random_device{}()};
+    vector<string> sample = skewed_keys(1000, gen);
+    encoding::train(sample.begin(), sample.end());
+    using kdmt_str = keydomet<string, prefix_size::SIZE_32BIT, no_stats, encoding>;
+    using kdmt_cstr = keydomet<const char*, prefix_size::SIZE_32BIT, no_stats, encoding>;
+    REQUIRE(kdmt_str{string{""}} == kdmt_cstr{""});
+    REQUIRE(kdmt_str{string{"tee"}} == kdmt_cstr{"tee"});
+    REQUIRE(kdmt_str{string{"teeteeteeteetee"}} == kdmt_cstr{"teeteeteeteetee"});
+    REQUIRE(kdmt_str{string{"teeteeteeteetee"}} < kdmt_cstr{"teeteeteeteetef"});
+    REQUIRE(kdmt_str{string{"tee"}} < kdmt_cstr{"tee\x01"});
+    set<kdmt_str, less<>> s{string{"eat"}, string{"tea"}, string{"teatteatteat"}};
+    REQUIRE(s.find(make_find_key(s, string{"tea"})) != s.end());
+    REQUIRE(s.find(make_find_key(s, string{"teatteatteat"})) != s.end());
+    REQUIRE(s.find(make_find_key(s, string{"teatteatteae"})) == s.end());
+}
+
+TEST_CASE("untrained encoding preserves order", "[trained encoding]")
+{
+    using encoding = trained_encoding<untrained_tag>;
+    REQUIRE(!encoding::trained());
+    vector<string> org_vals{"", "a", "ab", "abc", "b", string(1, '\0'), "\xFF", "zzzzzzzzzz", "zzzzzzzzzzz"};
+    vector<keydomet<string, prefix_size::SIZE_32BIT, no_stats, encoding>> kdm_vals{org_vals.rbegin(), org_vals.rend()};
+    sort(org_vals.begin(), org_vals.end());
+    sort(kdm_vals.begin(), kdm_vals.end());
+    for (size_t i = 0; i < org_vals.size(); ++i)
+        REQUIRE(kdm_vals[i].get_str() == org_vals[i]);
+}
+
+TEST_CASE("trained encoding narrows like it encodes", "[trained encoding]")
+{
+    using encoding = trained_encoding<skewed_tag>;
+    mt19937 gen{random_device{}()};
+    vector<string> sample = skewed_keys(1000, gen);
+    encoding::train(sample.begin(), sample.end());
+    for (const string& key : skewed_keys(1000, gen))
+    {
+        CAPTURE(key);
+        REQUIRE(encoding::narrow<uint32_t>(encoding::encode<uint64_t>(key)) == encoding::encode<uint32_t>(key));
+        REQUIRE(encoding::narrow<uint16_t>(encoding::encode<uint32_t>(key)) == encoding::encode<uint16_t>(key));
+    }
+}